@@ -0,0 +1,336 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: async.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines asynchronous variants of the heavier array operations
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_ASYNC_HPP
+#define WILT_ASYNC_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define WILT_HAS_COROUTINES
+#endif
+
+#include "narray.hpp"
+#include "rawio.hpp"
+#include "threadpool.hpp"
+
+namespace wilt
+{
+namespace detail
+{
+  // The `AsyncContinuation` class holds an optional function to call once an
+  // asynchronous operation is complete. It exists so that awaiting coroutines
+  // can be resumed without blocking a thread on the future.
+  class AsyncContinuation
+  {
+  public:
+    // Marks the operation complete and calls the continuation, if any
+    void complete()
+    {
+      std::function<void()> next;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_ = true;
+        next = std::move(next_);
+      }
+      if (next)
+        next();
+    }
+
+    // Sets the continuation, returns false if the operation is already
+    // complete in which case the continuation is not stored
+    bool then(std::function<void()> next)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (done_)
+        return false;
+      next_ = std::move(next);
+      return true;
+    }
+
+  private:
+    std::mutex mutex_;
+    bool done_ = false;
+    std::function<void()> next_;
+
+  }; // class AsyncContinuation
+
+} // namespace detail
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class holds the eventual result of an asynchronous array operation.
+  //
+  // It behaves like `std::future<R>` (and can be converted into one), but when
+  // compiled with C++20 coroutine support it can also be used with `co_await`.
+  // An awaiting coroutine is resumed on the pool thread that completed the
+  // operation.
+
+  template <class R>
+  class AsyncResult
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    AsyncResult() = default;
+
+    AsyncResult(std::future<R> future, std::shared_ptr<detail::AsyncContinuation> continuation) noexcept
+      : future_(std::move(future))
+      , continuation_(std::move(continuation))
+    { }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESS FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Waits for and gets the result, rethrows any exception from the operation
+    R get()
+    {
+      return future_.get();
+    }
+
+    void wait() const
+    {
+      future_.wait();
+    }
+
+    template <class Rep, class Period>
+    std::future_status wait_for(const std::chrono::duration<Rep, Period>& duration) const
+    {
+      return future_.wait_for(duration);
+    }
+
+    bool valid() const noexcept
+    {
+      return future_.valid();
+    }
+
+    // Gets the underlying future, this result is no longer valid afterwards
+    std::future<R> future() noexcept
+    {
+      continuation_.reset();
+      return std::move(future_);
+    }
+
+#ifdef WILT_HAS_COROUTINES
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // AWAITABLE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // An invalid result (default-constructed, or after 'future()') doesn't
+    // suspend, 'await_resume()' then throws std::future_error
+    bool await_ready() const
+    {
+      if (!continuation_ || !future_.valid())
+        return true;
+
+      return future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle)
+    {
+      if (!continuation_)
+        return false;
+
+      return continuation_->then([handle]() mutable { handle.resume(); });
+    }
+
+    R await_resume()
+    {
+      if (!future_.valid())
+        throw std::future_error(std::future_errc::no_state);
+
+      return future_.get();
+    }
+#endif
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::future<R> future_;
+    std::shared_ptr<detail::AsyncContinuation> continuation_;
+
+  }; // class AsyncResult
+
+  //! @brief         runs a function on a thread pool
+  //! @param[in]     func - function or function object with the signature R()
+  //! @param[in]     pool - the pool to run on
+  //! @return        the eventual result of 'func'
+  //!
+  //! Any arrays used by 'func' should be captured by value so the data they
+  //! reference is kept alive until the operation is complete
+  template <class Function>
+  auto runAsync(Function func, ThreadPool& pool = defaultThreadPool()) -> AsyncResult<decltype(func())>
+  {
+    using result_type = decltype(func());
+
+    auto task = std::make_shared<std::packaged_task<result_type()>>(std::move(func));
+    auto continuation = std::make_shared<detail::AsyncContinuation>();
+    auto future = task->get_future();
+    pool.post([task, continuation]() { (*task)(); continuation->complete(); });
+
+    return AsyncResult<result_type>(std::move(future), std::move(continuation));
+  }
+
+  //! @brief         asynchronously calls an operation on all elements in-order
+  //! @param[in]     arr - the array
+  //! @param[in]     op - function or function object with the signature void(T&)
+  //! @param[in]     pool - the pool to run on
+  template <class T, std::size_t N, class Operator>
+  AsyncResult<void> asyncForeach(const NArray<T, N>& arr, Operator op, ThreadPool& pool = defaultThreadPool())
+  {
+    return runAsync([arr, op]() { arr.foreach(op); }, pool);
+  }
+
+  //! @brief         asynchronously sets the elements of an array to those of
+  //!                another array of the same size
+  //! @param[in]     dst - the destination array
+  //! @param[in]     src - the source array
+  //! @param[in]     pool - the pool to run on
+  //!
+  //! Throws std::invalid_argument if the sizes don't match (before running)
+  template <class T, class U, std::size_t N>
+  AsyncResult<void> asyncSetTo(const NArray<T, N>& dst, const NArray<U, N>& src, ThreadPool& pool = defaultThreadPool())
+  {
+    if (dst.sizes() != src.sizes())
+      throw std::invalid_argument("asyncSetTo(dst, src): dimensions must match");
+
+    return runAsync([dst, src]() { dst.setTo(src); }, pool);
+  }
+
+  //! @brief         asynchronously sets the elements of an array to a value
+  //! @param[in]     dst - the destination array
+  //! @param[in]     val - the value to set
+  //! @param[in]     pool - the pool to run on
+  template <class T, std::size_t N>
+  AsyncResult<void> asyncSetTo(const NArray<T, N>& dst, const T& val, ThreadPool& pool = defaultThreadPool())
+  {
+    return runAsync([dst, val]() { dst.setTo(val); }, pool);
+  }
+
+  //! @brief         asynchronously copies an array into a new array
+  //! @param[in]     arr - the array to copy
+  //! @param[in]     pool - the pool to run on
+  //! @return        the eventual copy
+  template <class T, std::size_t N>
+  AsyncResult<NArray<typename std::remove_const<T>::type, N>> asyncClone(const NArray<T, N>& arr, ThreadPool& pool = defaultThreadPool())
+  {
+    return runAsync([arr]() { return arr.clone(); }, pool);
+  }
+
+  //! @brief         asynchronously converts an array to a new element type
+  //! @param[in]     arr - the array to convert
+  //! @param[in]     pool - the pool to run on
+  //! @return        the eventual converted array
+  template <class U, class T, std::size_t N>
+  AsyncResult<NArray<U, N>> asyncConvertTo(const NArray<T, N>& arr, ThreadPool& pool = defaultThreadPool())
+  {
+    return runAsync([arr]() { return arr.template convertTo<U>(); }, pool);
+  }
+
+  //! @brief         asynchronously applies an operation on a source array and
+  //!                stores the result in a new array
+  //! @param[in]     src - the source array
+  //! @param[in]     op - function or function object with the signature T(U)
+  //! @param[in]     pool - the pool to run on
+  //! @return        the eventual destination array
+  template <class T, class U, std::size_t N, class Operator>
+  AsyncResult<NArray<T, N>> asyncUnaryOp(const NArray<U, N>& src, Operator op, ThreadPool& pool = defaultThreadPool())
+  {
+    return runAsync([src, op]() { return unaryOp<T>(src, op); }, pool);
+  }
+
+  //! @brief         asynchronously applies an operation on two source arrays
+  //!                and stores the result in a new array
+  //! @param[in]     src1 - 1st source array
+  //! @param[in]     src2 - 2nd source array
+  //! @param[in]     op - function or function object with the signature
+  //!                T(U, V)
+  //! @param[in]     pool - the pool to run on
+  //! @return        the eventual destination array
+  //!
+  //! Throws std::invalid_argument if the sizes don't match (before running)
+  template <class T, class U, class V, std::size_t N, class Operator>
+  AsyncResult<NArray<T, N>> asyncBinaryOp(const NArray<U, N>& src1, const NArray<V, N>& src2, Operator op, ThreadPool& pool = defaultThreadPool())
+  {
+    if (src1.sizes() != src2.sizes())
+      throw std::invalid_argument("asyncBinaryOp(src1, src2, op): dimensions must match");
+
+    return runAsync([src1, src2, op]() { return binaryOp<T>(src1, src2, op); }, pool);
+  }
+
+  //! @brief         asynchronously combines all elements of an array into a
+  //!                single value
+  //! @param[in]     src - the source array
+  //! @param[in]     init - the initial value
+  //! @param[in]     op - function or function object with the signature
+  //!                U(U, T)
+  //! @param[in]     pool - the pool to run on
+  //! @return        the eventual combined value
+  template <class T, std::size_t N, class U, class Operator>
+  AsyncResult<U> asyncReduce(const NArray<T, N>& src, U init, Operator op, ThreadPool& pool = defaultThreadPool())
+  {
+    return runAsync([src, init, op]() { return reduce(src, init, op); }, pool);
+  }
+
+  //! @brief         asynchronously reads an array from a raw binary file
+  //! @param[in]     path - the file to read
+  //! @param[in]     sizes - the dimensions of the array
+  //! @param[in]     pool - the pool to run on
+  //! @return        the eventual array
+  template <class T, std::size_t N>
+  AsyncResult<NArray<T, N>> asyncReadRaw(const std::string& path, const Point<N>& sizes, ThreadPool& pool = defaultThreadPool())
+  {
+    return runAsync([path, sizes]() { return readRaw<T>(path, sizes); }, pool);
+  }
+
+  //! @brief         asynchronously writes an array to a raw binary file
+  //! @param[in]     path - the file to write
+  //! @param[in]     arr - the array to write
+  //! @param[in]     pool - the pool to run on
+  template <class T, std::size_t N>
+  AsyncResult<void> asyncWriteRaw(const std::string& path, const NArray<T, N>& arr, ThreadPool& pool = defaultThreadPool())
+  {
+    return runAsync([path, arr]() { writeRaw(path, arr); }, pool);
+  }
+
+} // namespace wilt
+
+#endif // !WILT_ASYNC_HPP
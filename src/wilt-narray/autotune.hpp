@@ -0,0 +1,385 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: autotune.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines a startup autotuner for the parallel work parameters
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_AUTOTUNE_HPP
+#define WILT_AUTOTUNE_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define WILT_HAS_CPUID
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#endif
+
+#include "narray.hpp"
+#include "threadpool.hpp"
+
+namespace wilt
+{
+  //////////////////////////////////////////////////////////////////////////////
+  // The autotuner measures a few parallel kernels on the current machine and
+  // picks the 'TuningParameters' that suit it: the number of workers in the
+  // default pool, the grain of work handed to each worker, and the size below
+  // which work is done serially. The results are saved in a small text file
+  // keyed by the CPU model so that only the first run pays for measuring.
+  //
+  // int main()
+  // {
+  //   wilt::autotune(); // before anything uses the default pool
+  //   ...
+  // }
+  //
+  // The measurements take a fraction of a second and use about 64MiB of
+  // memory. The cache file has one line per CPU model with its parameters
+  // separated by tabs and can be edited or deleted by hand.
+  //
+  // NOTE: the thread count only takes effect if the default pool has not been
+  // created yet, so 'autotune()' should be called at the start of the program
+
+  namespace detail
+  {
+    // Replaces the characters that would break a cache line
+    inline std::string sanitizeTuningKey(std::string key)
+    {
+      for (char& c : key)
+        if (c == '\t' || c == '\n' || c == '\r')
+          c = ' ';
+
+      const std::size_t first = key.find_first_not_of(' ');
+      const std::size_t last = key.find_last_not_of(' ');
+      return first == std::string::npos ? std::string() : key.substr(first, last - first + 1);
+    }
+
+    // Gets the brand string of the processor, empty if unknown
+    inline std::string cpuBrand()
+    {
+#ifdef WILT_HAS_CPUID
+      unsigned int regs[12] = {};
+      if (__get_cpuid_max(0x80000000, nullptr) >= 0x80000004)
+      {
+        for (unsigned int i = 0; i < 3; ++i)
+          __get_cpuid(0x80000002 + i, &regs[i * 4], &regs[i * 4 + 1], &regs[i * 4 + 2], &regs[i * 4 + 3]);
+
+        std::string brand(reinterpret_cast<const char*>(regs), sizeof(regs));
+        brand = brand.substr(0, brand.find('\0'));
+        if (!sanitizeTuningKey(brand).empty())
+          return brand;
+      }
+#endif
+
+      std::ifstream cpuinfo("/proc/cpuinfo");
+      std::string line;
+      while (std::getline(cpuinfo, line))
+      {
+        if (line.compare(0, 10, "model name") == 0 || line.compare(0, 9, "Processor") == 0)
+        {
+          const std::size_t colon = line.find(':');
+          if (colon != std::string::npos)
+            return line.substr(colon + 1);
+        }
+      }
+
+      return std::string();
+    }
+
+    // Creates the directory a file goes in if it is missing, this only goes
+    // one level deep which covers the usual "$HOME/.cache"
+    inline void createParentDirectory(const std::string& path)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+      const std::size_t slash = path.find_last_of('/');
+      if (slash != std::string::npos && slash != 0)
+        ::mkdir(path.substr(0, slash).c_str(), 0755);
+#else
+      (void)path;
+#endif
+    }
+
+    // Measures the fastest of several calls to 'func' in seconds
+    template <class Function>
+    double fastestRun(int repeats, Function func)
+    {
+      double best = 0.0;
+      for (int i = 0; i < repeats; ++i)
+      {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (i == 0 || elapsed < best)
+          best = elapsed;
+      }
+      return best;
+    }
+
+    // Sums the first 'count' elements of 'data' split into 'jobs' parallel
+    // jobs, this is the shape of the library's parallel kernels
+    template <class T>
+    double sumInJobs(const NArray<T, 1>& data, std::size_t count, std::size_t jobs, ThreadPool& pool)
+    {
+      jobs = std::max<std::size_t>(std::min(jobs, count), 1);
+      const std::size_t perJob = (count + jobs - 1) / jobs;
+      std::vector<double> sums((count + perJob - 1) / perJob);
+
+      parallelFor(sums.size(), [&](std::size_t job) {
+        const std::size_t start = job * perJob;
+        const std::size_t length = std::min(perJob, count - start);
+        sums[job] = reduce(data.rangeX((pos_t)start, (pos_t)length), 0.0, [](double a, T b) { return a + b; });
+      }, pool);
+
+      double total = 0.0;
+      for (double sum : sums)
+        total += sum;
+      return total;
+    }
+
+    // Measures summing 'bytes' of 'data' with work handed out in 'grain'
+    // sized jobs, or serially if 'grain' is 0
+    template <class T>
+    double timeSum(const NArray<T, 1>& data, std::size_t bytes, std::size_t grain, ThreadPool& pool)
+    {
+      const std::size_t count = std::min(bytes / sizeof(T), (std::size_t)data.size());
+      const std::size_t jobs = grain == 0 ? 1 : (count * sizeof(T) + grain - 1) / grain;
+
+      volatile double sink = 0.0;
+      double seconds = fastestRun(5, [&]() { sink = sink + sumInJobs(data, count, jobs, pool); });
+      (void)sink;
+      return seconds;
+    }
+
+  } // namespace detail
+
+  //! @brief         gets a name for the processor the program runs on
+  //! @return        the processor brand and the number of hardware threads,
+  //!                this is the key used in the tuning cache
+  inline std::string cpuModel()
+  {
+    std::string brand = detail::sanitizeTuningKey(detail::cpuBrand());
+    if (brand.empty())
+      brand = "unknown";
+
+    std::ostringstream out;
+    out << brand << " (" << std::thread::hardware_concurrency() << " threads)";
+    return out.str();
+  }
+
+  //! @brief         gets the file where tuning results are cached
+  //! @return        "$XDG_CACHE_HOME/wilt-narray-tuning.txt", falling back on
+  //!                "$HOME/.cache/", empty if neither is set
+  inline std::string defaultTuningCachePath()
+  {
+    const char* cache = std::getenv("XDG_CACHE_HOME");
+    if (cache && *cache)
+      return std::string(cache) + "/wilt-narray-tuning.txt";
+
+    const char* home = std::getenv("HOME");
+    if (home && *home)
+      return std::string(home) + "/.cache/wilt-narray-tuning.txt";
+
+    return std::string();
+  }
+
+  //! @brief         reads the tuning results saved for a processor
+  //! @param[in]     path - the cache file
+  //! @param[out]    params - the parameters, left unchanged if not found
+  //! @param[in]     model - the processor to look up
+  //! @return        true if the processor was found in the cache, a missing
+  //!                or malformed file is treated as empty
+  inline bool loadTuning(const std::string& path, TuningParameters& params, const std::string& model = cpuModel())
+  {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line))
+    {
+      const std::size_t tab = line.find('\t');
+      if (line.empty() || line[0] == '#' || tab == std::string::npos || line.substr(0, tab) != model)
+        continue;
+
+      std::istringstream fields(line.substr(tab + 1));
+      TuningParameters read;
+      if (fields >> read.threads >> read.grainBytes >> read.parallelThreshold)
+      {
+        params = read;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  //! @brief         saves the tuning results for a processor
+  //! @param[in]     path - the cache file
+  //! @param[in]     params - the parameters to save
+  //! @param[in]     model - the processor they were measured on
+  //! @throws        std::runtime_error if the file can't be written
+  //!
+  //! Entries for other processors are kept so a cache on a shared home folder
+  //! can serve several machines. The file is written to a temporary file and
+  //! renamed so concurrent readers never see half of it.
+  inline void saveTuning(const std::string& path, const TuningParameters& params, const std::string& model = cpuModel())
+  {
+    std::vector<std::string> lines;
+    {
+      std::ifstream file(path);
+      std::string line;
+      while (std::getline(file, line))
+        if (!line.empty() && line[0] != '#' && line.substr(0, line.find('\t')) != model)
+          lines.push_back(line);
+    }
+
+    std::ostringstream entry;
+    entry << model << '\t' << params.threads << '\t' << params.grainBytes << '\t' << params.parallelThreshold;
+    lines.push_back(entry.str());
+
+    const std::string temp = path + ".tmp";
+    {
+      std::ofstream file(temp, std::ios::trunc);
+      file << "# wilt-narray tuning: model, threads, grain bytes, parallel threshold bytes\n";
+      for (const std::string& line : lines)
+        file << line << '\n';
+      file.flush();
+      if (!file)
+        throw std::runtime_error("saveTuning(): failed to write " + temp);
+    }
+
+    if (std::rename(temp.c_str(), path.c_str()) != 0)
+    {
+      std::remove(temp.c_str());
+      throw std::runtime_error("saveTuning(): failed to replace " + path);
+    }
+  }
+
+  //! @brief         measures the parallel work parameters for this machine
+  //! @return        the best parameters found, this does not apply them
+  //!
+  //! Three things are measured in turn with reductions over float and uint8
+  //! buffers: whether all hardware threads or half of them sum a large buffer
+  //! faster (hyper-threads often just compete for memory bandwidth), which
+  //! grain from 64KiB to 4MiB splits it best, and the smallest size at which
+  //! going parallel beats a serial loop by a clear margin.
+  inline TuningParameters runAutotune()
+  {
+    const std::size_t hardware = std::max<unsigned int>(std::thread::hardware_concurrency(), 1);
+    const std::size_t totalBytes = 32 << 20;
+
+    NArray<float, 1> floats({ (pos_t)(totalBytes / sizeof(float)) }, 1.0f);
+    NArray<std::uint8_t, 1> bytes({ (pos_t)totalBytes }, (std::uint8_t)1);
+    TuningParameters params;
+
+    // threads
+    std::size_t threads = hardware;
+    if (hardware >= 4)
+    {
+      ThreadPool all(hardware);
+      ThreadPool half(hardware / 2);
+      const std::size_t grain = params.grainBytes;
+      double allTime = detail::timeSum(floats, totalBytes, grain, all) + detail::timeSum(bytes, totalBytes, grain, all);
+      double halfTime = detail::timeSum(floats, totalBytes, grain, half) + detail::timeSum(bytes, totalBytes, grain, half);
+      if (halfTime < allTime * 0.95)
+        threads = hardware / 2;
+    }
+    params.threads = threads == hardware ? 0 : threads;
+
+    ThreadPool pool(threads);
+
+    // grain
+    double bestTime = 0.0;
+    for (std::size_t grain = 64 << 10; grain <= (4 << 20); grain *= 4)
+    {
+      double time = detail::timeSum(floats, totalBytes, grain, pool) + detail::timeSum(bytes, totalBytes, grain, pool);
+      if (grain == (64 << 10) || time < bestTime)
+      {
+        bestTime = time;
+        params.grainBytes = grain;
+      }
+    }
+
+    // parallel threshold
+    params.parallelThreshold = totalBytes;
+    for (std::size_t size = 32 << 10; size < totalBytes; size *= 2)
+    {
+      const std::size_t grain = std::min(params.grainBytes, std::max<std::size_t>(size / threads, 1));
+      double serial = detail::timeSum(floats, size, 0, pool);
+      double parallel = detail::timeSum(floats, size, grain, pool);
+      if (parallel < serial * 0.8)
+      {
+        params.parallelThreshold = size;
+        break;
+      }
+    }
+
+    return params;
+  }
+
+  //! @brief         picks and applies the parallel work parameters
+  //! @param[in]     cachePath - the cache file, empty to always measure
+  //! @return        the parameters now in 'tuningParameters()'
+  //!
+  //! Uses the cached parameters for this processor if there are any, else
+  //! measures them with 'runAutotune()' and saves them. The cache is best
+  //! effort: failing to write it is not an error.
+  inline TuningParameters autotune(const std::string& cachePath = defaultTuningCachePath())
+  {
+    const std::string model = cpuModel();
+    TuningParameters params;
+    if (cachePath.empty() || !loadTuning(cachePath, params, model))
+    {
+      params = runAutotune();
+      if (!cachePath.empty())
+      {
+        try
+        {
+          detail::createParentDirectory(cachePath);
+          saveTuning(cachePath, params, model);
+        }
+        catch (const std::runtime_error&)
+        {
+        }
+      }
+    }
+
+    tuningParameters() = params;
+    return params;
+  }
+
+} // namespace wilt
+
+#endif // !WILT_AUTOTUNE_HPP
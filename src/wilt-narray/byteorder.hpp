@@ -0,0 +1,334 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: byteorder.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines byte order conversions and foreign byte order elements
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_BYTEORDER_HPP
+#define WILT_BYTEORDER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "narray.hpp"
+
+#ifdef WILT_HAS_TARGET_DISPATCH
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <stdlib.h>
+#endif
+
+namespace wilt
+{
+  enum class ByteOrder
+  {
+    LITTLE,
+    BIG,
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    NATIVE = BIG
+#else
+    NATIVE = LITTLE
+#endif
+  };
+
+namespace detail
+{
+  template <std::size_t Size> struct UnsignedOfSize;
+  template <> struct UnsignedOfSize<1> { using type = std::uint8_t; };
+  template <> struct UnsignedOfSize<2> { using type = std::uint16_t; };
+  template <> struct UnsignedOfSize<4> { using type = std::uint32_t; };
+  template <> struct UnsignedOfSize<8> { using type = std::uint64_t; };
+
+  inline std::uint8_t byteSwap(std::uint8_t value) noexcept { return value; }
+#if defined(__GNUC__) || defined(__clang__)
+  inline std::uint16_t byteSwap(std::uint16_t value) noexcept { return __builtin_bswap16(value); }
+  inline std::uint32_t byteSwap(std::uint32_t value) noexcept { return __builtin_bswap32(value); }
+  inline std::uint64_t byteSwap(std::uint64_t value) noexcept { return __builtin_bswap64(value); }
+#elif defined(_MSC_VER)
+  inline std::uint16_t byteSwap(std::uint16_t value) noexcept { return _byteswap_ushort(value); }
+  inline std::uint32_t byteSwap(std::uint32_t value) noexcept { return _byteswap_ulong(value); }
+  inline std::uint64_t byteSwap(std::uint64_t value) noexcept { return _byteswap_uint64(value); }
+#else
+  inline std::uint16_t byteSwap(std::uint16_t value) noexcept
+  {
+    return (std::uint16_t)((value << 8) | (value >> 8));
+  }
+
+  inline std::uint32_t byteSwap(std::uint32_t value) noexcept
+  {
+    value = ((value << 8) & 0xFF00FF00u) | ((value >> 8) & 0x00FF00FFu);
+    return (value << 16) | (value >> 16);
+  }
+
+  inline std::uint64_t byteSwap(std::uint64_t value) noexcept
+  {
+    value = ((value << 8) & 0xFF00FF00FF00FF00ull) | ((value >> 8) & 0x00FF00FF00FF00FFull);
+    value = ((value << 16) & 0xFFFF0000FFFF0000ull) | ((value >> 16) & 0x0000FFFF0000FFFFull);
+    return (value << 32) | (value >> 32);
+  }
+#endif
+
+  // Copies 'count' elements of 'Size' bytes from 'src' to 'dst' reversing
+  // the bytes of each an element at a time, 'src' and 'dst' may be the same
+  template <std::size_t Size>
+  void swapCopyGeneric(const char* s, char* d, std::size_t count) noexcept
+  {
+    using U = typename UnsignedOfSize<Size>::type;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+      U value;
+      std::memcpy(&value, s + i * Size, Size);
+      value = byteSwap(value);
+      std::memcpy(d + i * Size, &value, Size);
+    }
+  }
+
+#ifdef WILT_HAS_TARGET_DISPATCH
+  // Gets the shuffle that reverses each 'Size' byte element of 16 bytes
+  template <std::size_t Size>
+  const char* swapShuffle() noexcept
+  {
+    struct Order
+    {
+      alignas(16) char values[16];
+
+      Order()
+      {
+        for (std::size_t j = 0; j < 16; ++j)
+          values[j] = (char)(j / Size * Size + (Size - 1 - j % Size));
+      }
+    };
+
+    static const Order order;
+    return order.values;
+  }
+
+  // Same as 'swapCopyGeneric()' but shuffles 16 bytes at a time
+  template <std::size_t Size>
+  WILT_TARGET("ssse3") void swapCopySsse3(const char* s, char* d, std::size_t count) noexcept
+  {
+    const __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(swapShuffle<Size>()));
+
+    std::size_t i = 0;
+    for (; (i + 16 / Size) <= count; i += 16 / Size)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i * Size));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i * Size), _mm_shuffle_epi8(v, mask));
+    }
+
+    swapCopyGeneric<Size>(s + i * Size, d + i * Size, count - i);
+  }
+
+  // Same as 'swapCopyGeneric()' but shuffles 32 bytes at a time, the shuffle
+  // works within each 16 byte lane which suits elements of up to 16 bytes
+  template <std::size_t Size>
+  WILT_TARGET("avx2") void swapCopyAvx2(const char* s, char* d, std::size_t count) noexcept
+  {
+    const __m128i lane = _mm_load_si128(reinterpret_cast<const __m128i*>(swapShuffle<Size>()));
+    const __m256i mask = _mm256_broadcastsi128_si256(lane);
+
+    std::size_t i = 0;
+    for (; (i + 32 / Size) <= count; i += 32 / Size)
+    {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i * Size));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i * Size), _mm256_shuffle_epi8(v, mask));
+    }
+
+    swapCopyGeneric<Size>(s + i * Size, d + i * Size, count - i);
+  }
+#endif
+
+  // Copies 'count' elements of 'Size' bytes from 'src' to 'dst' reversing
+  // the bytes of each, 'src' and 'dst' may be the same
+  //
+  // Depending on 'cpuLevel()', 16 or 32 bytes are shuffled at a time and the
+  // remainder is done an element at a time.
+  template <std::size_t Size>
+  void swapCopy(const void* src, void* dst, std::size_t count) noexcept
+  {
+    using function_type = void(*)(const char*, char*, std::size_t);
+    static const function_type function = [] {
+#ifdef WILT_HAS_TARGET_DISPATCH
+      if (Size > 1 && cpuLevel() >= CpuLevel::AVX2)
+        return (function_type)&swapCopyAvx2<Size>;
+      if (Size > 1 && cpuLevel() >= CpuLevel::SSE42)
+        return (function_type)&swapCopySsse3<Size>;
+#endif
+      return (function_type)&swapCopyGeneric<Size>;
+    }();
+
+    function(static_cast<const char*>(src), static_cast<char*>(dst), count);
+  }
+
+  // Copies elements of 'Size' bytes from 'src' into contiguous 'dst', in
+  // row-major order, reversing the bytes of each if 'swap' is set
+  template <std::size_t Size, class T, std::size_t N>
+  void orderedCopy(const NArray<T, N>& src, void* dst, bool swap)
+  {
+    if (src.empty())
+      return;
+
+    const Point<N>& sizes = src.sizes();
+    const Point<N>& steps = src.steps();
+    const std::size_t length = (std::size_t)sizes[N-1];
+    const pos_t step = steps[N-1];
+    char* out = static_cast<char*>(dst);
+
+    Point<N> pos;
+    for (;;)
+    {
+      const T* row = src.data();
+      for (std::size_t i = 0; i + 1 < N; ++i)
+        row += pos[i] * steps[i];
+
+      if (step == 1 && swap)
+        swapCopy<Size>(row, out, length);
+      else if (step == 1)
+        std::memcpy(out, row, length * Size);
+      else
+        for (std::size_t j = 0; j < length; ++j)
+          swap ? swapCopy<Size>(row + (pos_t)j * step, out + j * Size, 1) : (void)std::memcpy(out + j * Size, row + (pos_t)j * step, Size);
+
+      out += length * Size;
+
+      std::size_t i = N - 1;
+      for (; i > 0; --i)
+      {
+        if (++pos[i-1] < sizes[i-1])
+          break;
+        pos[i-1] = 0;
+      }
+      if (i == 0)
+        return;
+    }
+  }
+
+} // namespace detail
+
+  //! @brief         reverses the bytes of a value
+  //! @param[in]     value - the value to swap
+  //! @return        the value with its bytes reversed
+  template <class T>
+  T byteSwap(T value) noexcept
+  {
+    static_assert(std::is_arithmetic<T>::value, "byteSwap(): invalid when type is not arithmetic");
+    using U = typename detail::UnsignedOfSize<sizeof(T)>::type;
+
+    U bits;
+    std::memcpy(&bits, &value, sizeof(T));
+    bits = detail::byteSwap(bits);
+    std::memcpy(&value, &bits, sizeof(T));
+    return value;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is an element stored in a specific byte order.
+  //
+  // It has the same size as T, but no alignment requirement so it can view
+  // packed file data, and converts to and from T by swapping bytes when the
+  // order isn't native. An array of them is a lazy
+  // view of foreign data: each element is swapped only when it is read, so
+  // data that is read once doesn't need a separate conversion pass. Since it
+  // is trivially copyable, it works anywhere raw elements do:
+  //
+  // auto frames = mapRaw<BigEndian<std::uint16_t>>("frames.raw", size);
+  // std::uint16_t first = frames.at(0, 0, 0);
+  //
+  // Use 'toNativeOrder()' to convert a whole array at once.
+
+  template <class T, ByteOrder Order>
+  class Endian
+  {
+  public:
+    static_assert(std::is_arithmetic<T>::value, "Endian<T, Order>: T must be arithmetic");
+
+    using value_type = T;
+    static constexpr ByteOrder order = Order;
+
+    Endian() = default;
+
+    Endian(T value) noexcept
+    {
+      *this = value;
+    }
+
+    Endian& operator= (T value) noexcept
+    {
+      if (Order != ByteOrder::NATIVE)
+        value = byteSwap(value);
+      std::memcpy(bits_, &value, sizeof(T));
+      return *this;
+    }
+
+    operator T() const noexcept
+    {
+      T value;
+      std::memcpy(&value, bits_, sizeof(T));
+      return Order != ByteOrder::NATIVE ? byteSwap(value) : value;
+    }
+
+  private:
+    unsigned char bits_[sizeof(T)];
+
+  }; // class Endian
+
+  template <class T>
+  using BigEndian = Endian<T, ByteOrder::BIG>;
+
+  template <class T>
+  using LittleEndian = Endian<T, ByteOrder::LITTLE>;
+
+  //! @brief         converts an array of elements in any byte order into a
+  //!                new native array
+  //! @param[in]     src - the array to convert
+  //! @return        the new array, contiguous and in-order
+  //!
+  //! The bytes are swapped while copying so the data is only passed over once.
+  //! Rows with a unit step are swapped 16 or 32 bytes at a time with SSSE3
+  //! or AVX2 when the processor has them.
+  template <class T, ByteOrder Order, std::size_t N>
+  NArray<T, N> toNativeOrder(const NArray<const Endian<T, Order>, N>& src)
+  {
+    if (src.empty())
+      return NArray<T, N>();
+
+    NArray<T, N> ret(src.sizes());
+    detail::orderedCopy<sizeof(T)>(src, ret.data(), Order != ByteOrder::NATIVE);
+    return ret;
+  }
+
+  template <class T, ByteOrder Order, std::size_t N>
+  NArray<T, N> toNativeOrder(const NArray<Endian<T, Order>, N>& src)
+  {
+    return toNativeOrder(src.asConst());
+  }
+
+} // namespace wilt
+
+#endif // !WILT_BYTEORDER_HPP
@@ -0,0 +1,617 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: checkpoint.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines a file format and parallel writer/reader for sets of named arrays
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_CHECKPOINT_HPP
+#define WILT_CHECKPOINT_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "narray.hpp"
+#include "mapping.hpp"
+#include "threadpool.hpp"
+
+namespace wilt
+{
+  // The metadata of an array stored in a checkpoint
+  struct CheckpointEntry
+  {
+    std::string name;
+    ElementType type;
+    std::size_t elementSize;
+    std::vector<pos_t> sizes;
+    std::uint64_t offset;
+    std::uint64_t bytes;
+  };
+
+namespace detail
+{
+  // File layout:
+  //   header block   CHECKPOINT_ALIGNMENT bytes, starting with CheckpointHeader
+  //   data regions   one per array, each starting on CHECKPOINT_ALIGNMENT
+  //   index          one record per array, starting on CHECKPOINT_ALIGNMENT
+  //
+  // Each index record is: u32 name length, name, u8 element type, u8
+  // dimensions, u16 reserved, u32 element size, i64 sizes[dimensions], u64
+  // data offset, u64 data bytes. Everything is in native byte order.
+
+  const std::uint32_t CHECKPOINT_MAGIC = 0x4B434E57; // "WNCK"
+  const std::uint32_t CHECKPOINT_VERSION = 1;
+  const std::size_t CHECKPOINT_ALIGNMENT = 4096;
+
+  struct CheckpointHeader
+  {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t count;
+    std::uint64_t indexOffset;
+    std::uint64_t indexBytes;
+  };
+
+  inline std::uint64_t alignUp(std::uint64_t value, std::uint64_t alignment) noexcept
+  {
+    return (value + alignment - 1) / alignment * alignment;
+  }
+
+  // A zero-filled buffer aligned for O_DIRECT transfers
+  class AlignedBuffer
+  {
+  public:
+    explicit AlignedBuffer(std::size_t size)
+      : data_(nullptr)
+      , size_(size)
+    {
+      void* data = nullptr;
+      if (::posix_memalign(&data, CHECKPOINT_ALIGNMENT, std::max<std::size_t>(size, 1)) != 0)
+        throw std::bad_alloc();
+      data_ = static_cast<char*>(data);
+      std::memset(data_, 0, size);
+    }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator= (const AlignedBuffer&) = delete;
+
+    ~AlignedBuffer()
+    {
+      std::free(data_);
+    }
+
+    char* data() const noexcept
+    {
+      return data_;
+    }
+
+    std::size_t size() const noexcept
+    {
+      return size_;
+    }
+
+  private:
+    char* data_;
+    std::size_t size_;
+
+  }; // class AlignedBuffer
+
+  inline void appendBytes(std::vector<char>& buffer, const void* data, std::size_t size)
+  {
+    const char* ptr = static_cast<const char*>(data);
+    buffer.insert(buffer.end(), ptr, ptr + size);
+  }
+
+  template <class U>
+  void appendValue(std::vector<char>& buffer, U value)
+  {
+    appendBytes(buffer, &value, sizeof(U));
+  }
+
+  template <class U>
+  U readValue(const std::vector<char>& buffer, std::size_t& pos)
+  {
+    if (buffer.size() - pos < sizeof(U))
+      throw std::runtime_error("CheckpointReader(): index is truncated");
+
+    U value;
+    std::memcpy(&value, buffer.data() + pos, sizeof(U));
+    pos += sizeof(U);
+    return value;
+  }
+
+} // namespace detail
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is designed to write many named arrays into a single file.
+  //
+  // Arrays are registered with 'add()' (only the array handle is kept, not a
+  // copy, so the data must not change until 'write()' returns). 'write()'
+  // lays out every array in its own region aligned to 4096 bytes, splits the
+  // regions into chunks and writes the chunks in parallel with `pwrite()` on
+  // a thread pool. Arrays that are contiguous and in-order are written
+  // straight from their memory, other views are packed a row at a time into
+  // a staging buffer per chunk. The index is written last, followed by the
+  // header, and the data is flushed with `fdatasync()` before the file is
+  // renamed into place.
+  //
+  // With 'direct' set, the file is opened with `O_DIRECT` to keep checkpoint
+  // data out of the page cache. Every transfer then goes through aligned
+  // staging buffers. If the filesystem doesn't support `O_DIRECT`, the file
+  // is written through the page cache instead.
+  //
+  // NOTE: element types must be trivially copyable
+
+  class CheckpointWriter
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Prepares to write the checkpoint to 'path', 'chunkBytes' is roughly the
+    // amount of data written by each parallel job
+    explicit CheckpointWriter(const std::string& path, bool direct = false, std::size_t chunkBytes = 8 << 20)
+      : path_(path)
+      , direct_(direct)
+      , usedDirect_(false)
+      , chunkBytes_(std::max<std::size_t>(chunkBytes, detail::CHECKPOINT_ALIGNMENT))
+      , entries_()
+    {
+
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // The number of arrays added
+    std::size_t size() const noexcept
+    {
+      return entries_.size();
+    }
+
+    // Whether the last 'write()' bypassed the page cache
+    bool usedDirect() const noexcept
+    {
+      return usedDirect_;
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // MODIFIER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Adds an array to be written under 'name', names must be unique
+    template <class T, std::size_t N>
+    void add(const std::string& name, const NArray<T, N>& arr)
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "add(): invalid when element type is not trivially copyable");
+      using U = typename std::remove_const<T>::type;
+
+      for (auto& entry : entries_)
+        if (entry.info.name == name)
+          throw std::invalid_argument("add(name, arr): '" + name + "' was already added");
+
+      Entry entry;
+      entry.info.name = name;
+      entry.info.type = elementTypeOf<U>();
+      entry.info.elementSize = sizeof(T);
+      for (std::size_t i = 0; i < N; ++i)
+        entry.info.sizes.push_back(arr.sizes()[i]);
+      entry.info.offset = 0;
+      entry.info.bytes = arr.size() * sizeof(T);
+      entry.contiguous = arr.isContiguous() && arr.isAligned() ? reinterpret_cast<const char*>(arr.data()) : nullptr;
+
+      // chunks must hold whole elements and, for O_DIRECT, whole blocks
+      std::size_t unit = sizeof(T) / gcd_(sizeof(T), detail::CHECKPOINT_ALIGNMENT) * detail::CHECKPOINT_ALIGNMENT;
+      entry.chunkBytes = std::max<std::size_t>(chunkBytes_ / unit, 1) * unit;
+
+      NArray<const T, N> keep = arr;
+      entry.pack = [keep](std::uint64_t first, std::uint64_t bytes, char* dst) {
+        detail::packElements(keep, (std::size_t)(first / sizeof(T)), (std::size_t)(bytes / sizeof(T)), reinterpret_cast<U*>(dst));
+      };
+
+      entries_.push_back(std::move(entry));
+    }
+
+    // Writes all the added arrays, replacing the file if it exists
+    //
+    // The checkpoint is written to '<path>.tmp' and renamed over 'path' once
+    // it is flushed, so a crash during the write leaves the previous
+    // checkpoint intact.
+    //
+    // Throws std::runtime_error if the file can't be written
+    void write(ThreadPool& pool = defaultThreadPool())
+    {
+      WILT_TRACE_SCOPE("writeCheckpoint");
+      const std::string temp = path_ + ".tmp";
+      int fd = -1;
+      usedDirect_ = false;
+#ifdef O_DIRECT
+      if (direct_)
+      {
+        fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        usedDirect_ = fd >= 0;
+      }
+#endif
+      if (fd < 0)
+        fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (fd < 0)
+        throw std::runtime_error(detail::errnoMessage("write(): could not open '" + temp + "'"));
+
+      try
+      {
+        detail::FileDescriptor file(fd);
+        write_(fd, pool);
+      }
+      catch (...)
+      {
+        ::unlink(temp.c_str());
+        throw;
+      }
+
+      if (std::rename(temp.c_str(), path_.c_str()) != 0)
+      {
+        std::string message = detail::errnoMessage("write(): could not replace '" + path_ + "'");
+        ::unlink(temp.c_str());
+        throw std::runtime_error(message);
+      }
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Writes the checkpoint into the open file and flushes it
+    void write_(int fd, ThreadPool& pool)
+    {
+      // lay out the data regions and the index
+      std::uint64_t offset = detail::CHECKPOINT_ALIGNMENT;
+      for (auto& entry : entries_)
+      {
+        entry.info.offset = offset;
+        offset = detail::alignUp(offset + entry.info.bytes, detail::CHECKPOINT_ALIGNMENT);
+      }
+
+      std::vector<char> index;
+      for (auto& entry : entries_)
+      {
+        detail::appendValue<std::uint32_t>(index, (std::uint32_t)entry.info.name.size());
+        detail::appendBytes(index, entry.info.name.data(), entry.info.name.size());
+        detail::appendValue<std::uint8_t>(index, (std::uint8_t)entry.info.type);
+        detail::appendValue<std::uint8_t>(index, (std::uint8_t)entry.info.sizes.size());
+        detail::appendValue<std::uint16_t>(index, 0);
+        detail::appendValue<std::uint32_t>(index, (std::uint32_t)entry.info.elementSize);
+        for (pos_t size : entry.info.sizes)
+          detail::appendValue<std::int64_t>(index, size);
+        detail::appendValue<std::uint64_t>(index, entry.info.offset);
+        detail::appendValue<std::uint64_t>(index, entry.info.bytes);
+      }
+
+      detail::CheckpointHeader header;
+      header.magic = detail::CHECKPOINT_MAGIC;
+      header.version = detail::CHECKPOINT_VERSION;
+      header.count = entries_.size();
+      header.indexOffset = offset;
+      header.indexBytes = index.size();
+
+      // write the data
+      struct Chunk
+      {
+        const Entry* entry;
+        std::uint64_t first;
+        std::uint64_t bytes;
+      };
+
+      std::vector<Chunk> chunks;
+      for (auto& entry : entries_)
+        for (std::uint64_t first = 0; first < entry.info.bytes; first += entry.chunkBytes)
+          chunks.push_back(Chunk{ &entry, first, std::min<std::uint64_t>(entry.chunkBytes, entry.info.bytes - first) });
+
+      bool direct = usedDirect_;
+      parallelFor(chunks.size(), [&](std::size_t i) {
+        writeChunk_(*chunks[i].entry, chunks[i].first, chunks[i].bytes, direct, fd);
+      }, pool);
+
+      // write the index and header, the header goes last so a partial
+      // checkpoint isn't recognized
+      writeBlock_(fd, index.data(), index.size(), header.indexOffset);
+      writeBlock_(fd, &header, sizeof(header), 0);
+
+      if (::ftruncate(fd, (off_t)(header.indexOffset + index.size())) != 0)
+        throw std::runtime_error(detail::errnoMessage("write(): could not resize '" + path_ + "'"));
+      if (::fdatasync(fd) != 0)
+        throw std::runtime_error(detail::errnoMessage("write(): could not flush '" + path_ + "'"));
+    }
+
+    struct Entry
+    {
+      CheckpointEntry info;
+      const char* contiguous;
+      std::size_t chunkBytes;
+      std::function<void(std::uint64_t, std::uint64_t, char*)> pack;
+    };
+
+    static std::size_t gcd_(std::size_t a, std::size_t b) noexcept
+    {
+      while (b != 0)
+      {
+        std::size_t t = a % b;
+        a = b;
+        b = t;
+      }
+      return a;
+    }
+
+    static void writeChunk_(const Entry& entry, std::uint64_t first, std::uint64_t bytes, bool direct, int fd)
+    {
+      off_t offset = (off_t)(entry.info.offset + first);
+      if (entry.contiguous && !direct)
+      {
+        detail::pwriteAll(fd, entry.contiguous + first, (std::size_t)bytes, offset);
+        return;
+      }
+
+      // O_DIRECT needs whole blocks, the padding falls in the gap before
+      // the next region
+      detail::AlignedBuffer staging((std::size_t)(direct ? detail::alignUp(bytes, detail::CHECKPOINT_ALIGNMENT) : bytes));
+      if (entry.contiguous)
+        std::memcpy(staging.data(), entry.contiguous + first, (std::size_t)bytes);
+      else
+        entry.pack(first, bytes, staging.data());
+      detail::pwriteAll(fd, staging.data(), staging.size(), offset);
+    }
+
+    void writeBlock_(int fd, const void* data, std::size_t size, std::uint64_t offset) const
+    {
+      detail::AlignedBuffer staging((std::size_t)detail::alignUp(size, detail::CHECKPOINT_ALIGNMENT));
+      std::memcpy(staging.data(), data, size);
+      detail::pwriteAll(fd, staging.data(), usedDirect_ ? staging.size() : size, (off_t)offset);
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::string path_;
+    bool direct_;
+    bool usedDirect_;
+    std::size_t chunkBytes_;
+    std::vector<Entry> entries_;
+
+  }; // class CheckpointWriter
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is designed to read arrays from a file written by
+  // `CheckpointWriter`.
+  //
+  // The index is read when the reader is created. 'read()' copies an array
+  // into a new allocation with `pread()`. 'map()' instead returns a view over
+  // a read-only mapping of the whole file, so restores only touch the pages
+  // that are used; the mapping lives as long as any array made from it.
+
+  class CheckpointReader
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Opens the checkpoint at 'path' and reads its index
+    //
+    // Throws std::runtime_error if the file can't be read or isn't a
+    // checkpoint
+    explicit CheckpointReader(const std::string& path)
+      : path_(path)
+      , file_(std::make_shared<detail::FileDescriptor>(::open(path.c_str(), O_RDONLY)))
+      , fileSize_(0)
+      , entries_()
+      , mapping_()
+    {
+      if (file_->get() < 0)
+        throw std::runtime_error(detail::errnoMessage("CheckpointReader(): could not open '" + path + "'"));
+
+      struct stat st;
+      if (::fstat(file_->get(), &st) != 0)
+        throw std::runtime_error(detail::errnoMessage("CheckpointReader(): could not stat '" + path + "'"));
+      fileSize_ = (std::uint64_t)st.st_size;
+
+      detail::CheckpointHeader header;
+      if (fileSize_ < sizeof(header))
+        throw std::runtime_error("CheckpointReader(): '" + path + "' is not a checkpoint");
+      detail::preadAll(file_->get(), &header, sizeof(header), 0);
+      if (header.magic != detail::CHECKPOINT_MAGIC || header.version != detail::CHECKPOINT_VERSION)
+        throw std::runtime_error("CheckpointReader(): '" + path + "' is not a checkpoint");
+      if (header.indexOffset > fileSize_ || header.indexBytes > fileSize_ - header.indexOffset)
+        throw std::runtime_error("CheckpointReader(): '" + path + "' is truncated");
+
+      std::vector<char> index((std::size_t)header.indexBytes);
+      detail::preadAll(file_->get(), index.data(), index.size(), (off_t)header.indexOffset);
+
+      std::size_t pos = 0;
+      for (std::uint64_t i = 0; i < header.count; ++i)
+      {
+        CheckpointEntry entry;
+        std::uint32_t length = detail::readValue<std::uint32_t>(index, pos);
+        if (index.size() - pos < length)
+          throw std::runtime_error("CheckpointReader(): index is truncated");
+        entry.name.assign(index.data() + pos, length);
+        pos += length;
+        entry.type = (ElementType)detail::readValue<std::uint8_t>(index, pos);
+        std::uint8_t dims = detail::readValue<std::uint8_t>(index, pos);
+        detail::readValue<std::uint16_t>(index, pos);
+        entry.elementSize = detail::readValue<std::uint32_t>(index, pos);
+        for (std::uint8_t d = 0; d < dims; ++d)
+          entry.sizes.push_back((pos_t)detail::readValue<std::int64_t>(index, pos));
+        entry.offset = detail::readValue<std::uint64_t>(index, pos);
+        entry.bytes = detail::readValue<std::uint64_t>(index, pos);
+
+        if (entry.offset > fileSize_ || entry.bytes > fileSize_ - entry.offset)
+          throw std::runtime_error("CheckpointReader(): '" + path + "' is truncated");
+
+        // the data must be exactly the elements described, 'read()' and
+        // 'map()' rely on it to stay within their buffers
+        std::uint64_t expected = entry.elementSize;
+        for (pos_t size : entry.sizes)
+        {
+          if (size < 0 || (size != 0 && expected > UINT64_MAX / (std::uint64_t)size))
+            throw std::runtime_error("CheckpointReader(): '" + path + "' has an invalid index");
+          expected *= (std::uint64_t)size;
+        }
+        if (entry.bytes != expected)
+          throw std::runtime_error("CheckpointReader(): '" + path + "' has an invalid index");
+        entries_.push_back(std::move(entry));
+      }
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // The arrays in the checkpoint, in the order they were added
+    const std::vector<CheckpointEntry>& entries() const noexcept
+    {
+      return entries_;
+    }
+
+    bool contains(const std::string& name) const noexcept
+    {
+      return find_(name) != nullptr;
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESS FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Reads the array 'name' into a new allocation
+    //
+    // Throws std::runtime_error if the array doesn't exist or its element
+    // type or dimensions don't match
+    template <class T, std::size_t N>
+    NArray<T, N> read(const std::string& name) const
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "read(): invalid when element type is not trivially copyable");
+
+      const CheckpointEntry& entry = get_<T, N>(name);
+      if (entry.bytes == 0)
+        return NArray<T, N>();
+
+      WILT_TRACE_SCOPE("readCheckpoint", (std::size_t)entry.bytes);
+      NArray<T, N> ret(sizes_<N>(entry));
+      detail::preadAll(file_->get(), ret.data(), (std::size_t)entry.bytes, (off_t)entry.offset);
+      return ret;
+    }
+
+    // Creates a read-only view of the array 'name' over a mapping of the file
+    //
+    // Throws std::runtime_error if the array doesn't exist or its element
+    // type or dimensions don't match
+    template <class T, std::size_t N>
+    NArray<const T, N> map(const std::string& name)
+    {
+      static_assert(std::is_trivially_copyable<T>::value, "map(): invalid when element type is not trivially copyable");
+
+      const CheckpointEntry& entry = get_<T, N>(name);
+      if (entry.bytes == 0)
+        return NArray<const T, N>();
+
+      if (!mapping_)
+        mapping_ = std::make_shared<detail::MemoryMapping>(file_->get(), (std::size_t)fileSize_, false);
+
+      const T* data = reinterpret_cast<const T*>(mapping_->data() + entry.offset);
+      return NArray<const T, N>(std::shared_ptr<const T>(mapping_, data), sizes_<N>(entry));
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    const CheckpointEntry* find_(const std::string& name) const noexcept
+    {
+      for (auto& entry : entries_)
+        if (entry.name == name)
+          return &entry;
+      return nullptr;
+    }
+
+    template <class T, std::size_t N>
+    const CheckpointEntry& get_(const std::string& name) const
+    {
+      const CheckpointEntry* entry = find_(name);
+      if (!entry)
+        throw std::runtime_error("'" + name + "' is not in '" + path_ + "'");
+      if (entry->type != elementTypeOf<T>() || entry->elementSize != sizeof(T))
+        throw std::runtime_error("'" + name + "' has a different element type");
+      if (entry->sizes.size() != N)
+        throw std::runtime_error("'" + name + "' has a different number of dimensions");
+      return *entry;
+    }
+
+    template <std::size_t N>
+    static Point<N> sizes_(const CheckpointEntry& entry)
+    {
+      Point<N> sizes;
+      for (std::size_t i = 0; i < N; ++i)
+        sizes[i] = entry.sizes[i];
+      return sizes;
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::string path_;
+    std::shared_ptr<detail::FileDescriptor> file_;
+    std::uint64_t fileSize_;
+    std::vector<CheckpointEntry> entries_;
+    std::shared_ptr<detail::MemoryMapping> mapping_;
+
+  }; // class CheckpointReader
+
+} // namespace wilt
+
+#endif // !WILT_CHECKPOINT_HPP
@@ -0,0 +1,426 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: checksum.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines CRC-32C checksums and content hashes of arrays
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_CHECKSUM_HPP
+#define WILT_CHECKSUM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "narray.hpp"
+#include "threadpool.hpp"
+
+#ifdef WILT_HAS_TARGET_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace wilt
+{
+  // A 128-bit hash value
+  struct Hash128
+  {
+    std::uint64_t low;
+    std::uint64_t high;
+  };
+
+  inline bool operator== (const Hash128& lhs, const Hash128& rhs) noexcept
+  {
+    return lhs.low == rhs.low && lhs.high == rhs.high;
+  }
+
+  inline bool operator!= (const Hash128& lhs, const Hash128& rhs) noexcept
+  {
+    return !(lhs == rhs);
+  }
+
+namespace detail
+{
+  // The reflected CRC-32C (Castagnoli) polynomial
+  const std::uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+  // The number of bytes each leaf of a parallel checksum or hash covers
+  const std::size_t CHECKSUM_BLOCK_BYTES = 64 * 1024;
+
+  // Slicing-by-8 tables for computing CRC-32C without SSE4.2
+  inline const std::uint32_t (&crc32cTables())[8][256]
+  {
+    struct Tables
+    {
+      std::uint32_t values[8][256];
+
+      Tables()
+      {
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+          std::uint32_t crc = i;
+          for (int j = 0; j < 8; ++j)
+            crc = (crc >> 1) ^ (CRC32C_POLYNOMIAL & (0u - (crc & 1)));
+          values[0][i] = crc;
+        }
+        for (std::uint32_t i = 0; i < 256; ++i)
+          for (int t = 1; t < 8; ++t)
+            values[t][i] = (values[t-1][i] >> 8) ^ values[0][values[t-1][i] & 0xFF];
+      }
+    };
+
+    static const Tables tables;
+    return tables.values;
+  }
+
+  // Updates a raw (not inverted) CRC-32C state with 'size' bytes using the
+  // lookup tables
+  inline std::uint32_t crc32cTable(std::uint32_t crc, const unsigned char* data, std::size_t size) noexcept
+  {
+    auto& tables = crc32cTables();
+    for (; size >= 8; data += 8, size -= 8)
+    {
+      std::uint32_t low = crc ^ ((std::uint32_t)data[0] | (std::uint32_t)data[1] << 8 | (std::uint32_t)data[2] << 16 | (std::uint32_t)data[3] << 24);
+      crc = tables[7][low & 0xFF] ^ tables[6][(low >> 8) & 0xFF] ^ tables[5][(low >> 16) & 0xFF] ^ tables[4][low >> 24]
+          ^ tables[3][data[4]] ^ tables[2][data[5]] ^ tables[1][data[6]] ^ tables[0][data[7]];
+    }
+    for (; size > 0; ++data, --size)
+      crc = (crc >> 8) ^ tables[0][(crc ^ *data) & 0xFF];
+    return crc;
+  }
+
+#ifdef WILT_HAS_TARGET_DISPATCH
+  // Same as 'crc32cTable()' but with the SSE4.2 crc32 instruction
+  WILT_TARGET("sse4.2") inline std::uint32_t crc32cHardware(std::uint32_t crc, const unsigned char* data, std::size_t size) noexcept
+  {
+#if defined(__x86_64__)
+    std::uint64_t crc64 = crc;
+    for (; size >= 8; data += 8, size -= 8)
+    {
+      std::uint64_t word;
+      std::memcpy(&word, data, 8);
+      crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = (std::uint32_t)crc64;
+#endif
+    for (; size > 0; ++data, --size)
+      crc = _mm_crc32_u8(crc, *data);
+    return crc;
+  }
+#endif
+
+  // Updates a raw (not inverted) CRC-32C state with 'size' bytes
+  inline std::uint32_t crc32cRaw(std::uint32_t crc, const unsigned char* data, std::size_t size) noexcept
+  {
+#ifdef WILT_HAS_TARGET_DISPATCH
+    static const bool hardware = cpuLevel() >= CpuLevel::SSE42;
+    if (hardware)
+      return crc32cHardware(crc, data, size);
+#endif
+    return crc32cTable(crc, data, size);
+  }
+
+  inline std::uint32_t gf2Times(const std::uint32_t* matrix, std::uint32_t vector) noexcept
+  {
+    std::uint32_t sum = 0;
+    for (; vector != 0; vector >>= 1, ++matrix)
+      if (vector & 1)
+        sum ^= *matrix;
+    return sum;
+  }
+
+  inline void gf2Square(std::uint32_t* square, const std::uint32_t* matrix) noexcept
+  {
+    for (int n = 0; n < 32; ++n)
+      square[n] = gf2Times(matrix, matrix[n]);
+  }
+
+  // A 64-bit hash of bytes, built from 32-byte stripes in four independent
+  // lanes so it runs near memory speed
+  const std::uint64_t HASH_PRIME1 = 0x9E3779B185EBCA87ull;
+  const std::uint64_t HASH_PRIME2 = 0xC2B2AE3D27D4EB4Full;
+  const std::uint64_t HASH_PRIME3 = 0x165667B19E3779F9ull;
+  const std::uint64_t HASH_PRIME4 = 0x85EBCA77C2B2AE63ull;
+  const std::uint64_t HASH_PRIME5 = 0x27D4EB2F165667C5ull;
+
+  inline std::uint64_t rotl64(std::uint64_t value, int bits) noexcept
+  {
+    return (value << bits) | (value >> (64 - bits));
+  }
+
+  inline std::uint64_t read64(const unsigned char* data) noexcept
+  {
+    std::uint64_t value;
+    std::memcpy(&value, data, 8);
+    return value;
+  }
+
+  inline std::uint64_t hashRound(std::uint64_t acc, std::uint64_t input) noexcept
+  {
+    return rotl64(acc + input * HASH_PRIME2, 31) * HASH_PRIME1;
+  }
+
+  inline std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t seed) noexcept
+  {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    std::uint64_t h;
+
+    if (size >= 32)
+    {
+      std::uint64_t v1 = seed + HASH_PRIME1 + HASH_PRIME2;
+      std::uint64_t v2 = seed + HASH_PRIME2;
+      std::uint64_t v3 = seed;
+      std::uint64_t v4 = seed - HASH_PRIME1;
+      for (; end - p >= 32; p += 32)
+      {
+        v1 = hashRound(v1, read64(p));
+        v2 = hashRound(v2, read64(p + 8));
+        v3 = hashRound(v3, read64(p + 16));
+        v4 = hashRound(v4, read64(p + 24));
+      }
+      h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+      for (std::uint64_t v : { v1, v2, v3, v4 })
+        h = (h ^ hashRound(0, v)) * HASH_PRIME1 + HASH_PRIME4;
+    }
+    else
+    {
+      h = seed + HASH_PRIME5;
+    }
+
+    h += (std::uint64_t)size;
+    for (; end - p >= 8; p += 8)
+      h = rotl64(h ^ hashRound(0, read64(p)), 27) * HASH_PRIME1 + HASH_PRIME4;
+    for (; p != end; ++p)
+      h = rotl64(h ^ (*p * HASH_PRIME5), 11) * HASH_PRIME1;
+
+    h ^= h >> 33;
+    h *= HASH_PRIME2;
+    h ^= h >> 29;
+    h *= HASH_PRIME3;
+    h ^= h >> 32;
+    return h;
+  }
+
+  // Calls 'func(data, bytes, block)' on each leaf-sized block of the logical
+  // contents of 'arr', in parallel. Contiguous arrays are passed directly,
+  // other views are packed into a staging buffer first.
+  template <class T, std::size_t N, class Function>
+  void forEachBlock(const NArray<T, N>& arr, std::size_t blockElements, Function func, ThreadPool& pool)
+  {
+    using U = typename std::remove_const<T>::type;
+
+    const std::size_t total = arr.size();
+    const std::size_t blocks = (total + blockElements - 1) / blockElements;
+    const std::size_t jobs = std::min(parallelJobs(total * sizeof(T)), blocks);
+    const std::size_t blocksPerJob = (blocks + jobs - 1) / jobs;
+    const bool contiguous = arr.isContiguous() && arr.isAligned();
+
+    parallelFor((blocks + blocksPerJob - 1) / blocksPerJob, [&](std::size_t job) {
+      std::vector<U> staging;
+      std::size_t last = std::min(blocks, (job + 1) * blocksPerJob);
+      for (std::size_t block = job * blocksPerJob; block < last; ++block)
+      {
+        std::size_t first = block * blockElements;
+        std::size_t count = std::min(blockElements, total - first);
+        if (contiguous)
+        {
+          func(static_cast<const void*>(arr.data() + first), count * sizeof(T), block);
+        }
+        else
+        {
+          staging.resize(count);
+          packElements(arr, first, count, staging.data());
+          func(static_cast<const void*>(staging.data()), count * sizeof(T), block);
+        }
+      }
+    }, pool);
+  }
+
+  // Hashes the sizes of an array into the seed of its root hash, so arrays
+  // with the same elements in different shapes hash differently
+  template <std::size_t N>
+  std::uint64_t shapeSeed(const Point<N>& sizes, std::uint64_t seed) noexcept
+  {
+    std::int64_t values[N];
+    for (std::size_t i = 0; i < N; ++i)
+      values[i] = sizes[i];
+    return hashBytes(values, sizeof(values), seed);
+  }
+
+} // namespace detail
+
+  //! @brief         computes the CRC-32C (Castagnoli) checksum of bytes
+  //! @param[in]     data - the bytes to checksum
+  //! @param[in]     size - the number of bytes
+  //! @param[in]     crc - the checksum of the preceding bytes, if any
+  //! @return        the checksum of the preceding bytes followed by these
+  //!
+  //! Uses the SSE4.2 crc32 instruction when the processor has it, otherwise
+  //! tables
+  inline std::uint32_t crc32c(const void* data, std::size_t size, std::uint32_t crc = 0) noexcept
+  {
+    return ~detail::crc32cRaw(~crc, static_cast<const unsigned char*>(data), size);
+  }
+
+  //! @brief         combines the checksums of two consecutive byte ranges
+  //! @param[in]     crc1 - the checksum of the first range
+  //! @param[in]     crc2 - the checksum of the second range
+  //! @param[in]     size2 - the number of bytes in the second range
+  //! @return        the checksum of both ranges together
+  inline std::uint32_t crc32cCombine(std::uint32_t crc1, std::uint32_t crc2, std::size_t size2) noexcept
+  {
+    if (size2 == 0)
+      return crc1;
+
+    // the operator for one zero bit, then squared for two and four
+    std::uint32_t even[32];
+    std::uint32_t odd[32];
+    odd[0] = detail::CRC32C_POLYNOMIAL;
+    for (int n = 1; n < 32; ++n)
+      odd[n] = 1u << (n - 1);
+    detail::gf2Square(even, odd);
+    detail::gf2Square(odd, even);
+
+    // apply one zero byte's operator per set bit of 'size2', squaring as we go
+    do
+    {
+      detail::gf2Square(even, odd);
+      if (size2 & 1)
+        crc1 = detail::gf2Times(even, crc1);
+      size2 >>= 1;
+      if (size2 == 0)
+        break;
+
+      detail::gf2Square(odd, even);
+      if (size2 & 1)
+        crc1 = detail::gf2Times(odd, crc1);
+      size2 >>= 1;
+    } while (size2 != 0);
+
+    return crc1 ^ crc2;
+  }
+
+  //! @brief         computes the CRC-32C checksum of the elements of an array
+  //! @param[in]     arr - the array to checksum
+  //! @param[in]     pool - the pool to compute on
+  //! @return        the checksum of the element bytes in row-major order
+  //!
+  //! The result is the same for any view with the same elements, so it
+  //! matches the checksum of the array written with 'writeRaw()'. Large
+  //! arrays are split into blocks that are checksummed in parallel and then
+  //! combined.
+  template <class T, std::size_t N>
+  std::uint32_t crc32c(const NArray<T, N>& arr, ThreadPool& pool = defaultThreadPool())
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "crc32c(): invalid when element type is not trivially copyable");
+
+    if (arr.empty())
+      return 0;
+
+    const std::size_t blockElements = std::max<std::size_t>(detail::CHECKSUM_BLOCK_BYTES / sizeof(T), 1);
+    std::vector<std::uint32_t> crcs((arr.size() + blockElements - 1) / blockElements);
+    std::vector<std::size_t> sizes(crcs.size());
+
+    detail::forEachBlock(arr, blockElements, [&](const void* data, std::size_t bytes, std::size_t block) {
+      crcs[block] = crc32c(data, bytes);
+      sizes[block] = bytes;
+    }, pool);
+
+    std::uint32_t crc = crcs[0];
+    for (std::size_t i = 1; i < crcs.size(); ++i)
+      crc = crc32cCombine(crc, crcs[i], sizes[i]);
+    return crc;
+  }
+
+  //! @brief         computes a fast 64-bit hash of the contents of an array
+  //! @param[in]     arr - the array to hash
+  //! @param[in]     seed - a value to vary the hash with
+  //! @param[in]     pool - the pool to compute on
+  //! @return        the hash of the sizes and the element bytes in row-major
+  //!                order
+  //!
+  //! The result is the same for any view with the same sizes and elements, it
+  //! is not affected by steps, offsets, or the number of threads. The
+  //! elements are hashed in fixed 64KiB blocks in parallel and the block
+  //! hashes are then hashed together.
+  //!
+  //! NOTE: this is not a cryptographic hash
+  template <class T, std::size_t N>
+  std::uint64_t contentHash64(const NArray<T, N>& arr, std::uint64_t seed = 0, ThreadPool& pool = defaultThreadPool())
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "contentHash64(): invalid when element type is not trivially copyable");
+
+    const std::size_t blockElements = std::max<std::size_t>(detail::CHECKSUM_BLOCK_BYTES / sizeof(T), 1);
+    std::vector<std::uint64_t> leaves((arr.size() + blockElements - 1) / blockElements);
+
+    if (!arr.empty())
+    {
+      detail::forEachBlock(arr, blockElements, [&](const void* data, std::size_t bytes, std::size_t block) {
+        leaves[block] = detail::hashBytes(data, bytes, seed);
+      }, pool);
+    }
+
+    return detail::hashBytes(leaves.data(), leaves.size() * sizeof(std::uint64_t), detail::shapeSeed(arr.sizes(), seed));
+  }
+
+  //! @brief         computes a fast 128-bit hash of the contents of an array
+  //! @param[in]     arr - the array to hash
+  //! @param[in]     seed - a value to vary the hash with
+  //! @param[in]     pool - the pool to compute on
+  //! @return        the hash of the sizes and the element bytes in row-major
+  //!                order
+  //!
+  //! Like 'contentHash64()' but with two independent halves, for uses like
+  //! content-addressed caches where collisions must be extremely unlikely.
+  //!
+  //! NOTE: this is not a cryptographic hash
+  template <class T, std::size_t N>
+  Hash128 contentHash128(const NArray<T, N>& arr, std::uint64_t seed = 0, ThreadPool& pool = defaultThreadPool())
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "contentHash128(): invalid when element type is not trivially copyable");
+
+    const std::uint64_t seeds[2] = { seed, seed ^ detail::HASH_PRIME3 };
+    const std::size_t blockElements = std::max<std::size_t>(detail::CHECKSUM_BLOCK_BYTES / sizeof(T), 1);
+    const std::size_t blocks = (arr.size() + blockElements - 1) / blockElements;
+    std::vector<std::uint64_t> leaves[2] = { std::vector<std::uint64_t>(blocks), std::vector<std::uint64_t>(blocks) };
+
+    if (!arr.empty())
+    {
+      detail::forEachBlock(arr, blockElements, [&](const void* data, std::size_t bytes, std::size_t block) {
+        leaves[0][block] = detail::hashBytes(data, bytes, seeds[0]);
+        leaves[1][block] = detail::hashBytes(data, bytes, seeds[1]);
+      }, pool);
+    }
+
+    Hash128 ret;
+    ret.low = detail::hashBytes(leaves[0].data(), blocks * sizeof(std::uint64_t), detail::shapeSeed(arr.sizes(), seeds[0]));
+    ret.high = detail::hashBytes(leaves[1].data(), blocks * sizeof(std::uint64_t), detail::shapeSeed(arr.sizes(), seeds[1]));
+    return ret;
+  }
+
+} // namespace wilt
+
+#endif // !WILT_CHECKSUM_HPP
@@ -0,0 +1,471 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: computed.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines read-only arrays whose elements are computed from their position
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_COMPUTED_HPP
+#define WILT_COMPUTED_HPP
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "narray.hpp"
+
+namespace wilt
+{
+namespace detail
+{
+  template <class T>
+  struct is_computed : std::false_type {};
+
+  template <class T, std::size_t N, class Function>
+  struct is_computed<ComputedArray<T, N, Function>> : std::true_type {};
+
+  template <class T>
+  struct is_narray : std::false_type {};
+
+  template <class T, std::size_t N>
+  struct is_narray<NArray<T, N>> : std::true_type {};
+
+  // Used to keep the scalar overloads from matching arrays
+  template <class T>
+  using enable_if_scalar = typename std::enable_if<!is_computed<T>::value && !is_narray<T>::value>::type;
+
+  // Calls 'f(pos)' for every position in row-major order, starting at
+  // dimension D
+  template <std::size_t D, std::size_t N>
+  struct positions {
+    template <class Functor>
+    static void call(const Point<N>& sizes, Point<N>& pos, Functor&& f) {
+      for (pos[D] = 0; pos[D] < sizes[D]; ++pos[D])
+        positions<D+1, N>::call(sizes, pos, f);
+    }
+  };
+
+  template <std::size_t N>
+  struct positions<N, N> {
+    template <class Functor>
+    static void call(const Point<N>&, Point<N>& pos, Functor&& f) {
+      f(pos);
+    }
+  };
+
+  // Calls 'f(elem, pos)' for every element of an array along with its
+  // position, the data pointer is walked alongside instead of recomputed
+  template <std::size_t D, std::size_t N>
+  struct indexedUnary {
+    template <class T, class Functor>
+    static void call(const Point<N>& sizes, T* data, const Point<N>& steps, Point<N>& pos, Functor& f) {
+      for (pos[D] = 0; pos[D] < sizes[D]; ++pos[D], data += steps[D])
+        indexedUnary<D+1, N>::call(sizes, data, steps, pos, f);
+    }
+  };
+
+  template <std::size_t N>
+  struct indexedUnary<N, N> {
+    template <class T, class Functor>
+    static void call(const Point<N>&, T* data, const Point<N>&, Point<N>& pos, Functor& f) {
+      f(*data, pos);
+    }
+  };
+
+  // Same as 'indexedUnary' but for two arrays, calls 'f(elem1, elem2, pos)'
+  template <std::size_t D, std::size_t N>
+  struct indexedBinary {
+    template <class T, class U, class Functor>
+    static void call(const Point<N>& sizes, T* data1, const Point<N>& steps1, U* data2, const Point<N>& steps2, Point<N>& pos, Functor& f) {
+      for (pos[D] = 0; pos[D] < sizes[D]; ++pos[D], data1 += steps1[D], data2 += steps2[D])
+        indexedBinary<D+1, N>::call(sizes, data1, steps1, data2, steps2, pos, f);
+    }
+  };
+
+  template <std::size_t N>
+  struct indexedBinary<N, N> {
+    template <class T, class U, class Functor>
+    static void call(const Point<N>&, T* data1, const Point<N>&, U* data2, const Point<N>&, Point<N>& pos, Functor& f) {
+      f(*data1, *data2, pos);
+    }
+  };
+
+  // Computes 'base + sum(coefficients[i] * pos[i])', used for ramps, grids,
+  // and constants
+  template <class T, std::size_t N>
+  struct AffineFunction {
+    T base;
+    std::array<T, N> coefficients;
+
+    T operator()(const Point<N>& pos) const {
+      T value = base;
+      for (std::size_t i = 0; i < N; ++i)
+        value += coefficients[i] * static_cast<T>(pos[i]);
+      return value;
+    }
+  };
+
+  // Gives the same value at every position
+  template <class T>
+  struct ScalarFunction {
+    T value;
+
+    template <std::size_t N>
+    const T& operator()(const Point<N>&) const {
+      return value;
+    }
+  };
+
+  // Converts the result of a function to the element type, the same way
+  // 'ComputedArray::atUnchecked()' does
+  template <class T, class F>
+  struct CastFunction {
+    F func;
+
+    template <std::size_t N>
+    T operator()(const Point<N>& pos) const {
+      return static_cast<T>(func(pos));
+    }
+  };
+
+  // Combines the results of two functions at the same position
+  template <class F, class G, class Op>
+  struct ComposedFunction {
+    F lhs;
+    G rhs;
+    Op op;
+
+    template <std::size_t N>
+    auto operator()(const Point<N>& pos) const -> decltype(op(lhs(pos), rhs(pos))) {
+      return op(lhs(pos), rhs(pos));
+    }
+  };
+
+  // The function of 'lhs OP rhs' where 'lhs' has elements of type T computed
+  // by F and 'rhs' has elements of type U computed by G
+  template <class T, class F, class U, class G, class Op>
+  using ComposedOf = ComposedFunction<CastFunction<T, F>, CastFunction<U, G>, Op>;
+
+  template <class T, std::size_t N>
+  ComputedArray<T, N, AffineFunction<T, N>> affine(const Point<N>& sizes, T base, const std::array<T, N>& coefficients)
+  {
+    return ComputedArray<T, N, AffineFunction<T, N>>(sizes, AffineFunction<T, N>{ base, coefficients });
+  }
+
+} // namespace detail
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is a read-only N-dimensional array with no storage, each
+  // element is computed from its position when it is read. Ramps, coordinate
+  // grids, and constants made this way can feed element-wise operations
+  // without ever being allocated or filled.
+  //
+  // auto x = wilt::meshgrid<float, 2>({ 480, 640 }, 1); // column index
+  // auto y = wilt::meshgrid<float, 2>({ 480, 640 }, 0); // row index
+  // NArray<float, 2> dist = image + (x * x + y * y);
+  //
+  // Arithmetic between computed arrays and scalars gives another computed
+  // array, so the whole expression above is only evaluated in the final pass
+  // over 'image'. Operations with an 'NArray' give an 'NArray', and they can
+  // be used with 'NArray::setTo()' and 'reduce()' or materialized with
+  // 'clone()'.
+  //
+  // The function is called with the position as a 'Point<N>' and should
+  // return something convertible to 'T'. It is copied into the array and
+  // must be safe to call concurrently if the array is used that way.
+
+  template <class T, std::size_t N, class Function>
+  class ComputedArray
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    using value_type = T;
+    using function_type = Function;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Creates an array of the given size whose elements are 'func(pos)',
+    // throws std::invalid_argument if the size is not valid
+    ComputedArray(const Point<N>& sizes, Function func)
+      : sizes_(sizes)
+      , func_(std::move(func))
+    {
+      if (!wilt::detail::validSize(sizes))
+        throw std::invalid_argument("ComputedArray(sizes, func): sizes is not valid");
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Functions for the dimensions, like those of 'NArray'
+    const Point<N>& sizes() const noexcept { return sizes_; }
+    std::size_t size() const noexcept { return (std::size_t)wilt::detail::size(sizes_); }
+
+    // Gets the function elements are computed with
+    const Function& function() const noexcept { return func_; }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESS FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Computes the element at the location, throws std::out_of_range if
+    // the location is outside the array
+    T at(const Point<N>& loc) const
+    {
+      for (std::size_t i = 0; i < N; ++i)
+        if (loc[i] < 0 || loc[i] >= sizes_[i])
+          throw std::out_of_range("at(loc): index out of bounds");
+
+      return atUnchecked(loc);
+    }
+
+    // Computes the element at the location without bounds checking
+    T atUnchecked(const Point<N>& loc) const
+    {
+      return static_cast<T>(func_(loc));
+    }
+
+    // Computes every element in order and calls the operator with it
+    template <class Operator>
+    void foreach(Operator op) const
+    {
+      Point<N> pos;
+      wilt::detail::positions<0, N>::call(sizes_, pos, [this, &op](const Point<N>& p) { op(atUnchecked(p)); });
+    }
+
+    // Computes all the elements into a new array
+    NArray<T, N> clone() const
+    {
+      WILT_TRACE_SCOPE("clone", sizes_, size() * sizeof(T));
+      NArray<T, N> ret(sizes_);
+      ret.setTo(*this);
+      return ret;
+    }
+
+  private:
+    Point<N> sizes_;
+    Function func_;
+
+  }; // class ComputedArray
+
+
+  //! @brief         creates an array whose elements are computed by a function
+  //! @param[in]     sizes - the dimensions of the array
+  //! @param[in]     func - function or function object with the signature
+  //!                T(const Point<N>&) or similar
+  //! @return        the computed array
+  //! @throws        std::invalid_argument if sizes is not valid
+  template <class T, std::size_t N, class Function>
+  ComputedArray<T, N, Function> computed(const Point<N>& sizes, Function func)
+  {
+    return ComputedArray<T, N, Function>(sizes, std::move(func));
+  }
+
+  //! @brief         creates an array of increasing values in row-major order
+  //! @param[in]     sizes - the dimensions of the array
+  //! @param[in]     start - the first value
+  //! @param[in]     step - the difference between consecutive values
+  //! @return        the computed array, element i in row-major order is
+  //!                'start + i * step'
+  //! @throws        std::invalid_argument if sizes is not valid
+  template <class T, std::size_t N>
+  ComputedArray<T, N, detail::AffineFunction<T, N>> iota(const Point<N>& sizes, T start = T(0), T step = T(1))
+  {
+    std::array<T, N> coefficients;
+    Point<N> steps = wilt::detail::validSize(sizes) ? wilt::detail::step(sizes) : Point<N>();
+    for (std::size_t i = 0; i < N; ++i)
+      coefficients[i] = static_cast<T>(steps[i]) * step;
+    return detail::affine(sizes, start, coefficients);
+  }
+
+  //! @brief         creates an array of evenly spaced values
+  //! @param[in]     first - the first value
+  //! @param[in]     last - the last value
+  //! @param[in]     count - the number of values, must be at least 2
+  //! @return        the computed array, the last element matches 'last' up
+  //!                to rounding
+  //! @throws        std::invalid_argument if count is less than 2
+  template <class T>
+  ComputedArray<T, 1, detail::AffineFunction<T, 1>> linspace(T first, T last, pos_t count)
+  {
+    static_assert(std::is_floating_point<T>::value, "linspace(first, last, count): invalid when T is not floating point");
+
+    if (count < 2)
+      throw std::invalid_argument("linspace(first, last, count): count must be at least 2");
+
+    return detail::affine(Point<1>(count), first, std::array<T, 1>{ { (last - first) / static_cast<T>(count - 1) } });
+  }
+
+  //! @brief         creates one axis of a coordinate grid, where elements vary
+  //!                only along one dimension
+  //! @param[in]     sizes - the dimensions of the grid
+  //! @param[in]     dim - the dimension the values vary along
+  //! @param[in]     start - the value at index 0 of that dimension
+  //! @param[in]     step - the difference between consecutive indexes
+  //! @return        the computed array, the element at 'pos' is
+  //!                'start + pos[dim] * step'
+  //! @throws        std::invalid_argument if sizes is not valid
+  //! @throws        std::out_of_range if dim is out of bounds
+  template <class T, std::size_t N>
+  ComputedArray<T, N, detail::AffineFunction<T, N>> meshgrid(const Point<N>& sizes, std::size_t dim, T start = T(0), T step = T(1))
+  {
+    if (dim >= N)
+      throw std::out_of_range("meshgrid(sizes, dim, start, step): dim out of bounds");
+
+    std::array<T, N> coefficients;
+    coefficients.fill(T(0));
+    coefficients[dim] = step;
+    return detail::affine(sizes, start, coefficients);
+  }
+
+  //! @brief         creates an array where every element is the same
+  //! @param[in]     sizes - the dimensions of the array
+  //! @param[in]     value - the value of every element
+  //! @return        the computed array
+  //! @throws        std::invalid_argument if sizes is not valid
+  template <class T, std::size_t N>
+  ComputedArray<T, N, detail::ScalarFunction<T>> constant(const Point<N>& sizes, const T& value)
+  {
+    return ComputedArray<T, N, detail::ScalarFunction<T>>(sizes, detail::ScalarFunction<T>{ value });
+  }
+
+  //! @brief         combines all elements of a computed array, in order, into
+  //!                a single value
+  //! @param[in]     src - source array
+  //! @param[in]     init - the initial value
+  //! @param[in]     op - function or function object with the signature
+  //!                U(U, T) or similar
+  //! @return        the combined value
+  template <class T, std::size_t N, class Function, class U, class Operator>
+  U reduce(const ComputedArray<T, N, Function>& src, U init, Operator op)
+  {
+    WILT_TRACE_SCOPE("reduce", src.sizes(), src.size() * sizeof(T));
+    src.foreach([&init, &op](const T& t) { init = op(std::move(init), t); });
+    return init;
+  }
+
+  template <class T, std::size_t N>
+  template <class U, class Function>
+  void NArray<T, N>::setTo(const ComputedArray<U, N, Function>& arr) const
+  {
+    static_assert(!std::is_const<T>::value, "setTo(arr): invalid when element type is const");
+
+    if (sizes_ != arr.sizes())
+      throw std::invalid_argument("setTo(arr): dimensions must match");
+
+    WILT_TRACE_SCOPE("setTo", sizes_, (std::size_t)size() * sizeof(T));
+    Point<N> pos;
+    auto op = [&arr](T& r, const Point<N>& p) { r = static_cast<T>(arr.atUnchecked(p)); };
+    wilt::detail::indexedUnary<0, N>::call(sizes_, data_.get(), steps_, pos, op);
+  }
+
+#define MAKE_COMPUTED_OP(OP, FUNCTOR) \
+  template <class T, class U, std::size_t N, class F>                                                                              \
+  NArray<decltype(std::declval<T>() OP std::declval<U>()), N> operator OP (const NArray<T, N>& lhs, const ComputedArray<U, N, F>& rhs) \
+  {                                                                                                                                \
+    using Ret = decltype(std::declval<T>() OP std::declval<U>());                                                                  \
+    if (lhs.sizes() != rhs.sizes())                                                                                                \
+      throw std::invalid_argument("operator" #OP "(): dimensions must match");                                                     \
+    if (lhs.empty())                                                                                                               \
+      return NArray<Ret, N>();                                                                                                     \
+                                                                                                                                   \
+    NArray<Ret, N> ret(lhs.sizes());                                                                                               \
+    Point<N> pos;                                                                                                                  \
+    auto op = [&rhs](Ret& r, const T& t, const Point<N>& p) { r = t OP rhs.atUnchecked(p); };                                      \
+    wilt::detail::indexedBinary<0, N>::call(ret.sizes(), ret.data(), ret.steps(), lhs.data(), lhs.steps(), pos, op);               \
+    return ret;                                                                                                                    \
+  }                                                                                                                                \
+                                                                                                                                   \
+  template <class T, class U, std::size_t N, class F>                                                                              \
+  NArray<decltype(std::declval<T>() OP std::declval<U>()), N> operator OP (const ComputedArray<T, N, F>& lhs, const NArray<U, N>& rhs) \
+  {                                                                                                                                \
+    using Ret = decltype(std::declval<T>() OP std::declval<U>());                                                                  \
+    if (lhs.sizes() != rhs.sizes())                                                                                                \
+      throw std::invalid_argument("operator" #OP "(): dimensions must match");                                                     \
+    if (rhs.empty())                                                                                                               \
+      return NArray<Ret, N>();                                                                                                     \
+                                                                                                                                   \
+    NArray<Ret, N> ret(rhs.sizes());                                                                                               \
+    Point<N> pos;                                                                                                                  \
+    auto op = [&lhs](Ret& r, const U& u, const Point<N>& p) { r = lhs.atUnchecked(p) OP u; };                                      \
+    wilt::detail::indexedBinary<0, N>::call(ret.sizes(), ret.data(), ret.steps(), rhs.data(), rhs.steps(), pos, op);               \
+    return ret;                                                                                                                    \
+  }                                                                                                                                \
+                                                                                                                                   \
+  template <class T, class U, std::size_t N, class F, class G>                                                                     \
+  ComputedArray<decltype(std::declval<T>() OP std::declval<U>()), N, detail::ComposedOf<T, F, U, G, FUNCTOR>>                      \
+  operator OP (const ComputedArray<T, N, F>& lhs, const ComputedArray<U, N, G>& rhs)                                               \
+  {                                                                                                                                \
+    using Ret = decltype(std::declval<T>() OP std::declval<U>());                                                                  \
+    using Composed = detail::ComposedOf<T, F, U, G, FUNCTOR>;                                                                      \
+    if (lhs.sizes() != rhs.sizes())                                                                                                \
+      throw std::invalid_argument("operator" #OP "(): dimensions must match");                                                     \
+                                                                                                                                   \
+    return ComputedArray<Ret, N, Composed>(lhs.sizes(), Composed{ { lhs.function() }, { rhs.function() }, FUNCTOR() });            \
+  }                                                                                                                                \
+                                                                                                                                   \
+  template <class T, class U, std::size_t N, class F, class = detail::enable_if_scalar<U>>                                         \
+  ComputedArray<decltype(std::declval<T>() OP std::declval<U>()), N, detail::ComposedOf<T, F, U, detail::ScalarFunction<U>, FUNCTOR>> \
+  operator OP (const ComputedArray<T, N, F>& lhs, const U& rhs)                                                                    \
+  {                                                                                                                                \
+    using Ret = decltype(std::declval<T>() OP std::declval<U>());                                                                  \
+    using Composed = detail::ComposedOf<T, F, U, detail::ScalarFunction<U>, FUNCTOR>;                                              \
+    return ComputedArray<Ret, N, Composed>(lhs.sizes(), Composed{ { lhs.function() }, { { rhs } }, FUNCTOR() });                   \
+  }                                                                                                                                \
+                                                                                                                                   \
+  template <class T, class U, std::size_t N, class G, class = detail::enable_if_scalar<T>>                                         \
+  ComputedArray<decltype(std::declval<T>() OP std::declval<U>()), N, detail::ComposedOf<T, detail::ScalarFunction<T>, U, G, FUNCTOR>> \
+  operator OP (const T& lhs, const ComputedArray<U, N, G>& rhs)                                                                    \
+  {                                                                                                                                \
+    using Ret = decltype(std::declval<T>() OP std::declval<U>());                                                                  \
+    using Composed = detail::ComposedOf<T, detail::ScalarFunction<T>, U, G, FUNCTOR>;                                              \
+    return ComputedArray<Ret, N, Composed>(rhs.sizes(), Composed{ { { lhs } }, { rhs.function() }, FUNCTOR() });                   \
+  }                                                                                                                                \
+
+  MAKE_COMPUTED_OP(+, std::plus<>)
+  MAKE_COMPUTED_OP(-, std::minus<>)
+  MAKE_COMPUTED_OP(*, std::multiplies<>)
+  MAKE_COMPUTED_OP(/, std::divides<>)
+  MAKE_COMPUTED_OP(%, std::modulus<>)
+
+  MAKE_COMPUTED_OP(&, std::bit_and<>)
+  MAKE_COMPUTED_OP(|, std::bit_or<>)
+  MAKE_COMPUTED_OP(^, std::bit_xor<>)
+
+#undef MAKE_COMPUTED_OP
+
+} // namespace wilt
+
+#endif // !WILT_COMPUTED_HPP
@@ -0,0 +1,328 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: csv.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines parallel readers and writers for numeric delimited text (POSIX)
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_CSV_HPP
+#define WILT_CSV_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if __cplusplus >= 201703L && __has_include(<charconv>)
+#include <charconv>
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define WILT_HAS_CHARCONV
+#endif
+#endif
+
+#include <fcntl.h>
+#include <sys/uio.h>
+
+#include "narray.hpp"
+#include "mapping.hpp"
+#include "threadpool.hpp"
+
+namespace wilt
+{
+namespace detail
+{
+#ifdef WILT_HAS_CHARCONV
+  // Parses all of [first, last) as a number
+  template <class T>
+  bool parseNumber(const char* first, const char* last, T& value) noexcept
+  {
+    auto result = std::from_chars(first, last, value);
+    return result.ec == std::errc() && result.ptr == last;
+  }
+
+  // Formats a number into [first, last), which must be large enough, and
+  // returns the end of the text
+  template <class T>
+  char* formatNumber(char* first, char* last, T value) noexcept
+  {
+    return std::to_chars(first, last, value).ptr;
+  }
+#else
+  // The `strto*()` functions need terminated strings and would read past the
+  // end of a mapped file, so fields are copied out first
+  template <class T>
+  bool parseNumber(const char* buffer, char*& end, T& value, std::true_type /* floating */, std::true_type /* signed */) noexcept
+  {
+    value = (T)std::strtold(buffer, &end);
+    return true;
+  }
+
+  template <class T>
+  bool parseNumber(const char* buffer, char*& end, T& value, std::false_type /* floating */, std::true_type /* signed */) noexcept
+  {
+    long long parsed = std::strtoll(buffer, &end, 10);
+    value = (T)parsed;
+    return parsed >= (long long)std::numeric_limits<T>::min() && parsed <= (long long)std::numeric_limits<T>::max();
+  }
+
+  template <class T>
+  bool parseNumber(const char* buffer, char*& end, T& value, std::false_type /* floating */, std::false_type /* signed */) noexcept
+  {
+    unsigned long long parsed = std::strtoull(buffer, &end, 10);
+    value = (T)parsed;
+    return buffer[0] != '-' && parsed <= (unsigned long long)std::numeric_limits<T>::max();
+  }
+
+  template <class T>
+  bool parseNumber(const char* first, const char* last, T& value) noexcept
+  {
+    char buffer[128];
+    std::size_t length = (std::size_t)(last - first);
+    if (length == 0 || length >= sizeof(buffer))
+      return false;
+    std::memcpy(buffer, first, length);
+    buffer[length] = '\0';
+
+    char* end = nullptr;
+    errno = 0;
+    bool inRange = parseNumber(buffer, end, value, std::is_floating_point<T>(), std::is_signed<T>());
+    return inRange && errno == 0 && end == buffer + length;
+  }
+
+  template <class T>
+  char* formatNumber(char* first, char* last, T value) noexcept
+  {
+    int length;
+    if (std::is_floating_point<T>::value)
+      length = std::snprintf(first, (std::size_t)(last - first), "%.*Lg", std::numeric_limits<T>::max_digits10, (long double)value);
+    else if (std::is_signed<T>::value)
+      length = std::snprintf(first, (std::size_t)(last - first), "%lld", (long long)value);
+    else
+      length = std::snprintf(first, (std::size_t)(last - first), "%llu", (unsigned long long)value);
+    return first + length;
+  }
+#endif
+
+  // Finds the start of the first line at or after 'pos'
+  inline std::size_t lineStart(const char* data, std::size_t size, std::size_t pos) noexcept
+  {
+    if (pos == 0)
+      return 0;
+    const void* newline = std::memchr(data + pos - 1, '\n', size - pos + 1);
+    return newline ? (std::size_t)(static_cast<const char*>(newline) - data) + 1 : size;
+  }
+
+  // Gets the line starting at 'pos' without its line ending, and moves 'pos'
+  // to the start of the next line
+  inline void nextLine(const char* data, std::size_t size, std::size_t& pos, const char*& first, const char*& last) noexcept
+  {
+    first = data + pos;
+    const void* newline = std::memchr(first, '\n', size - pos);
+    last = newline ? static_cast<const char*>(newline) : data + size;
+    pos = (std::size_t)(last - data) + (newline ? 1 : 0);
+    if (last != first && last[-1] == '\r')
+      --last;
+  }
+
+} // namespace detail
+
+  //! @brief         reads a 2D array from delimited text, like CSV
+  //! @param[in]     path - the file to read
+  //! @param[in]     delimiter - the character between values on a line
+  //! @param[in]     skipHeader - whether to skip the first line
+  //! @param[in]     pool - the pool to parse on
+  //! @return        the newly read array with one row per non-empty line
+  //!
+  //! Throws std::runtime_error if the file can't be read, a value can't be
+  //! parsed, or the lines don't all have the same number of values
+  //!
+  //! The file is mapped and split into chunks at line boundaries. The lines in
+  //! each chunk are counted in parallel to find where its rows go, then each
+  //! chunk is parsed in parallel straight into the result. Spaces and tabs
+  //! around values are ignored, quoting is not supported.
+  template <class T>
+  NArray<T, 2> readCsv(const std::string& path, char delimiter = ',', bool skipHeader = false, ThreadPool& pool = defaultThreadPool())
+  {
+    static_assert(std::is_arithmetic<T>::value && !std::is_same<T, bool>::value, "readCsv(): invalid when element type is not a number");
+
+    auto mapping = detail::mapFile(path);
+    WILT_TRACE_SCOPE("readCsv", mapping->size());
+    const char* data = mapping->data();
+    std::size_t size = mapping->size();
+
+    std::size_t begin = skipHeader ? detail::lineStart(data, size, 1) : 0;
+
+    // the first non-empty line decides the number of columns
+    pos_t columns = 0;
+    for (std::size_t pos = begin; pos < size && columns == 0; )
+    {
+      const char* first;
+      const char* last;
+      detail::nextLine(data, size, pos, first, last);
+      if (first != last)
+        columns = (pos_t)std::count(first, last, delimiter) + 1;
+    }
+    if (columns == 0)
+      return NArray<T, 2>();
+
+    // split at line boundaries
+    std::size_t chunkCount = parallelJobs(size - begin);
+    std::vector<std::size_t> bounds(chunkCount + 1);
+    for (std::size_t i = 0; i < chunkCount; ++i)
+      bounds[i] = detail::lineStart(data, size, begin + (size - begin) / chunkCount * i);
+    bounds[chunkCount] = size;
+
+    std::vector<std::size_t> rows(chunkCount + 1, 0);
+    parallelFor(chunkCount, [&](std::size_t i) {
+      std::size_t count = 0;
+      for (std::size_t pos = bounds[i]; pos < bounds[i+1]; )
+      {
+        const char* first;
+        const char* last;
+        detail::nextLine(data, size, pos, first, last);
+        if (first != last)
+          ++count;
+      }
+      rows[i+1] = count;
+    }, pool);
+
+    for (std::size_t i = 0; i < chunkCount; ++i)
+      rows[i+1] += rows[i];
+
+    NArray<T, 2> ret({ (pos_t)rows[chunkCount], columns });
+    T* out = ret.data();
+
+    parallelFor(chunkCount, [&](std::size_t i) {
+      std::size_t row = rows[i];
+      for (std::size_t pos = bounds[i]; pos < bounds[i+1]; )
+      {
+        const char* first;
+        const char* last;
+        detail::nextLine(data, size, pos, first, last);
+        if (first == last)
+          continue;
+
+        T* dst = out + row * (std::size_t)columns;
+        pos_t column = 0;
+        for (const char* field = first; ; ++column)
+        {
+          const char* end = std::find(field, last, delimiter);
+          if (column == columns)
+            throw std::runtime_error("readCsv(): row " + std::to_string(row) + " has too many values");
+
+          const char* a = field;
+          const char* b = end;
+          while (a != b && (*a == ' ' || *a == '\t'))
+            ++a;
+          while (a != b && (b[-1] == ' ' || b[-1] == '\t'))
+            --b;
+          if (!detail::parseNumber(a, b, dst[column]))
+            throw std::runtime_error("readCsv(): could not parse '" + std::string(a, b) + "' in row " + std::to_string(row));
+
+          if (end == last)
+            break;
+          field = end + 1;
+        }
+        if (column + 1 != columns)
+          throw std::runtime_error("readCsv(): row " + std::to_string(row) + " has too few values");
+
+        ++row;
+      }
+    }, pool);
+
+    return ret;
+  }
+
+  //! @brief         writes a 2D array as delimited text, like CSV
+  //! @param[in]     path - the file to write, it is replaced if it exists
+  //! @param[in]     arr - the array to write, one line per row
+  //! @param[in]     delimiter - the character between values on a line
+  //! @param[in]     pool - the pool to format on
+  //!
+  //! Throws std::runtime_error if the file can't be written
+  //!
+  //! Rows are formatted in parallel chunks, a batch of chunks at a time, and
+  //! each batch is written with one `writev()`. Floating point values are
+  //! written with enough digits to read back exactly.
+  template <class T>
+  void writeCsv(const std::string& path, const NArray<T, 2>& arr, char delimiter = ',', ThreadPool& pool = defaultThreadPool())
+  {
+    using U = typename std::remove_const<T>::type;
+    static_assert(std::is_arithmetic<U>::value && !std::is_same<U, bool>::value, "writeCsv(): invalid when element type is not a number");
+
+    WILT_TRACE_SCOPE("writeCsv", arr.sizes(), (std::size_t)arr.size() * sizeof(T));
+    detail::FileDescriptor file(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+    if (file.get() < 0)
+      throw std::runtime_error(detail::errnoMessage("writeCsv(): could not open '" + path + "'"));
+    if (arr.empty())
+      return;
+
+    const std::size_t maxLength = 64;
+    const pos_t height = arr.sizes()[0];
+    const pos_t width = arr.sizes()[1];
+    const pos_t chunkRows = std::max<pos_t>((pos_t)tuningParameters().grainBytes / (width * 16), 1);
+    const pos_t batchRows = chunkRows * (pos_t)std::max<std::size_t>(pool.size() * 2, 1);
+
+    std::vector<std::string> texts;
+    std::vector<iovec> iov;
+    for (pos_t batch = 0; batch < height; batch += batchRows)
+    {
+      std::size_t chunkCount = (std::size_t)((std::min(batchRows, height - batch) + chunkRows - 1) / chunkRows);
+      texts.resize(chunkCount);
+
+      parallelFor(chunkCount, [&](std::size_t i) {
+        pos_t first = batch + (pos_t)i * chunkRows;
+        pos_t last = std::min(first + chunkRows, height);
+
+        std::string& text = texts[i];
+        text.resize((std::size_t)((last - first) * width) * maxLength);
+        char* out = &text[0];
+        for (pos_t y = first; y < last; ++y)
+        {
+          const T* row = arr.data() + y * arr.steps()[0];
+          for (pos_t x = 0; x < width; ++x)
+          {
+            out = detail::formatNumber(out, out + maxLength - 1, (U)row[x * arr.steps()[1]]);
+            *out++ = x + 1 == width ? '\n' : delimiter;
+          }
+        }
+        text.resize((std::size_t)(out - text.data()));
+      }, pool);
+
+      iov.clear();
+      for (auto& text : texts)
+        iov.push_back(iovec{ &text[0], text.size() });
+      detail::writevAll(file.get(), iov.data(), (int)iov.size());
+    }
+  }
+
+} // namespace wilt
+
+#endif // !WILT_CSV_HPP
@@ -0,0 +1,300 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: diagnostics.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines the reporting of operations that fall back to slow paths
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_DIAGNOSTICS_HPP
+#define WILT_DIAGNOSTICS_HPP
+
+#ifdef WILT_NARRAY_DIAGNOSTICS
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Records a slow path if 'cond' is true, see 'SlowPath'
+#define WILT_DIAGNOSE(cond, kind, count) \
+  do { if (cond) wilt::detail::recordSlowPath(wilt::SlowPath::kind, (count)); } while (0)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define WILT_NOINLINE __attribute__((noinline))
+#define WILT_CALLER_ADDRESS() __builtin_return_address(0)
+#else
+#define WILT_NOINLINE
+#define WILT_CALLER_ADDRESS() nullptr
+#endif
+
+// Public functions that can record slow paths are marked with
+// 'WILT_DIAGNOSTIC_NOINLINE' and start with 'WILT_DIAGNOSTIC_ENTRY()'. Not
+// being inlined puts their return address in the code that called them, and
+// the entry keeps the outermost one so slow paths found in nested library
+// calls are still attributed to the user's call site.
+#define WILT_DIAGNOSTIC_NOINLINE WILT_NOINLINE
+#define WILT_DIAGNOSTIC_ENTRY() \
+  wilt::detail::DiagnosticEntry wilt_diagnostic_entry_(WILT_CALLER_ADDRESS())
+
+namespace wilt
+{
+  // - defined in "narray.hpp"
+  template <class T, std::size_t N> class NArray;
+
+  // The kinds of operations that work but take a slower path than needed
+  enum class SlowPath
+  {
+    ITERATE_UNALIGNED,    // begin() on a view not laid out in element order
+    BRACKET_TEMPORARY,    // operator[] creating an intermediate array
+    CLONE_UNALIGNED,      // clone() of a view not laid out in element order
+    STRIDED_INNER,        // element-wise operation with a gap between elements
+    COMPRESS_TEMPORARIES  // compress() creating an array per element
+  };
+
+  // A count of one kind of slow path from one call site
+  struct SlowPathRecord
+  {
+    SlowPath kind;
+    std::string scope;    // the innermost 'DiagnosticScope', if any
+    const void* address;  // code address in the user's caller, for addr2line
+    std::size_t count;
+  };
+
+  //! @brief         gets a short name for the kind of slow path
+  inline const char* slowPathName(SlowPath kind) noexcept
+  {
+    switch (kind)
+    {
+    case SlowPath::ITERATE_UNALIGNED:    return "iterating an unaligned view";
+    case SlowPath::BRACKET_TEMPORARY:    return "operator[] temporaries";
+    case SlowPath::CLONE_UNALIGNED:      return "clone() of an unaligned view";
+    case SlowPath::STRIDED_INNER:        return "strided innermost dimension";
+    case SlowPath::COMPRESS_TEMPORARIES: return "compress() temporaries";
+    }
+    return "unknown";
+  }
+
+  //! @brief         gets a suggestion for avoiding the kind of slow path
+  inline const char* slowPathSuggestion(SlowPath kind) noexcept
+  {
+    switch (kind)
+    {
+    case SlowPath::ITERATE_UNALIGNED:
+      return "memory is visited out of order, use asAligned() if the order doesn't matter or foreach() otherwise";
+    case SlowPath::BRACKET_TEMPORARY:
+      return "each [] but the last creates an array, use at(x, y, ...) or atUnchecked()";
+    case SlowPath::CLONE_UNALIGNED:
+      return "the copy reads memory out of order, clone once and keep it or use asAligned() first if the order doesn't matter";
+    case SlowPath::STRIDED_INNER:
+      return "view is non-contiguous in innermost dim, copy it once with clone() or reorder with transpose() so the last dimension has step 1";
+    case SlowPath::COMPRESS_TEMPORARIES:
+      return "an array is created for each result element, for small subarrays loop with at() instead";
+    }
+    return "";
+  }
+
+namespace detail
+{
+  class SlowPathRegistry
+  {
+  public:
+    void record(SlowPath kind, const char* scope, const void* address, std::size_t count)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      counts_[std::make_tuple(kind, scope, address)] += count;
+    }
+
+    std::vector<SlowPathRecord> records() const
+    {
+      std::vector<SlowPathRecord> ret;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : counts_)
+          ret.push_back({ std::get<0>(entry.first), std::get<1>(entry.first) ? std::get<1>(entry.first) : "", std::get<2>(entry.first), entry.second });
+      }
+
+      std::stable_sort(ret.begin(), ret.end(), [](const SlowPathRecord& lhs, const SlowPathRecord& rhs) {
+        return lhs.count > rhs.count;
+      });
+      return ret;
+    }
+
+    void reset()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      counts_.clear();
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    std::map<std::tuple<SlowPath, const char*, const void*>, std::size_t> counts_;
+
+  }; // class SlowPathRegistry
+
+  inline SlowPathRegistry& slowPathRegistry()
+  {
+    static SlowPathRegistry* registry = new SlowPathRegistry();
+    return *registry;
+  }
+
+  // returns true if the elements along the last dimension aren't adjacent
+  template <class T, std::size_t N>
+  bool stridedInner(const NArray<T, N>& arr) noexcept
+  {
+    return !arr.empty() && arr.sizes()[N-1] > 1 && arr.steps()[N-1] != 1;
+  }
+
+  inline const char*& currentDiagnosticScope()
+  {
+    static thread_local const char* scope = nullptr;
+    return scope;
+  }
+
+  inline const void*& currentDiagnosticCaller()
+  {
+    static thread_local const void* caller = nullptr;
+    return caller;
+  }
+
+  // Sets the call site slow paths are recorded against, unless an outer
+  // library function already has
+  class DiagnosticEntry
+  {
+  public:
+    explicit DiagnosticEntry(const void* caller) noexcept
+      : owner_(currentDiagnosticCaller() == nullptr)
+    {
+      if (owner_)
+        currentDiagnosticCaller() = caller;
+    }
+
+    ~DiagnosticEntry()
+    {
+      if (owner_)
+        currentDiagnosticCaller() = nullptr;
+    }
+
+    DiagnosticEntry(const DiagnosticEntry&) = delete;
+    DiagnosticEntry& operator= (const DiagnosticEntry&) = delete;
+
+  private:
+    bool owner_;
+
+  }; // class DiagnosticEntry
+
+  inline void recordSlowPath(SlowPath kind, std::size_t count)
+  {
+    slowPathRegistry().record(kind, currentDiagnosticScope(), currentDiagnosticCaller(), count);
+  }
+
+} // namespace detail
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class labels the slow paths recorded on this thread while it is in
+  // scope, so they can be attributed to a part of the program. Scopes nest,
+  // the previous one is restored when this goes out of scope. The string must
+  // outlive the report, like a literal.
+
+  class DiagnosticScope
+  {
+  public:
+    explicit DiagnosticScope(const char* scope) noexcept
+      : previous_(wilt::detail::currentDiagnosticScope())
+    {
+      wilt::detail::currentDiagnosticScope() = scope;
+    }
+
+    ~DiagnosticScope()
+    {
+      wilt::detail::currentDiagnosticScope() = previous_;
+    }
+
+    DiagnosticScope(const DiagnosticScope&) = delete;
+    DiagnosticScope& operator= (const DiagnosticScope&) = delete;
+
+  private:
+    const char* previous_;
+
+  }; // class DiagnosticScope
+
+  //! @brief         gets the slow paths recorded so far
+  //! @return        a record per kind and call site, most frequent first
+  inline std::vector<SlowPathRecord> slowPathReport()
+  {
+    return wilt::detail::slowPathRegistry().records();
+  }
+
+  //! @brief         forgets the slow paths recorded so far
+  inline void resetDiagnostics()
+  {
+    wilt::detail::slowPathRegistry().reset();
+  }
+
+  //! @brief         writes a summary of the recorded slow paths with a
+  //!                suggestion for each kind
+  //! @param[in]     out - the stream to write to
+  //! @param[in]     limit - the most call sites to list
+  inline void printDiagnostics(std::ostream& out, std::size_t limit = 20)
+  {
+    auto records = slowPathReport();
+    if (records.empty())
+    {
+      out << "no slow paths recorded\n";
+      return;
+    }
+
+    std::map<SlowPath, std::size_t> totals;
+    for (auto& record : records)
+      totals[record.kind] += record.count;
+
+    out << "slow paths:\n";
+    for (auto& total : totals)
+      out << "  " << slowPathName(total.first) << ": " << total.second << "\n"
+          << "    " << slowPathSuggestion(total.first) << "\n";
+
+    out << "call sites:\n";
+    for (std::size_t i = 0; i < records.size() && i < limit; ++i)
+    {
+      auto& record = records[i];
+      out << "  " << record.count << "x " << slowPathName(record.kind) << " at " << record.address;
+      if (!record.scope.empty())
+        out << " in " << record.scope;
+      out << "\n";
+    }
+  }
+
+} // namespace wilt
+
+#else
+
+#define WILT_DIAGNOSE(cond, kind, count) ((void)0)
+#define WILT_DIAGNOSTIC_NOINLINE
+#define WILT_DIAGNOSTIC_ENTRY() ((void)0)
+
+#endif // WILT_NARRAY_DIAGNOSTICS
+
+#endif // !WILT_DIAGNOSTICS_HPP
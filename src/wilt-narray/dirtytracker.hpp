@@ -0,0 +1,435 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: dirtytracker.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines a wrapper that tracks which tiles of an array were written
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_DIRTYTRACKER_HPP
+#define WILT_DIRTYTRACKER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "narray.hpp"
+
+namespace wilt
+{
+  //////////////////////////////////////////////////////////////////////////////
+  // This class wraps an array and keeps a dirty flag for each tile of it, so
+  // that arrays derived from it can be updated by only reprocessing the tiles
+  // that were written to instead of the whole array.
+  //
+  // Writes have to go through the tracker ('at()', 'setTo()', or a view from
+  // 'writeView()') to be seen; writes made through other arrays sharing the
+  // same data aren't tracked but can be reported with 'markDirty()'.
+  //
+  // DirtyTracker<float, 2> image(NArray<float, 2>({ 4096, 4096 }), { 64, 64 });
+  // image.writeView({ 100, 200 }, { 16, 16 }).setTo(1.0f);
+  // for (auto& region : image.takeDirtyRegions())
+  //   blur(image.array().subarray(region.loc, region.sizes), ...);
+  //
+  // Tiles are marked with release ordering and taken with acquire ordering,
+  // so a thread that takes a region sees every write made before the region
+  // was marked. 'setTo()' and 'scopedWrite()' mark after writing. 'at()' and
+  // 'writeView()' mark when they hand out the element or view, so writes
+  // through them must finish before the next 'takeDirtyRegions()' or they
+  // may be missed; use 'scopedWrite()' when writes and takes run on
+  // different threads.
+  //
+  // NOTE: marking and clearing flags is safe to do from multiple threads, the
+  // element writes themselves are as safe as they are for 'NArray'
+
+  template <class T, std::size_t N>
+  class DirtyTracker
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Holds a view for writing and marks its tiles dirty when destroyed, made
+    // by 'scopedWrite()'
+    class WriteGuard
+    {
+    public:
+      WriteGuard(WriteGuard&& other) noexcept
+        : tracker_(other.tracker_)
+        , view_(std::move(other.view_))
+        , loc_(other.loc_)
+        , size_(other.size_)
+      {
+        other.tracker_ = nullptr;
+      }
+
+      WriteGuard(const WriteGuard&) = delete;
+      WriteGuard& operator= (const WriteGuard&) = delete;
+      WriteGuard& operator= (WriteGuard&&) = delete;
+
+      ~WriteGuard()
+      {
+        if (tracker_)
+          tracker_->forEachTile_(loc_, size_, [this](pos_t index) {
+            tracker_->flags_[index].store(true, std::memory_order_release);
+          });
+      }
+
+      // The view to write through
+      const NArray<T, N>& array() const noexcept
+      {
+        return view_;
+      }
+
+    private:
+      friend class DirtyTracker;
+
+      WriteGuard(const DirtyTracker* tracker, NArray<T, N> view, const Point<N>& loc, const Point<N>& size)
+        : tracker_(tracker)
+        , view_(std::move(view))
+        , loc_(loc)
+        , size_(size)
+      {
+
+      }
+
+      const DirtyTracker* tracker_;
+      NArray<T, N> view_;
+      Point<N> loc_;
+      Point<N> size_;
+
+    }; // class WriteGuard
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    DirtyTracker(const NArray<T, N>& arr, const Point<N>& tile)
+      : array_(arr)
+      , tile_(tile)
+      , grid_()
+      , count_(0)
+    {
+      if (arr.empty())
+        throw std::invalid_argument("DirtyTracker(arr, tile): arr is empty");
+      if (!wilt::detail::validSize(tile))
+        throw std::invalid_argument("DirtyTracker(arr, tile): tile is not valid");
+
+      for (std::size_t i = 0; i < N; ++i)
+        grid_[i] = (arr.sizes()[i] + tile[i] - 1) / tile[i];
+      count_ = wilt::detail::size(grid_);
+      flags_.reset(new std::atomic<bool>[(std::size_t)count_]);
+      for (pos_t i = 0; i < count_; ++i)
+        flags_[i].store(false, std::memory_order_relaxed);
+    }
+
+    DirtyTracker(DirtyTracker&&) = default;
+    DirtyTracker& operator= (DirtyTracker&&) = default;
+
+    DirtyTracker(const DirtyTracker&) = delete;
+    DirtyTracker& operator= (const DirtyTracker&) = delete;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Gets a read-only view of the whole array, reading doesn't mark anything
+    NArray<const T, N> array() const noexcept
+    {
+      return array_;
+    }
+
+    const Point<N>& sizes() const noexcept
+    {
+      return array_.sizes();
+    }
+
+    // The sizes of a tile, those at the far edges may be smaller
+    const Point<N>& tileSizes() const noexcept
+    {
+      return tile_;
+    }
+
+    // The number of tiles in each dimension
+    const Point<N>& grid() const noexcept
+    {
+      return grid_;
+    }
+
+    // Returns true if any tile is dirty
+    bool isDirty() const noexcept
+    {
+      for (pos_t i = 0; i < count_; ++i)
+        if (flags_[i].load(std::memory_order_acquire))
+          return true;
+      return false;
+    }
+
+    // Returns true if any tile overlapping the region is dirty
+    bool isDirty(const Point<N>& loc, const Point<N>& size) const
+    {
+      checkRegion_(loc, size, "isDirty(loc, size): region out of bounds");
+
+      bool dirty = false;
+      forEachTile_(loc, size, [&](pos_t index) {
+        dirty = dirty || flags_[index].load(std::memory_order_acquire);
+      });
+      return dirty;
+    }
+
+    // The number of dirty tiles
+    pos_t dirtyCount() const noexcept
+    {
+      pos_t count = 0;
+      for (pos_t i = 0; i < count_; ++i)
+        count += flags_[i].load(std::memory_order_acquire) ? 1 : 0;
+      return count;
+    }
+
+    // Gets the dirty tiles in row-major order, clipped to the array bounds.
+    // Dirty tiles next to each other along the last dimension are merged into
+    // a single region.
+    std::vector<Region<N>> dirtyRegions() const
+    {
+      return collect_(false);
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // WRITE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Gets the element at that location and marks its tile dirty, the write
+    // must finish before the next take
+    T& at(const Point<N>& loc) const
+    {
+      T& element = array_.at(loc);
+      flags_[tileIndex_(loc)].store(true, std::memory_order_release);
+      return element;
+    }
+
+    // Gets a view of the region for writing and marks the tiles it overlaps
+    // dirty, the writes must finish before the next take
+    NArray<T, N> writeView(const Point<N>& loc, const Point<N>& size) const
+    {
+      auto view = array_.subarray(loc, size);
+      forEachTile_(loc, size, [&](pos_t index) {
+        flags_[index].store(true, std::memory_order_release);
+      });
+      return view;
+    }
+
+    // Gets a view of the whole array for writing and marks all tiles dirty
+    NArray<T, N> writeView() const
+    {
+      markAll();
+      return array_;
+    }
+
+    // Gets a guard with a view of the region for writing, the tiles it
+    // overlaps are marked dirty when the guard is destroyed
+    //
+    // NOTE: the guard must not outlive the tracker or be alive while it is
+    // moved
+    WriteGuard scopedWrite(const Point<N>& loc, const Point<N>& size) const
+    {
+      return WriteGuard(this, array_.subarray(loc, size), loc, size);
+    }
+
+    WriteGuard scopedWrite() const
+    {
+      return WriteGuard(this, array_, Point<N>(), array_.sizes());
+    }
+
+    // Sets the whole array and marks all tiles dirty
+    void setTo(const T& val) const
+    {
+      array_.setTo(val);
+      markAll();
+    }
+
+    void setTo(const NArray<const T, N>& arr) const
+    {
+      array_.setTo(arr);
+      markAll();
+    }
+
+    // Marks the tiles overlapping the region dirty, for writes that happened
+    // outside of the tracker
+    void markDirty(const Point<N>& loc, const Point<N>& size) const
+    {
+      checkRegion_(loc, size, "markDirty(loc, size): region out of bounds");
+
+      forEachTile_(loc, size, [&](pos_t index) {
+        flags_[index].store(true, std::memory_order_release);
+      });
+    }
+
+    void markAll() const noexcept
+    {
+      for (pos_t i = 0; i < count_; ++i)
+        flags_[i].store(true, std::memory_order_release);
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CLEAR FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    void clear() const noexcept
+    {
+      for (pos_t i = 0; i < count_; ++i)
+        flags_[i].store(false, std::memory_order_relaxed);
+    }
+
+    // Clears the tiles overlapping the region
+    void clear(const Point<N>& loc, const Point<N>& size) const
+    {
+      checkRegion_(loc, size, "clear(loc, size): region out of bounds");
+
+      forEachTile_(loc, size, [&](pos_t index) {
+        flags_[index].store(false, std::memory_order_relaxed);
+      });
+    }
+
+    // Gets the dirty regions like 'dirtyRegions()' and clears them at the same
+    // time, a tile marked while this runs is either returned or left dirty
+    std::vector<Region<N>> takeDirtyRegions() const
+    {
+      return collect_(true);
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    void checkRegion_(const Point<N>& loc, const Point<N>& size, const char* msg) const
+    {
+      for (std::size_t i = 0; i < N; ++i)
+        if (size[i] + loc[i] > array_.sizes()[i] || size[i] <= 0 || loc[i] < 0)
+          throw std::out_of_range(msg);
+    }
+
+    pos_t tileIndex_(const Point<N>& loc) const noexcept
+    {
+      pos_t index = 0;
+      for (std::size_t i = 0; i < N; ++i)
+        index = index * grid_[i] + loc[i] / tile_[i];
+      return index;
+    }
+
+    // calls func with the index of every tile that overlaps the region
+    template <class Function>
+    void forEachTile_(const Point<N>& loc, const Point<N>& size, Function func) const
+    {
+      Point<N> first;
+      Point<N> last;
+      for (std::size_t i = 0; i < N; ++i)
+      {
+        first[i] = loc[i] / tile_[i];
+        last[i] = (loc[i] + size[i] - 1) / tile_[i];
+      }
+
+      Point<N> pos = first;
+      for (;;)
+      {
+        pos_t index = 0;
+        for (std::size_t i = 0; i < N; ++i)
+          index = index * grid_[i] + pos[i];
+        func(index);
+
+        std::size_t i = N;
+        for (; i > 0; --i)
+        {
+          if (++pos[i-1] <= last[i-1])
+            break;
+          pos[i-1] = first[i-1];
+        }
+        if (i == 0)
+          return;
+      }
+    }
+
+    std::vector<Region<N>> collect_(bool clear) const
+    {
+      std::vector<Region<N>> ret;
+      pos_t runs = grid_[N-1];
+      for (pos_t row = 0; row < count_; row += runs)
+      {
+        Point<N> tilePos;
+        pos_t rest = row / runs;
+        for (std::size_t i = N-1; i > 0; --i)
+        {
+          tilePos[i-1] = rest % grid_[i-1];
+          rest /= grid_[i-1];
+        }
+
+        pos_t previous = -2;
+        for (pos_t j = 0; j < runs; ++j)
+        {
+          bool dirty = clear
+            ? flags_[row + j].exchange(false, std::memory_order_acq_rel)
+            : flags_[row + j].load(std::memory_order_acquire);
+          if (!dirty)
+            continue;
+
+          tilePos[N-1] = j;
+          Region<N> region;
+          for (std::size_t i = 0; i < N; ++i)
+          {
+            region.loc[i] = tilePos[i] * tile_[i];
+            region.sizes[i] = std::min(tile_[i], array_.sizes()[i] - region.loc[i]);
+          }
+
+          if (previous == j - 1)
+            ret.back().sizes[N-1] += region.sizes[N-1];
+          else
+            ret.push_back(region);
+          previous = j;
+        }
+      }
+      return ret;
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    NArray<T, N> array_;
+    Point<N> tile_;
+    Point<N> grid_;
+    pos_t count_;
+    std::unique_ptr<std::atomic<bool>[]> flags_;
+
+  }; // class DirtyTracker
+
+} // namespace wilt
+
+#endif // !WILT_DIRTYTRACKER_HPP
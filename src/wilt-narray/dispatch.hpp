@@ -0,0 +1,121 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: dispatch.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines runtime detection of the CPU's vector instruction sets
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_DISPATCH_HPP
+#define WILT_DISPATCH_HPP
+
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+// Kernels are compiled for several instruction sets with target attributes
+// and picked at runtime. This needs GCC or Clang on x86 and can be turned off
+// with WILT_NARRAY_NO_DISPATCH to keep code size down.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)) && !defined(WILT_NARRAY_NO_DISPATCH)
+#define WILT_HAS_TARGET_DISPATCH
+#define WILT_TARGET(isa) __attribute__((target(isa)))
+#define WILT_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define WILT_TARGET(isa)
+#define WILT_ALWAYS_INLINE inline
+#endif
+
+namespace wilt
+{
+  // The instruction set levels kernels are compiled for, each includes the
+  // ones before it
+  enum class CpuLevel
+  {
+    GENERIC,  // whatever the compiler flags allow
+    SSE42,    // SSSE3 and SSE4.2
+    AVX2,     // AVX2
+    AVX512    // AVX-512 F, BW, and VL
+  };
+
+  // Gets the name of a level as accepted by WILT_NARRAY_ISA
+  inline const char* cpuLevelName(CpuLevel level) noexcept
+  {
+    switch (level)
+    {
+    case CpuLevel::SSE42: return "sse4.2";
+    case CpuLevel::AVX2: return "avx2";
+    case CpuLevel::AVX512: return "avx512";
+    default: return "generic";
+    }
+  }
+
+namespace detail
+{
+  // Gets the highest level the processor supports
+  inline CpuLevel detectCpuLevel() noexcept
+  {
+#ifdef WILT_HAS_TARGET_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl"))
+      return CpuLevel::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+      return CpuLevel::AVX2;
+    if (__builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.2"))
+      return CpuLevel::SSE42;
+#endif
+    return CpuLevel::GENERIC;
+  }
+
+  // Gets the level to use given a requested level name, the request can only
+  // lower the level since running unsupported instructions would crash; an
+  // unrecognized or missing request is ignored
+  inline CpuLevel selectCpuLevel(const char* request, CpuLevel detected) noexcept
+  {
+    if (request == nullptr)
+      return detected;
+
+    for (CpuLevel level : { CpuLevel::GENERIC, CpuLevel::SSE42, CpuLevel::AVX2, CpuLevel::AVX512 })
+      if (std::strcmp(request, cpuLevelName(level)) == 0)
+        return level < detected ? level : detected;
+
+    return detected;
+  }
+
+} // namespace detail
+
+  //! @brief         gets the instruction set level the library's kernels use
+  //! @return        the highest level the processor supports, or lower if
+  //!                set by the WILT_NARRAY_ISA environment variable
+  //!
+  //! This is decided once, the first time it is called, and each kernel keeps
+  //! the function it picked from then on. Setting WILT_NARRAY_ISA to one of
+  //! "generic", "sse4.2", "avx2" or "avx512" before the program starts is
+  //! meant for testing the lower levels on a capable machine.
+  inline CpuLevel cpuLevel() noexcept
+  {
+    static const CpuLevel level = detail::selectCpuLevel(std::getenv("WILT_NARRAY_ISA"), detail::detectCpuLevel());
+    return level;
+  }
+
+} // namespace wilt
+
+#endif // !WILT_DISPATCH_HPP
@@ -0,0 +1,447 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: distributed.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines a domain-decomposed array spread across processes
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_DISTRIBUTED_HPP
+#define WILT_DISTRIBUTED_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "narray.hpp"
+#include "mapping.hpp"
+
+namespace wilt
+{
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is the interface used by `DistributedNArray` to move data
+  // between ranks.
+  //
+  // Only one operation is needed: a combined send and receive with (possibly
+  // different) peers. Combining them lets an implementation make progress on
+  // both at once, so neighboring ranks that exchange with each other at the
+  // same time can't deadlock on full buffers.
+
+  class Transport
+  {
+  public:
+    // Used in place of a rank when there is no peer
+    enum : std::size_t { NONE = (std::size_t)-1 };
+
+    virtual ~Transport() = default;
+
+    // This process's rank and the total number of ranks
+    virtual std::size_t rank() const = 0;
+    virtual std::size_t size() const = 0;
+
+    // Sends 'sendBytes' from 'sendData' to rank 'to' while receiving exactly
+    // 'recvBytes' into 'recvData' from rank 'from', either may be NONE
+    virtual void exchange(std::size_t to, const void* sendData, std::size_t sendBytes,
+                          std::size_t from, void* recvData, std::size_t recvBytes) = 0;
+
+  }; // class Transport
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is a `Transport` over connected Unix stream sockets, one per
+  // peer.
+  //
+  // 'createLocal()' connects every pair of ranks with `socketpair()`, which
+  // works for ranks that are threads of one process or processes that are
+  // `fork()`ed afterwards (each child keeps its own transport and drops the
+  // others).
+
+  class SocketTransport : public Transport
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Creates a transport from connected sockets, 'sockets[r]' is the socket
+    // to rank 'r' and is ignored for this rank. The transport takes ownership
+    // of the sockets.
+    SocketTransport(std::size_t rank, std::vector<int> sockets)
+      : rank_(rank)
+      , sockets_(std::move(sockets))
+    {
+      if (rank_ >= sockets_.size())
+        throw std::invalid_argument("SocketTransport(rank, sockets): rank out of bounds");
+    }
+
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator= (const SocketTransport&) = delete;
+
+    ~SocketTransport()
+    {
+      for (std::size_t i = 0; i < sockets_.size(); ++i)
+        if (i != rank_ && sockets_[i] >= 0)
+          ::close(sockets_[i]);
+    }
+
+    // Creates transports for 'count' ranks that are all connected together
+    static std::vector<std::unique_ptr<SocketTransport>> createLocal(std::size_t count)
+    {
+      std::vector<std::vector<int>> sockets(count, std::vector<int>(count, -1));
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        for (std::size_t j = i + 1; j < count; ++j)
+        {
+          int pair[2];
+          if (::socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0)
+          {
+            for (auto& row : sockets)
+              for (int fd : row)
+                if (fd >= 0)
+                  ::close(fd);
+            throw std::runtime_error(detail::errnoMessage("createLocal(count): socketpair() failed"));
+          }
+          sockets[i][j] = pair[0];
+          sockets[j][i] = pair[1];
+        }
+      }
+
+      std::vector<std::unique_ptr<SocketTransport>> ret;
+      for (std::size_t i = 0; i < count; ++i)
+        ret.emplace_back(new SocketTransport(i, std::move(sockets[i])));
+      return ret;
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TRANSPORT FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::size_t rank() const override
+    {
+      return rank_;
+    }
+
+    std::size_t size() const override
+    {
+      return sockets_.size();
+    }
+
+    void exchange(std::size_t to, const void* sendData, std::size_t sendBytes,
+                  std::size_t from, void* recvData, std::size_t recvBytes) override
+    {
+      if ((to != NONE && (to >= size() || to == rank_)) || (from != NONE && (from >= size() || from == rank_)))
+        throw std::invalid_argument("exchange(): peer out of bounds");
+
+      const char* sendPtr = static_cast<const char*>(sendData);
+      char* recvPtr = static_cast<char*>(recvData);
+      std::size_t sendLeft = to == NONE ? 0 : sendBytes;
+      std::size_t recvLeft = from == NONE ? 0 : recvBytes;
+
+      while (sendLeft > 0 || recvLeft > 0)
+      {
+        pollfd fds[2];
+        nfds_t count = 0;
+        if (sendLeft > 0)
+          fds[count++] = pollfd{ sockets_[to], POLLOUT, 0 };
+        if (recvLeft > 0)
+          fds[count++] = pollfd{ sockets_[from], POLLIN, 0 };
+
+        if (::poll(fds, count, -1) < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          throw std::runtime_error(detail::errnoMessage("exchange(): poll() failed"));
+        }
+
+        for (nfds_t i = 0; i < count; ++i)
+        {
+          if (fds[i].revents == 0)
+            continue;
+
+          if (fds[i].events == POLLOUT)
+          {
+            ssize_t n = ::send(fds[i].fd, sendPtr, sendLeft, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+              throw std::runtime_error(detail::errnoMessage("exchange(): send() failed"));
+            if (n > 0)
+            {
+              sendPtr += n;
+              sendLeft -= (std::size_t)n;
+            }
+          }
+          else
+          {
+            ssize_t n = ::recv(fds[i].fd, recvPtr, recvLeft, MSG_DONTWAIT);
+            if (n == 0)
+              throw std::runtime_error("exchange(): peer closed the connection");
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+              throw std::runtime_error(detail::errnoMessage("exchange(): recv() failed"));
+            if (n > 0)
+            {
+              recvPtr += n;
+              recvLeft -= (std::size_t)n;
+            }
+          }
+        }
+      }
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::size_t rank_;
+    std::vector<int> sockets_;
+
+  }; // class SocketTransport
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is designed to split a global array across ranks, each holding
+  // one block of it along with a border of ghost cells.
+  //
+  // The ranks are arranged in a grid where 'grid[d]' is the number of ranks
+  // along dimension 'd' (1 for dimensions that aren't split), and the product
+  // of the grid must equal the number of ranks. Ranks are laid out row-major
+  // in the grid. Each split dimension is divided as evenly as possible and the
+  // local block is padded by 'ghost' cells on both sides of each split
+  // dimension.
+  //
+  // The local block is an ordinary `NArray`: 'local()' includes the ghost
+  // cells and 'interior()' is the view of the cells this rank owns, so
+  // existing stencil kernels can run on them unchanged. 'exchangeHalos()'
+  // fills the ghost cells from the neighboring ranks' interiors. Dimensions
+  // are exchanged one at a time with the full extent of earlier dimensions,
+  // so corner and edge ghosts are filled too.
+  //
+  // NOTE: every rank must call 'exchangeHalos()' together
+  // NOTE: ghost cells at the edges of the global array are never written by
+  // the exchange, they can be used for boundary conditions
+  // NOTE: T must be trivially copyable since it is sent as bytes
+
+  template <class T, std::size_t N>
+  class DistributedNArray
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ASSERTS
+    ////////////////////////////////////////////////////////////////////////////
+    static_assert(std::is_trivially_copyable<T>::value, "DistributedNArray<T, N>: T must be trivially copyable");
+    static_assert(!std::is_const<T>::value, "DistributedNArray<T, N>: T must not be const");
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Creates this rank's block of a global array of 'globalSizes', elements
+    // are default constructed
+    DistributedNArray(Transport& transport, const Point<N>& globalSizes, const Point<N>& grid, pos_t ghost)
+      : transport_(&transport)
+      , globalSizes_(globalSizes)
+      , grid_(grid)
+      , coords_()
+      , offset_()
+      , ghosts_()
+      , local_()
+      , interior_()
+    {
+      if (!wilt::detail::validSize(globalSizes))
+        throw std::invalid_argument("DistributedNArray(): global sizes are not valid");
+      if (!wilt::detail::validSize(grid))
+        throw std::invalid_argument("DistributedNArray(): grid is not valid");
+      if ((std::size_t)wilt::detail::size(grid) != transport.size())
+        throw std::invalid_argument("DistributedNArray(): grid does not match the number of ranks");
+      if (ghost < 0)
+        throw std::invalid_argument("DistributedNArray(): ghost must not be negative");
+
+      std::size_t rank = transport.rank();
+      for (std::size_t i = N; i > 0; --i)
+      {
+        coords_[i-1] = (pos_t)rank % grid[i-1];
+        rank /= (std::size_t)grid[i-1];
+      }
+
+      Point<N> interiorSizes;
+      Point<N> localSizes;
+      for (std::size_t i = 0; i < N; ++i)
+      {
+        pos_t base = globalSizes[i] / grid[i];
+        pos_t extra = globalSizes[i] % grid[i];
+        interiorSizes[i] = base + (coords_[i] < extra ? 1 : 0);
+        offset_[i] = coords_[i] * base + std::min(coords_[i], extra);
+        ghosts_[i] = grid[i] > 1 ? ghost : 0;
+        localSizes[i] = interiorSizes[i] + 2 * ghosts_[i];
+
+        if (interiorSizes[i] < ghosts_[i] || interiorSizes[i] == 0)
+          throw std::invalid_argument("DistributedNArray(): blocks are smaller than the ghost width");
+      }
+
+      local_ = NArray<T, N>(localSizes);
+      interior_ = local_.subarray(ghosts_, interiorSizes);
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    const Point<N>& globalSizes() const noexcept
+    {
+      return globalSizes_;
+    }
+
+    const Point<N>& grid() const noexcept
+    {
+      return grid_;
+    }
+
+    // The position of this rank in the grid
+    const Point<N>& coords() const noexcept
+    {
+      return coords_;
+    }
+
+    // The global position of the first interior element
+    const Point<N>& globalOffset() const noexcept
+    {
+      return offset_;
+    }
+
+    // The ghost width of each dimension, zero for dimensions that aren't split
+    const Point<N>& ghosts() const noexcept
+    {
+      return ghosts_;
+    }
+
+    // The rank of the neighbor 'direction' (-1 or +1) blocks away along 'dim',
+    // or Transport::NONE if it would be outside of the grid
+    std::size_t neighbor(std::size_t dim, pos_t direction) const
+    {
+      if (dim >= N)
+        throw std::out_of_range("neighbor(dim, direction): dim out of bounds");
+
+      Point<N> coords = coords_;
+      coords[dim] += direction;
+      if (coords[dim] < 0 || coords[dim] >= grid_[dim])
+        return Transport::NONE;
+
+      std::size_t rank = 0;
+      for (std::size_t i = 0; i < N; ++i)
+        rank = rank * (std::size_t)grid_[i] + (std::size_t)coords[i];
+      return rank;
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESS FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // The local block including ghost cells
+    const NArray<T, N>& local() const noexcept
+    {
+      return local_;
+    }
+
+    // The local block without ghost cells
+    const NArray<T, N>& interior() const noexcept
+    {
+      return interior_;
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // MODIFIER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Fills the ghost cells with the neighboring interiors
+    void exchangeHalos()
+    {
+      for (std::size_t dim = 0; dim < N; ++dim)
+      {
+        if (ghosts_[dim] == 0)
+          continue;
+
+        pos_t ghost = ghosts_[dim];
+        pos_t inner = interior_.sizes()[dim];
+
+        // send the high face up while receiving the low ghosts from below,
+        // then the reverse
+        exchange_(neighbor(dim, +1), local_.range(dim, inner, ghost),
+                  neighbor(dim, -1), local_.range(dim, 0, ghost));
+        exchange_(neighbor(dim, -1), local_.range(dim, ghost, ghost),
+                  neighbor(dim, +1), local_.range(dim, ghost + inner, ghost));
+      }
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    void exchange_(std::size_t to, const NArray<T, N>& face, std::size_t from, const NArray<T, N>& ghost)
+    {
+      if (to == Transport::NONE && from == Transport::NONE)
+        return;
+
+      NArray<T, N> sendBuffer = to != Transport::NONE ? face.clone() : NArray<T, N>();
+      NArray<T, N> recvBuffer = from != Transport::NONE ? NArray<T, N>(ghost.sizes()) : NArray<T, N>();
+
+      transport_->exchange(
+        to, sendBuffer.data(), sendBuffer.size() * sizeof(T),
+        from, recvBuffer.data(), recvBuffer.size() * sizeof(T));
+
+      if (from != Transport::NONE)
+        ghost.setTo(recvBuffer);
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    Transport* transport_;
+    Point<N> globalSizes_;
+    Point<N> grid_;
+    Point<N> coords_;
+    Point<N> offset_;
+    Point<N> ghosts_;
+    NArray<T, N> local_;
+    NArray<T, N> interior_;
+
+  }; // class DistributedNArray
+
+} // namespace wilt
+
+#endif // !WILT_DISTRIBUTED_HPP
@@ -0,0 +1,208 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: dlpack.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines conversions between NArray and DLPack tensors
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_DLPACK_HPP
+#define WILT_DLPACK_HPP
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "dlpack/dlpack.h"
+#include "narray.hpp"
+
+namespace wilt
+{
+namespace detail
+{
+  template <class T, class = void>
+  struct DLDataTypeTraits;
+
+  template <>
+  struct DLDataTypeTraits<bool>
+  {
+    static constexpr std::uint8_t code = kDLBool;
+  };
+
+  template <class T>
+  struct DLDataTypeTraits<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type>
+  {
+    static constexpr std::uint8_t code = std::is_signed<T>::value ? kDLInt : kDLUInt;
+  };
+
+  template <class T>
+  struct DLDataTypeTraits<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+  {
+    static constexpr std::uint8_t code = kDLFloat;
+  };
+
+  template <class T>
+  struct DLDataTypeTraits<std::complex<T>, void>
+  {
+    static constexpr std::uint8_t code = kDLComplex;
+  };
+
+  // Owns everything a DLManagedTensor made from an array refers to
+  template <class T, std::size_t N>
+  struct DLPackContext
+  {
+    DLManagedTensor tensor;
+    NArray<T, N> array;
+    std::int64_t shape[N];
+    std::int64_t strides[N];
+  };
+
+} // namespace detail
+
+  //! @brief         gets the DLPack data type of an element type
+  //! @return        the data type, with a single lane
+  //!
+  //! Supports bool, integers, floating point, and std::complex
+  template <class T>
+  DLDataType dlDataTypeOf() noexcept
+  {
+    using U = typename std::remove_const<T>::type;
+
+    DLDataType ret;
+    ret.code = detail::DLDataTypeTraits<U>::code;
+    ret.bits = (std::uint8_t)(sizeof(U) * 8);
+    ret.lanes = 1;
+    return ret;
+  }
+
+  //! @brief         exports an array as a DLPack tensor without copying
+  //! @param[in]     arr - the array to export
+  //! @return        a managed tensor over the array's data, the consumer must
+  //!                call its deleter when done
+  //!
+  //! The tensor keeps the array's data alive until its deleter is called, and
+  //! its strides are the array's steps. Arrays of const elements can be
+  //! exported but the consumer must not write through the tensor.
+  template <class T, std::size_t N>
+  DLManagedTensor* toDLPack(const NArray<T, N>& arr)
+  {
+    static_assert(N > 0, "toDLPack(arr): array must have at least one dimension");
+
+    using U = typename std::remove_const<T>::type;
+    using Context = detail::DLPackContext<T, N>;
+
+    std::unique_ptr<Context> context(new Context());
+    context->array = arr;
+    for (std::size_t i = 0; i < N; ++i)
+    {
+      context->shape[i] = arr.sizes()[i];
+      context->strides[i] = arr.steps()[i];
+    }
+
+    DLTensor& tensor = context->tensor.dl_tensor;
+    tensor.data = const_cast<U*>(arr.data());
+    tensor.device.device_type = kDLCPU;
+    tensor.device.device_id = 0;
+    tensor.ndim = (std::int32_t)N;
+    tensor.dtype = dlDataTypeOf<T>();
+    tensor.shape = context->shape;
+    tensor.strides = context->strides;
+    tensor.byte_offset = 0;
+
+    context->tensor.manager_ctx = context.get();
+    context->tensor.deleter = [](DLManagedTensor* self) {
+      delete static_cast<Context*>(self->manager_ctx);
+    };
+
+    return &context.release()->tensor;
+  }
+
+  //! @brief         imports a DLPack tensor as an array without copying
+  //! @param[in]     tensor - the tensor to import, it must be on the CPU
+  //! @param[in]     owner - whatever owns the data, it is kept alive as long
+  //!                as the array or any array made from it
+  //! @return        an array over the tensor's data
+  //!
+  //! Throws std::invalid_argument if the tensor isn't on the CPU, or its data
+  //! type or number of dimensions don't match
+  //! Without an owner, the data must outlive the array and any array made
+  //! from it.
+  template <class T, std::size_t N>
+  NArray<T, N> fromDLPack(const DLTensor& tensor, std::shared_ptr<const void> owner = nullptr)
+  {
+    static_assert(N > 0, "fromDLPack(tensor): array must have at least one dimension");
+
+    DLDataType dtype = dlDataTypeOf<T>();
+    if (tensor.device.device_type != kDLCPU && tensor.device.device_type != kDLCUDAHost)
+      throw std::invalid_argument("fromDLPack(tensor): tensor must be in CPU memory");
+    if (tensor.ndim != (std::int32_t)N)
+      throw std::invalid_argument("fromDLPack(tensor): tensor has a different number of dimensions");
+    if (tensor.dtype.code != dtype.code || tensor.dtype.bits != dtype.bits || tensor.dtype.lanes != dtype.lanes)
+      throw std::invalid_argument("fromDLPack(tensor): tensor has a different data type");
+
+    Point<N> sizes;
+    for (std::size_t i = 0; i < N; ++i)
+      sizes[i] = (pos_t)tensor.shape[i];
+    if (!wilt::detail::validSize(sizes))
+      return NArray<T, N>();
+
+    Point<N> steps = wilt::detail::step(sizes);
+    if (tensor.strides)
+      for (std::size_t i = 0; i < N; ++i)
+        steps[i] = (pos_t)tensor.strides[i];
+
+    T* data = reinterpret_cast<T*>(static_cast<char*>(tensor.data) + tensor.byte_offset);
+    std::shared_ptr<T> ptr = owner ? std::shared_ptr<T>(owner, data) : std::shared_ptr<T>(data, [](T*) { });
+    return NArray<T, N>(std::move(ptr), sizes, steps);
+  }
+
+  //! @brief         imports a managed DLPack tensor as an array without
+  //!                copying
+  //! @param[in]     tensor - the tensor to import, it must be on the CPU
+  //! @return        an array over the tensor's data, the tensor's deleter is
+  //!                called once the array and all arrays made from it are gone
+  //!
+  //! Throws std::invalid_argument if the tensor isn't on the CPU, or its data
+  //! type or number of dimensions don't match, the caller still owns the
+  //! tensor in that case
+  template <class T, std::size_t N>
+  NArray<T, N> fromDLPack(DLManagedTensor* tensor)
+  {
+    if (!tensor)
+      throw std::invalid_argument("fromDLPack(tensor): tensor is null");
+
+    // validate before taking ownership
+    fromDLPack<T, N>(tensor->dl_tensor);
+
+    std::shared_ptr<const void> owner(tensor, [](DLManagedTensor* self) {
+      if (self->deleter)
+        self->deleter(self);
+    });
+    return fromDLPack<T, N>(tensor->dl_tensor, std::move(owner));
+  }
+
+} // namespace wilt
+
+#endif // !WILT_DLPACK_HPP
@@ -0,0 +1,394 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: imageio.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines readers and writers for PGM, PPM, BMP, and raw images (POSIX)
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_IMAGEIO_HPP
+#define WILT_IMAGEIO_HPP
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/uio.h>
+
+#include "narray.hpp"
+#include "mapping.hpp"
+#include "byteorder.hpp"
+
+namespace wilt
+{
+namespace detail
+{
+  struct PnmHeader
+  {
+    pos_t width;
+    pos_t height;
+    pos_t maxval;
+    std::size_t dataOffset;
+  };
+
+  // Parses the header of a binary PNM file of the given 'type' ('5' for PGM,
+  // '6' for PPM)
+  inline PnmHeader parsePnmHeader(const char* data, std::size_t size, char type, const std::string& path)
+  {
+    if (size < 2 || data[0] != 'P' || data[1] != type)
+      throw std::runtime_error("'" + path + "' is not a binary P" + type + " file");
+
+    std::size_t pos = 2;
+    pos_t values[3];
+    for (pos_t& value : values)
+    {
+      for (;;)
+      {
+        if (pos == size)
+          throw std::runtime_error("'" + path + "' has a truncated header");
+        if (data[pos] == '#')
+          while (pos < size && data[pos] != '\n')
+            ++pos;
+        else if (std::isspace((unsigned char)data[pos]))
+          ++pos;
+        else
+          break;
+      }
+
+      if (!std::isdigit((unsigned char)data[pos]))
+        throw std::runtime_error("'" + path + "' has a malformed header");
+
+      value = 0;
+      for (; pos < size && std::isdigit((unsigned char)data[pos]); ++pos)
+      {
+        value = value * 10 + (data[pos] - '0');
+        if (value > (1 << 30))
+          throw std::runtime_error("'" + path + "' has a malformed header");
+      }
+    }
+
+    // a single whitespace character separates the header from the samples
+    if (pos == size || !std::isspace((unsigned char)data[pos]))
+      throw std::runtime_error("'" + path + "' has a malformed header");
+
+    PnmHeader header;
+    header.width = values[0];
+    header.height = values[1];
+    header.maxval = values[2];
+    header.dataOffset = pos + 1;
+
+    if (header.width <= 0 || header.height <= 0 || header.maxval <= 0 || header.maxval > 65535)
+      throw std::runtime_error("'" + path + "' has a malformed header");
+
+    return header;
+  }
+
+  // Maps a PNM file and returns a view over its samples, 'Sample' is one byte
+  // for 8-bit files or a big-endian value for 16-bit files
+  template <class Sample, std::size_t N>
+  NArray<const Sample, N> readPnm(const std::string& path, char type, pos_t channels)
+  {
+    auto mapping = mapFile(path);
+    WILT_TRACE_SCOPE("readImage", mapping->size());
+    PnmHeader header = parsePnmHeader(mapping->data(), mapping->size(), type, path);
+    if (sizeof(Sample) == 1 && header.maxval > 255)
+      throw std::runtime_error("'" + path + "' has 16-bit samples");
+    if (sizeof(Sample) == 2 && header.maxval <= 255)
+      throw std::runtime_error("'" + path + "' has 8-bit samples");
+
+    std::size_t bytes = (std::size_t)(header.width * header.height * channels) * sizeof(Sample);
+    if (mapping->size() - header.dataOffset < bytes)
+      throw std::runtime_error("'" + path + "' is too short");
+
+    Point<N> sizes;
+    sizes[0] = header.height;
+    sizes[1] = header.width;
+    if (N == 3)
+      sizes[N-1] = channels;
+
+    auto data = reinterpret_cast<const Sample*>(mapping->data() + header.dataOffset);
+    return NArray<const Sample, N>(std::shared_ptr<const Sample>(mapping, data), sizes);
+  }
+
+  inline std::uint32_t readLE(const char* data, std::size_t bytes) noexcept
+  {
+    std::uint32_t value = 0;
+    for (std::size_t i = bytes; i > 0; --i)
+      value = (value << 8) | (std::uint8_t)data[i-1];
+    return value;
+  }
+
+  inline void writeLE(char* data, std::uint32_t value, std::size_t bytes) noexcept
+  {
+    for (std::size_t i = 0; i < bytes; ++i, value >>= 8)
+      data[i] = (char)(value & 0xFF);
+  }
+
+  // Replaces the file at 'path' with the contents of 'iov' in one call
+  inline void writeFile(const std::string& path, std::vector<iovec>& iov)
+  {
+    FileDescriptor file(::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644));
+    if (file.get() < 0)
+      throw std::runtime_error(errnoMessage("could not open '" + path + "'"));
+
+    writevAll(file.get(), iov.data(), (int)iov.size());
+  }
+
+  template <std::size_t N>
+  void writePnm(const std::string& path, const NArray<const std::uint8_t, N>& img, char type)
+  {
+    WILT_TRACE_SCOPE("writeImage", img.sizes(), (std::size_t)img.size());
+    auto data = img.isContiguous() && img.isAligned() ? img : NArray<const std::uint8_t, N>(img.clone());
+    std::string header = std::string("P") + type + "\n" + std::to_string(img.sizes()[1]) + " " + std::to_string(img.sizes()[0]) + "\n255\n";
+
+    std::vector<iovec> iov = {
+      iovec{ const_cast<char*>(header.data()), header.size() },
+      iovec{ const_cast<std::uint8_t*>(data.data()), data.size() }
+    };
+    writeFile(path, iov);
+  }
+
+} // namespace detail
+
+  //! @brief         reads a binary (P5) PGM image without copying its pixels
+  //! @param[in]     path - the file to read
+  //! @return        a view of the pixels over the mapped file, with sizes
+  //!                { height, width }
+  //!
+  //! Throws std::runtime_error if the file can't be read, isn't a binary PGM
+  //! file, or has samples larger than 8 bits
+  inline NArray<const std::uint8_t, 2> readPgm(const std::string& path)
+  {
+    return detail::readPnm<std::uint8_t, 2>(path, '5', 1);
+  }
+
+  //! @brief         reads a binary (P6) PPM image without copying its pixels
+  //! @param[in]     path - the file to read
+  //! @return        a view of the pixels over the mapped file, with sizes
+  //!                { height, width, 3 } in RGB order
+  //!
+  //! Throws std::runtime_error if the file can't be read, isn't a binary PPM
+  //! file, or has samples larger than 8 bits
+  inline NArray<const std::uint8_t, 3> readPpm(const std::string& path)
+  {
+    return detail::readPnm<std::uint8_t, 3>(path, '6', 3);
+  }
+
+  //! @brief         reads a 16-bit binary (P5) PGM image without copying its
+  //!                pixels
+  //! @param[in]     path - the file to read
+  //! @return        a view of the big-endian pixels over the mapped file, with
+  //!                sizes { height, width }
+  //!
+  //! Throws std::runtime_error if the file can't be read, isn't a binary PGM
+  //! file, or has 8-bit samples
+  //! Pixels are swapped to native order as they are read, or all at once with
+  //! 'toNativeOrder()'.
+  inline NArray<const BigEndian<std::uint16_t>, 2> readPgm16(const std::string& path)
+  {
+    return detail::readPnm<BigEndian<std::uint16_t>, 2>(path, '5', 1);
+  }
+
+  //! @brief         reads a 16-bit binary (P6) PPM image without copying its
+  //!                pixels
+  //! @param[in]     path - the file to read
+  //! @return        a view of the big-endian pixels over the mapped file, with
+  //!                sizes { height, width, 3 } in RGB order
+  //!
+  //! Throws std::runtime_error if the file can't be read, isn't a binary PPM
+  //! file, or has 8-bit samples
+  inline NArray<const BigEndian<std::uint16_t>, 3> readPpm16(const std::string& path)
+  {
+    return detail::readPnm<BigEndian<std::uint16_t>, 3>(path, '6', 3);
+  }
+
+  //! @brief         reads an uncompressed 24 or 32-bit BMP image without
+  //!                copying its pixels
+  //! @param[in]     path - the file to read
+  //! @return        a view of the pixels over the mapped file, with sizes
+  //!                { height, width, 3 or 4 } in BGR(A) order and the first
+  //!                row at the top
+  //!
+  //! Throws std::runtime_error if the file can't be read or isn't a supported
+  //! BMP file
+  //! Bottom-up images, the common case, are returned with a negative row step
+  //! so the rows don't need to be reordered.
+  inline NArray<const std::uint8_t, 3> readBmp(const std::string& path)
+  {
+    auto mapping = detail::mapFile(path);
+    WILT_TRACE_SCOPE("readImage", mapping->size());
+    const char* data = mapping->data();
+    std::size_t size = mapping->size();
+
+    if (size < 54 || data[0] != 'B' || data[1] != 'M' || detail::readLE(data + 14, 4) < 40)
+      throw std::runtime_error("'" + path + "' is not a BMP file");
+
+    std::size_t dataOffset = detail::readLE(data + 10, 4);
+    pos_t width = (std::int32_t)detail::readLE(data + 18, 4);
+    pos_t height = (std::int32_t)detail::readLE(data + 22, 4);
+    std::uint32_t bits = detail::readLE(data + 28, 2);
+    std::uint32_t compression = detail::readLE(data + 30, 4);
+
+    // 32-bit images may use bitfields, but only with the usual BGRA layout
+    bool supported = (bits == 24 && compression == 0) || (bits == 32 && compression == 0);
+    if (bits == 32 && compression == 3 && size >= 66)
+      supported = detail::readLE(data + 54, 4) == 0x00FF0000 && detail::readLE(data + 58, 4) == 0x0000FF00 && detail::readLE(data + 62, 4) == 0x000000FF;
+    if (!supported)
+      throw std::runtime_error("'" + path + "' is not an uncompressed 24 or 32-bit BMP file");
+
+    bool bottomUp = height > 0;
+    if (!bottomUp)
+      height = -height;
+    if (width <= 0 || height <= 0)
+      throw std::runtime_error("'" + path + "' has invalid dimensions");
+
+    pos_t channels = bits / 8;
+    pos_t stride = (width * channels + 3) / 4 * 4;
+    if (dataOffset > size || (std::size_t)(stride * height) > size - dataOffset)
+      throw std::runtime_error("'" + path + "' is too short");
+
+    auto first = reinterpret_cast<const std::uint8_t*>(data + dataOffset);
+    if (bottomUp)
+      first += (height - 1) * stride;
+
+    return NArray<const std::uint8_t, 3>(
+      std::shared_ptr<const std::uint8_t>(mapping, first),
+      { height, width, channels },
+      { bottomUp ? -stride : stride, channels, 1 });
+  }
+
+  //! @brief         reads an array of raw elements in row-major order without
+  //!                copying them
+  //! @param[in]     path - the file to read
+  //! @param[in]     sizes - the dimensions of the array
+  //! @param[in]     offset - the byte offset in the file the elements start at
+  //! @return        a view of the elements over the mapped file
+  //!
+  //! Throws std::runtime_error if the file can't be read or is too short
+  //! Throws std::invalid_argument if 'offset' isn't aligned for T
+  template <class T, std::size_t N>
+  NArray<const T, N> mapRaw(const std::string& path, const Point<N>& sizes, std::size_t offset = 0)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "mapRaw(): invalid when element type is not trivially copyable");
+
+    if (!wilt::detail::validSize(sizes))
+      throw std::invalid_argument("mapRaw(): sizes is not valid");
+    if (offset % alignof(T) != 0)
+      throw std::invalid_argument("mapRaw(): offset is not aligned for the element type");
+
+    auto mapping = detail::mapFile(path);
+    std::size_t bytes = (std::size_t)wilt::detail::size(sizes) * sizeof(T);
+    if (offset > mapping->size() || mapping->size() - offset < bytes)
+      throw std::runtime_error("mapRaw(): '" + path + "' is too short");
+
+    auto data = reinterpret_cast<const T*>(mapping->data() + offset);
+    return NArray<const T, N>(std::shared_ptr<const T>(mapping, data), sizes);
+  }
+
+  //! @brief         writes a binary (P5) PGM image
+  //! @param[in]     path - the file to write, it is replaced if it exists
+  //! @param[in]     img - the pixels with sizes { height, width }
+  //!
+  //! Throws std::runtime_error if the file can't be written
+  //! The header and pixels are written in one call, images that aren't
+  //! contiguous and in-order are copied first
+  inline void writePgm(const std::string& path, const NArray<const std::uint8_t, 2>& img)
+  {
+    if (img.empty())
+      throw std::invalid_argument("writePgm(): image is empty");
+
+    detail::writePnm(path, img, '5');
+  }
+
+  //! @brief         writes a binary (P6) PPM image
+  //! @param[in]     path - the file to write, it is replaced if it exists
+  //! @param[in]     img - the pixels with sizes { height, width, 3 } in RGB
+  //!                order
+  //!
+  //! Throws std::runtime_error if the file can't be written
+  //! The header and pixels are written in one call, images that aren't
+  //! contiguous and in-order are copied first
+  inline void writePpm(const std::string& path, const NArray<const std::uint8_t, 3>& img)
+  {
+    if (img.empty() || img.sizes()[2] != 3)
+      throw std::invalid_argument("writePpm(): image must have 3 channels");
+
+    detail::writePnm(path, img, '6');
+  }
+
+  //! @brief         writes an uncompressed 24 or 32-bit BMP image
+  //! @param[in]     path - the file to write, it is replaced if it exists
+  //! @param[in]     img - the pixels with sizes { height, width, 3 or 4 } in
+  //!                BGR(A) order
+  //!
+  //! Throws std::runtime_error if the file can't be written
+  //! The rows are written bottom-up with their padding in one call, images
+  //! whose rows aren't contiguous are copied first
+  inline void writeBmp(const std::string& path, const NArray<const std::uint8_t, 3>& img)
+  {
+    if (img.empty() || (img.sizes()[2] != 3 && img.sizes()[2] != 4))
+      throw std::invalid_argument("writeBmp(): image must have 3 or 4 channels");
+
+    WILT_TRACE_SCOPE("writeImage", img.sizes(), (std::size_t)img.size());
+    pos_t height = img.sizes()[0];
+    pos_t width = img.sizes()[1];
+    pos_t channels = img.sizes()[2];
+    auto data = img.steps()[2] == 1 && img.steps()[1] == channels ? img : NArray<const std::uint8_t, 3>(img.clone());
+
+    pos_t rowBytes = width * channels;
+    pos_t stride = (rowBytes + 3) / 4 * 4;
+    std::uint32_t imageBytes = (std::uint32_t)(stride * height);
+
+    char header[54] = {};
+    header[0] = 'B';
+    header[1] = 'M';
+    detail::writeLE(header + 2, 54 + imageBytes, 4);
+    detail::writeLE(header + 10, 54, 4);
+    detail::writeLE(header + 14, 40, 4);
+    detail::writeLE(header + 18, (std::uint32_t)width, 4);
+    detail::writeLE(header + 22, (std::uint32_t)height, 4);
+    detail::writeLE(header + 26, 1, 2);
+    detail::writeLE(header + 28, (std::uint32_t)(channels * 8), 2);
+    detail::writeLE(header + 34, imageBytes, 4);
+
+    char padding[3] = {};
+    std::vector<iovec> iov;
+    iov.reserve((std::size_t)height * 2 + 1);
+    iov.push_back(iovec{ header, sizeof(header) });
+    for (pos_t y = height; y > 0; --y)
+    {
+      iov.push_back(iovec{ const_cast<std::uint8_t*>(data.data() + (y - 1) * data.steps()[0]), (std::size_t)rowBytes });
+      if (stride != rowBytes)
+        iov.push_back(iovec{ padding, (std::size_t)(stride - rowBytes) });
+    }
+    detail::writeFile(path, iov);
+  }
+
+} // namespace wilt
+
+#endif // !WILT_IMAGEIO_HPP
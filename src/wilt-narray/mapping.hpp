@@ -0,0 +1,267 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: mapping.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines a shared-resource class for memory-mapped regions and file
+//       helpers (POSIX)
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_MAPPING_HPP
+#define WILT_MAPPING_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace wilt
+{
+namespace detail
+{
+  // Builds an error message that includes the description of 'errno'
+  inline std::string errnoMessage(const std::string& message)
+  {
+    return message + ": " + std::strerror(errno);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class owns a memory-mapped region and unmaps it when destroyed.
+  //
+  // It is held through a `shared_ptr` and arrays over the region use the
+  // aliasing constructor so that the mapping lives as long as any array that
+  // references it, the same way `NArrayDataBlock` works for allocated data.
+
+  class MemoryMapping
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Maps 'size' bytes of 'fd' starting at 'offset', which must be a multiple
+    // of the page size
+    MemoryMapping(int fd, std::size_t size, bool writable, off_t offset = 0)
+      : data_(nullptr)
+      , size_(size)
+    {
+      int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+      void* data = ::mmap(nullptr, size, prot, MAP_SHARED, fd, offset);
+      if (data == MAP_FAILED)
+        throw std::runtime_error(errnoMessage("mmap() failed"));
+
+      data_ = static_cast<char*>(data);
+    }
+
+    MemoryMapping(const MemoryMapping&) = delete;
+    MemoryMapping& operator= (const MemoryMapping&) = delete;
+
+    ~MemoryMapping()
+    {
+      if (data_)
+        ::munmap(data_, size_);
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESS FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    char* data() const noexcept
+    {
+      return data_;
+    }
+
+    std::size_t size() const noexcept
+    {
+      return size_;
+    }
+
+  private:
+    char* data_;
+    std::size_t size_;
+
+  }; // class MemoryMapping
+
+  // The `FileDescriptor` class closes a file descriptor when destroyed
+  class FileDescriptor
+  {
+  public:
+    explicit FileDescriptor(int fd) noexcept
+      : fd_(fd)
+    { }
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator= (const FileDescriptor&) = delete;
+
+    ~FileDescriptor()
+    {
+      if (fd_ >= 0)
+        ::close(fd_);
+    }
+
+    int get() const noexcept
+    {
+      return fd_;
+    }
+
+  private:
+    int fd_;
+
+  }; // class FileDescriptor
+
+  // Writes all 'size' bytes at 'offset', retrying short writes
+  inline void pwriteAll(int fd, const void* data, std::size_t size, off_t offset)
+  {
+    const char* ptr = static_cast<const char*>(data);
+    while (size > 0)
+    {
+      ssize_t n = ::pwrite(fd, ptr, size, offset);
+      if (n < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        throw std::runtime_error(errnoMessage("pwrite() failed"));
+      }
+      ptr += n;
+      size -= (std::size_t)n;
+      offset += n;
+    }
+  }
+
+  // Reads all 'size' bytes at 'offset', retrying short reads
+  inline void preadAll(int fd, void* data, std::size_t size, off_t offset)
+  {
+    char* ptr = static_cast<char*>(data);
+    while (size > 0)
+    {
+      ssize_t n = ::pread(fd, ptr, size, offset);
+      if (n < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        throw std::runtime_error(errnoMessage("pread() failed"));
+      }
+      if (n == 0)
+        throw std::runtime_error("pread() failed: unexpected end of file");
+      ptr += n;
+      size -= (std::size_t)n;
+      offset += n;
+    }
+  }
+
+  // Fills all the buffers in 'iov' from consecutive bytes at 'offset',
+  // retrying short reads, 'iov' is modified
+  inline void preadvAll(int fd, iovec* iov, int count, off_t offset)
+  {
+    while (count > 0)
+    {
+      ssize_t n = ::preadv(fd, iov, count, offset);
+      if (n < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        throw std::runtime_error(errnoMessage("preadv() failed"));
+      }
+      if (n == 0)
+        throw std::runtime_error("preadv() failed: unexpected end of file");
+
+      offset += n;
+      while (count > 0 && (std::size_t)n >= iov->iov_len)
+      {
+        n -= (ssize_t)iov->iov_len;
+        ++iov;
+        --count;
+      }
+      if (count > 0)
+      {
+        iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+        iov->iov_len -= (std::size_t)n;
+      }
+    }
+  }
+
+  // Writes all the buffers in 'iov' at the current file position, retrying
+  // short writes, 'iov' is modified
+  inline void writevAll(int fd, iovec* iov, int count)
+  {
+#ifdef IOV_MAX
+    const int maxCount = IOV_MAX;
+#else
+    const int maxCount = 1024;
+#endif
+    while (count > 0)
+    {
+      ssize_t n = ::writev(fd, iov, std::min(count, maxCount));
+      if (n < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        throw std::runtime_error(errnoMessage("writev() failed"));
+      }
+
+      while (count > 0 && (std::size_t)n >= iov->iov_len)
+      {
+        n -= (ssize_t)iov->iov_len;
+        ++iov;
+        --count;
+      }
+      if (count > 0)
+      {
+        iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+        iov->iov_len -= (std::size_t)n;
+      }
+    }
+  }
+
+  // Maps the whole file at 'path' read-only, throws std::runtime_error if
+  // it can't be opened or is empty
+  inline std::shared_ptr<MemoryMapping> mapFile(const std::string& path)
+  {
+    FileDescriptor file(::open(path.c_str(), O_RDONLY));
+    if (file.get() < 0)
+      throw std::runtime_error(errnoMessage("could not open '" + path + "'"));
+
+    struct stat st;
+    if (::fstat(file.get(), &st) != 0)
+      throw std::runtime_error(errnoMessage("could not stat '" + path + "'"));
+    if (st.st_size == 0)
+      throw std::runtime_error("'" + path + "' is empty");
+
+    return std::make_shared<MemoryMapping>(file.get(), (std::size_t)st.st_size, false);
+  }
+
+} // namespace detail
+
+} // namespace wilt
+
+#endif // !WILT_MAPPING_HPP
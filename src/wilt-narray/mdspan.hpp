@@ -0,0 +1,168 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: mdspan.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines conversions between NArray and std::mdspan
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_MDSPAN_HPP
+#define WILT_MDSPAN_HPP
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+// std::mdspan is used if the standard library has it, otherwise the reference
+// implementation is used if it can be found. Any other implementation can be
+// used by including it first and defining WILT_MDSPAN_NAMESPACE as its
+// namespace.
+#if defined(WILT_MDSPAN_NAMESPACE)
+#define WILT_HAS_MDSPAN
+#else
+#if __cplusplus > 202002L && __has_include(<mdspan>)
+#include <mdspan>
+#if defined(__cpp_lib_mdspan)
+#define WILT_HAS_MDSPAN
+#define WILT_MDSPAN_NAMESPACE std
+#endif
+#endif
+#if !defined(WILT_HAS_MDSPAN) && __has_include(<experimental/mdspan>)
+#include <experimental/mdspan>
+#define WILT_HAS_MDSPAN
+#define WILT_MDSPAN_NAMESPACE std::experimental
+#endif
+#endif
+
+#include "narray.hpp"
+
+#ifdef WILT_HAS_MDSPAN
+
+namespace wilt
+{
+  // The mdspan type equivalent to `NArray<T, N>`
+  template <class T, std::size_t N>
+  using NArraySpan = WILT_MDSPAN_NAMESPACE::mdspan<T, WILT_MDSPAN_NAMESPACE::dextents<pos_t, N>, WILT_MDSPAN_NAMESPACE::layout_stride>;
+
+  //! @brief         creates an mdspan over the data of an array with the
+  //!                given extents, which may have sizes fixed at compile-time
+  //! @param[in]     arr - the array to view
+  //! @return        an mdspan with `layout_stride` of the same data, sizes,
+  //!                and steps
+  //!
+  //! Throws std::invalid_argument if a fixed extent doesn't match the size of
+  //! the array or if the array has negative or zero steps, which
+  //! `layout_stride` can't represent
+  //! The mdspan doesn't keep the data alive, the array must outlive it.
+  template <class Extents, class T, std::size_t N>
+  WILT_MDSPAN_NAMESPACE::mdspan<T, Extents, WILT_MDSPAN_NAMESPACE::layout_stride> toMdspan(const NArray<T, N>& arr)
+  {
+    static_assert(Extents::rank() == N, "toMdspan<Extents>(arr): extents must have the same rank as the array");
+
+    using index_type = typename Extents::index_type;
+    using mapping_type = typename WILT_MDSPAN_NAMESPACE::layout_stride::template mapping<Extents>;
+
+    std::array<index_type, N> extents;
+    std::array<index_type, N> strides;
+    for (std::size_t i = 0; i < N; ++i)
+    {
+      if (Extents::static_extent(i) != WILT_MDSPAN_NAMESPACE::dynamic_extent && (pos_t)Extents::static_extent(i) != arr.sizes()[i])
+        throw std::invalid_argument("toMdspan<Extents>(arr): array size doesn't match the fixed extent");
+      if (!arr.empty() && arr.steps()[i] <= 0)
+        throw std::invalid_argument("toMdspan<Extents>(arr): array steps must all be positive");
+
+      extents[i] = (index_type)arr.sizes()[i];
+      strides[i] = arr.empty() ? 1 : (index_type)arr.steps()[i];
+    }
+
+    return WILT_MDSPAN_NAMESPACE::mdspan<T, Extents, WILT_MDSPAN_NAMESPACE::layout_stride>(
+      arr.data(), mapping_type(Extents(extents), strides));
+  }
+
+  //! @brief         creates an mdspan over the data of an array
+  //! @param[in]     arr - the array to view
+  //! @return        an mdspan with `layout_stride` of the same data, sizes,
+  //!                and steps
+  //!
+  //! Throws std::invalid_argument if the array has negative or zero steps
+  //! The mdspan doesn't keep the data alive, the array must outlive it.
+  template <class T, std::size_t N>
+  NArraySpan<T, N> toMdspan(const NArray<T, N>& arr)
+  {
+    return toMdspan<WILT_MDSPAN_NAMESPACE::dextents<pos_t, N>>(arr);
+  }
+
+  //! @brief         creates an array that references the data of an mdspan and
+  //!                keeps its owner alive
+  //! @param[in]     span - the mdspan to reference, its layout must be strided
+  //!                and its accessor must use plain pointers
+  //! @param[in]     owner - whatever owns the data, it is kept alive as long
+  //!                as the array or any array made from it
+  //! @return        an array of the same data, sizes, and steps
+  //!
+  //! Throws std::invalid_argument if the layout of 'span' isn't strided
+  template <class T, class Extents, class Layout, class Accessor>
+  NArray<T, Extents::rank()> fromMdspan(const WILT_MDSPAN_NAMESPACE::mdspan<T, Extents, Layout, Accessor>& span, std::shared_ptr<const void> owner)
+  {
+    constexpr std::size_t N = Extents::rank();
+    static_assert(N > 0, "fromMdspan(span): span must have at least one dimension");
+    static_assert(std::is_same<typename Accessor::data_handle_type, T*>::value, "fromMdspan(span): span accessor must use plain pointers");
+
+    if (!span.is_strided())
+      throw std::invalid_argument("fromMdspan(span): span layout must be strided");
+    if (span.size() == 0)
+      return NArray<T, N>();
+
+    Point<N> sizes;
+    Point<N> steps;
+    for (std::size_t i = 0; i < N; ++i)
+    {
+      sizes[i] = (pos_t)span.extent(i);
+      steps[i] = (pos_t)span.stride(i);
+    }
+
+    T* data = span.data_handle();
+    std::shared_ptr<T> ptr = owner ? std::shared_ptr<T>(owner, data) : std::shared_ptr<T>(data, [](T*) { });
+    return NArray<T, N>(std::move(ptr), sizes, steps);
+  }
+
+  //! @brief         creates an array that references the data of an mdspan
+  //! @param[in]     span - the mdspan to reference, its layout must be strided
+  //!                and its accessor must use plain pointers
+  //! @return        an array of the same data, sizes, and steps
+  //!
+  //! Throws std::invalid_argument if the layout of 'span' isn't strided
+  //! The array doesn't keep the data alive, the data must outlive it and any
+  //! array made from it.
+  template <class T, class Extents, class Layout, class Accessor>
+  NArray<T, Extents::rank()> fromMdspan(const WILT_MDSPAN_NAMESPACE::mdspan<T, Extents, Layout, Accessor>& span)
+  {
+    return fromMdspan(span, std::shared_ptr<const void>());
+  }
+
+} // namespace wilt
+
+#endif // WILT_HAS_MDSPAN
+
+#endif // !WILT_MDSPAN_HPP
@@ -0,0 +1,309 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: memoryregistry.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines a registry of live array data for memory accounting
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_MEMORYREGISTRY_HPP
+#define WILT_MEMORYREGISTRY_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wilt
+{
+  // A snapshot of a live data block
+  struct MemoryBlockInfo
+  {
+    const void* block;  // identifies the block, not the element data
+    std::size_t bytes;  // bytes of element data
+    std::string tag;    // the innermost 'MemoryTag' when it was created
+    std::chrono::steady_clock::time_point created;
+    long views;         // number of arrays referencing it, 0 if not shared yet
+    bool owned;         // false if it only references external data
+  };
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class keeps track of the data blocks that back arrays so that memory
+  // use can be inspected while the program is running.
+  //
+  // Data blocks are only registered if `WILT_NARRAY_MEMORY_REGISTRY` is
+  // defined before including any of the library headers, otherwise they don't
+  // touch the registry at all and it stays empty. Each block is recorded with
+  // its size, the tag active on the creating thread, its creation time, and
+  // the number of arrays still viewing it, so that large blocks kept alive by
+  // forgotten views can be found.
+  //
+  // {
+  //   MemoryTag tag("decoder");
+  //   frame = NArray<std::uint8_t, 3>({ 1080, 1920, 3 });
+  // }
+  // memoryRegistry().dump(std::cerr);
+  //
+  // NOTE: only memory allocated through `NArrayDataBlock` (the `NArray`
+  // constructors that create or copy data) is tracked, data from pools, files,
+  // or other libraries is not
+
+  class MemoryRegistry
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Returns true if data blocks are being registered
+    static constexpr bool enabled() noexcept
+    {
+#ifdef WILT_NARRAY_MEMORY_REGISTRY
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    // The bytes owned by live blocks
+    std::size_t liveBytes() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return liveBytes_;
+    }
+
+    // The number of live blocks, owned or not
+    std::size_t liveBlocks() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return blocks_.size();
+    }
+
+    // The most bytes owned at any one time since start or 'resetPeak()'
+    std::size_t peakBytes() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return peakBytes_;
+    }
+
+    // The bytes owned by all blocks ever registered
+    std::size_t totalBytes() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return totalBytes_;
+    }
+
+    // Gets the live blocks, largest first
+    std::vector<MemoryBlockInfo> blocks() const
+    {
+      std::vector<MemoryBlockInfo> ret;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ret.reserve(blocks_.size());
+        for (auto& entry : blocks_)
+        {
+          MemoryBlockInfo info;
+          info.block = entry.first;
+          info.bytes = entry.second.bytes;
+          info.tag = entry.second.tag;
+          info.created = entry.second.created;
+          info.views = entry.second.self.use_count();
+          info.owned = entry.second.owned;
+          ret.push_back(std::move(info));
+        }
+      }
+
+      std::sort(ret.begin(), ret.end(), [](const MemoryBlockInfo& lhs, const MemoryBlockInfo& rhs) {
+        return lhs.bytes > rhs.bytes;
+      });
+      return ret;
+    }
+
+    // Gets the bytes owned by live blocks for each tag, untagged blocks are
+    // under an empty tag
+    std::map<std::string, std::size_t> bytesByTag() const
+    {
+      std::map<std::string, std::size_t> ret;
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (auto& entry : blocks_)
+        if (entry.second.owned)
+          ret[entry.second.tag] += entry.second.bytes;
+      return ret;
+    }
+
+    // Writes the totals, the per-tag totals, and up to 'limit' of the largest
+    // blocks in a human readable form
+    void dump(std::ostream& out, std::size_t limit = 20) const
+    {
+      auto now = std::chrono::steady_clock::now();
+      auto list = blocks();
+
+      out << "live: " << liveBytes() << " bytes in " << list.size() << " blocks, peak: " << peakBytes() << " bytes\n";
+      for (auto& tag : bytesByTag())
+        out << "  [" << (tag.first.empty() ? "untagged" : tag.first) << "] " << tag.second << " bytes\n";
+
+      for (std::size_t i = 0; i < list.size() && i < limit; ++i)
+      {
+        auto& info = list[i];
+        auto age = std::chrono::duration_cast<std::chrono::milliseconds>(now - info.created).count();
+        out << "  " << info.block << ": " << info.bytes << " bytes, " << info.views << " views, "
+            << age << "ms old" << (info.owned ? "" : ", not owned");
+        if (!info.tag.empty())
+          out << ", tag " << info.tag;
+        out << "\n";
+      }
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // MODIFIER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Sets the peak to the current live bytes
+    void resetPeak()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      peakBytes_ = liveBytes_;
+    }
+
+    // Called by a data block when it is created, with the tag active on this
+    // thread
+    void add(const void* block, std::size_t bytes, bool owned);
+
+    // Called by a data block when it is first shared, so the views can be
+    // counted without keeping it alive
+    void attach(const void* block, std::weak_ptr<const void> self)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = blocks_.find(block);
+      if (it != blocks_.end() && it->second.self.expired())
+        it->second.self = std::move(self);
+    }
+
+    // Called by a data block when it is destroyed
+    void remove(const void* block)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = blocks_.find(block);
+      if (it == blocks_.end())
+        return;
+      if (it->second.owned)
+        liveBytes_ -= it->second.bytes;
+      blocks_.erase(it);
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    struct Entry
+    {
+      std::size_t bytes;
+      std::string tag;
+      std::chrono::steady_clock::time_point created;
+      std::weak_ptr<const void> self;
+      bool owned;
+    };
+
+    mutable std::mutex mutex_;
+    std::unordered_map<const void*, Entry> blocks_;
+    std::size_t liveBytes_ = 0;
+    std::size_t peakBytes_ = 0;
+    std::size_t totalBytes_ = 0;
+
+  }; // class MemoryRegistry
+
+  // Gets the registry shared by the library, it is never destroyed so blocks
+  // outliving static destruction can still unregister
+  inline MemoryRegistry& memoryRegistry()
+  {
+    static MemoryRegistry* registry = new MemoryRegistry();
+    return *registry;
+  }
+
+namespace detail
+{
+  inline const char*& currentMemoryTag()
+  {
+    static thread_local const char* tag = nullptr;
+    return tag;
+  }
+
+} // namespace detail
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class sets the tag recorded for data blocks created on this thread
+  // while it is in scope. Tags nest, the previous one is restored when this
+  // goes out of scope. The string must outlive the `MemoryTag`.
+
+  class MemoryTag
+  {
+  public:
+    explicit MemoryTag(const char* tag) noexcept
+      : previous_(wilt::detail::currentMemoryTag())
+    {
+      wilt::detail::currentMemoryTag() = tag;
+    }
+
+    ~MemoryTag()
+    {
+      wilt::detail::currentMemoryTag() = previous_;
+    }
+
+    MemoryTag(const MemoryTag&) = delete;
+    MemoryTag& operator= (const MemoryTag&) = delete;
+
+  private:
+    const char* previous_;
+
+  }; // class MemoryTag
+
+  inline void MemoryRegistry::add(const void* block, std::size_t bytes, bool owned)
+  {
+    const char* tag = wilt::detail::currentMemoryTag();
+
+    Entry entry;
+    entry.bytes = bytes;
+    entry.tag = tag ? tag : "";
+    entry.created = std::chrono::steady_clock::now();
+    entry.owned = owned;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    blocks_[block] = std::move(entry);
+    if (owned)
+    {
+      liveBytes_ += bytes;
+      totalBytes_ += bytes;
+      peakBytes_ = std::max(peakBytes_, liveBytes_);
+    }
+  }
+
+} // namespace wilt
+
+#endif // !WILT_MEMORYREGISTRY_HPP
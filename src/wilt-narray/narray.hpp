@@ -28,8 +28,10 @@
 #ifndef WILT_NARRAY_HPP
 #define WILT_NARRAY_HPP
 
+#include <algorithm>
 #include <cstddef>
 #include <cmath>
+#include <cstring>
 #include <initializer_list>
 #include <memory>
 #include <stdexcept>
@@ -39,6 +41,8 @@
 #include "util.hpp"
 #include "point.hpp"
 #include "narraydatablock.hpp"
+#include "trace.hpp"
+#include "diagnostics.hpp"
 
 namespace wilt
 {
@@ -48,6 +52,9 @@ namespace wilt
   // - defined below
   template <class T, std::size_t N, std::size_t M> class SubNArrays;
 
+  // - defined in "computed.hpp"
+  template <class T, std::size_t N, class Function> class ComputedArray;
+
   //////////////////////////////////////////////////////////////////////////////
   // This class is designed to access a sequence of data and to manipulate it in
   // an N-dimensional manner.
@@ -180,7 +187,7 @@ namespace wilt
     template <class Iterator>
     NArray(const Point<N>& size, Iterator first, Iterator last);
 
-    NArray(std::shared_ptr<T> data, const Point<N>& sizes) noexcept;
+    NArray(std::shared_ptr<T> data, const Point<N>& sizes);
     NArray(std::shared_ptr<T> data, const Point<N>& sizes, const Point<N>& steps) noexcept;
 
   public:
@@ -473,6 +480,11 @@ namespace wilt
     void setTo(const NArray<const T, N>& arr, const NArray<const bool, N>& mask) const;
     void setTo(const T& val, const NArray<const bool, N>& mask) const;
 
+    // Sets the data referenced to the elements of a computed array, defined in
+    // "computed.hpp"
+    template <class U, class Function>
+    void setTo(const ComputedArray<U, N, Function>& arr) const;
+
     // Clears the array by dropping its reference to the data, destructing it if
     // it was the last reference.
     void clear() noexcept;
@@ -485,6 +497,9 @@ namespace wilt
     template <class U, std::size_t M>
     friend class NArray;
 
+    template <class U, std::size_t A, std::size_t B>
+    friend class NArrayIterator;
+
   private:
     ////////////////////////////////////////////////////////////////////////////
     // PRIVATE FUNCTIONS
@@ -563,8 +578,11 @@ namespace wilt
   //!                T(U, V) or similar
   //! @return        the destination array
   template <class T, class U, class V, std::size_t N, class Operator>
-  NArray<T, N> binaryOp(const NArray<U, N>& src1, const NArray<V, N>& src2, Operator op)
+  WILT_DIAGNOSTIC_NOINLINE NArray<T, N> binaryOp(const NArray<U, N>& src1, const NArray<V, N>& src2, Operator op)
   {
+    WILT_DIAGNOSTIC_ENTRY();
+    WILT_TRACE_SCOPE("binaryOp", src1.sizes(), (std::size_t)src1.size() * (sizeof(T) + sizeof(U) + sizeof(V)));
+    WILT_DIAGNOSE(wilt::detail::stridedInner(src1) || wilt::detail::stridedInner(src2), STRIDED_INNER, 1);
     NArray<T, N> ret(src1.sizes());
     wilt::detail::ternary<N>(ret.sizes().data(), 
       ret.data(), ret.steps().data(),
@@ -582,8 +600,11 @@ namespace wilt
   //! @param[in]     op - function or function object with the signature 
   //!                (T&, U, V) or similar
   template <class T, class U, class V, std::size_t N, class Operator>
-  void binaryOp(NArray<T, N>& dst, const NArray<U, N>& src1, const NArray<V, N>& src2, Operator op)
+  WILT_DIAGNOSTIC_NOINLINE void binaryOp(NArray<T, N>& dst, const NArray<U, N>& src1, const NArray<V, N>& src2, Operator op)
   {
+    WILT_DIAGNOSTIC_ENTRY();
+    WILT_TRACE_SCOPE("binaryOp", dst.sizes(), (std::size_t)dst.size() * (sizeof(T) + sizeof(U) + sizeof(V)));
+    WILT_DIAGNOSE(wilt::detail::stridedInner(dst) || wilt::detail::stridedInner(src1) || wilt::detail::stridedInner(src2), STRIDED_INNER, 1);
     wilt::detail::ternary<N>(dst.sizes().data(), 
       dst.data(), dst.steps().data(), 
       src1.data(), src1.steps().data(), 
@@ -597,8 +618,11 @@ namespace wilt
   //!                T(U) or similar
   //! @return        the destination array
   template <class T, class U, std::size_t N, class Operator>
-  NArray<T, N> unaryOp(const NArray<U, N>& src, Operator op)
+  WILT_DIAGNOSTIC_NOINLINE NArray<T, N> unaryOp(const NArray<U, N>& src, Operator op)
   {
+    WILT_DIAGNOSTIC_ENTRY();
+    WILT_TRACE_SCOPE("unaryOp", src.sizes(), (std::size_t)src.size() * (sizeof(T) + sizeof(U)));
+    WILT_DIAGNOSE(wilt::detail::stridedInner(src), STRIDED_INNER, 1);
     NArray<T, N> ret(src.sizes());
     wilt::detail::binary<N>(ret.sizes().data(), 
       ret.data(), ret.steps().data(), 
@@ -614,16 +638,98 @@ namespace wilt
   //! @param[in]     op - function or function object with the signature 
   //!                (T&, U) or similar
   template <class T, class U, std::size_t N, class Operator>
-  void unaryOp(NArray<T, N>& dst, const NArray<U, N>& src, Operator op)
+  WILT_DIAGNOSTIC_NOINLINE void unaryOp(NArray<T, N>& dst, const NArray<U, N>& src, Operator op)
   {
+    WILT_DIAGNOSTIC_ENTRY();
+    WILT_TRACE_SCOPE("unaryOp", dst.sizes(), (std::size_t)dst.size() * (sizeof(T) + sizeof(U)));
+    WILT_DIAGNOSE(wilt::detail::stridedInner(dst) || wilt::detail::stridedInner(src), STRIDED_INNER, 1);
     wilt::detail::binary<N>(dst.sizes().data(), 
       dst.data(), dst.steps().data(), 
       src.data(), src.steps().data(), 
       op);
   }
 
+  //! @brief         combines all elements of a source array, in order, into a
+  //!                single value
+  //! @param[in]     src - source array
+  //! @param[in]     init - the initial value
+  //! @param[in]     op - function or function object with the signature
+  //!                U(U, T) or similar
+  //! @return        the combined value, or 'init' if the array is empty
+  template <class T, std::size_t N, class U, class Operator>
+  U reduce(const NArray<T, N>& src, U init, Operator op)
+  {
+    if (src.empty())
+      return init;
+
+    WILT_TRACE_SCOPE("reduce", src.sizes(), (std::size_t)src.size() * sizeof(T));
+    wilt::detail::unary<N>(src.sizes().data(),
+      src.data(), src.steps().data(),
+      [&init, &op](const T& t) { init = op(std::move(init), t); });
+    return init;
+  }
+
 namespace detail
 {
+  //! @brief      Copies a range of elements, in row-major order, into a
+  //!             contiguous buffer
+  //! @param[in]  arr - the array to copy from
+  //! @param[in]  first - the row-major index of the first element to copy
+  //! @param[in]  count - the number of elements to copy
+  //! @param[out] dst - the buffer to copy to, must hold 'count' elements
+  //!
+  //! The copy is done a row at a time so rows with a unit step are a single
+  //! memcpy, rows with large steps are prefetched ahead
+  //! The range must be within the array
+  template <class T, std::size_t N>
+  void packElements(const NArray<T, N>& arr, std::size_t first, std::size_t count, typename std::remove_const<T>::type* dst)
+  {
+    const Point<N>& sizes = arr.sizes();
+    const Point<N>& steps = arr.steps();
+
+    Point<N> pos;
+    for (std::size_t i = N; i > 0; --i)
+    {
+      pos[i-1] = (pos_t)(first % (std::size_t)sizes[i-1]);
+      first /= (std::size_t)sizes[i-1];
+    }
+
+    while (count > 0)
+    {
+      const T* row = arr.data();
+      for (std::size_t i = 0; i < N; ++i)
+        row += pos[i] * steps[i];
+
+      std::size_t length = std::min((std::size_t)(sizes[N-1] - pos[N-1]), count);
+      if (steps[N-1] == 1)
+        std::memcpy(dst, row, length * sizeof(T));
+      else
+      {
+        const pos_t step = steps[N-1];
+        const std::size_t ahead = (std::size_t)prefetchDistance(step * (pos_t)sizeof(T), (pos_t)length);
+        std::size_t j = 0;
+        for (; j + ahead < length && ahead > 0; ++j)
+        {
+          prefetch(row + (pos_t)(j + ahead) * step);
+          dst[j] = row[(pos_t)j * step];
+        }
+        for (; j < length; ++j)
+          dst[j] = row[(pos_t)j * step];
+      }
+
+      dst += length;
+      count -= length;
+
+      pos[N-1] = 0;
+      for (std::size_t i = N - 1; i > 0; --i)
+      {
+        if (++pos[i-1] < sizes[i-1])
+          break;
+        pos[i-1] = 0;
+      }
+    }
+  }
+
   //! @brief      Creates a step array from a dim array
   //! @param[in]  sizes - the dimension array as a point
   //! @return     step array created from sizes as a point
@@ -744,33 +850,43 @@ namespace detail
   //! @param[in,out] step2 - step array as a point that relates to another
   //!                NArray, must be aligned and related to the same dimension
   //!                array
-  //! @return        the dimension of the arrays after condensing, values at or
-  //!                after n in the arrays are junk
+  //! @return        the dimension of the arrays after condensing, the
+  //!                condensed values are at the end of the arrays
   //!
   //! Is used when applying operations on arrays to effectively reduce the
   //! dimensionality of the data which will reduce loops and function calls.
   //! Condensing the dim and step arrays from an aligned and continuous NArray
-  //! should result in return=1, sizes=size(sizes), step1={1}, step2={1}
+  //! should result in return=1, sizes={1, ..., size(sizes)}, step1={..., 1},
+  //! step2={..., 1}, the leading dimensions are filled with size 1 so the
+  //! arrays can still be traversed as N-dimensional
   //! Dimension array should all be positive and non-zero and step arrays must 
   //! be valid to produce a meaningful result
   template <std::size_t N>
   std::size_t condense(Point<N>& sizes, Point<N>& step1, Point<N>& step2) noexcept
   {
-    std::size_t j = 0;
-    for (std::size_t i = 1; i < N; ++i)
+    std::size_t j = N-1;
+    for (std::size_t i = N-1; i > 0; --i)
     {
-      if (sizes[i] * step1[i] == step1[i-1])
-        sizes[j] *= sizes[i];
+      if (step1[j] * sizes[j] == step1[i-1] && step2[j] * sizes[j] == step2[i-1])
+      {
+        sizes[j] *= sizes[i-1];
+      }
       else
       {
+        --j;
+        sizes[j] = sizes[i-1];
         step1[j] = step1[i-1];
         step2[j] = step2[i-1];
-        sizes[++j] = sizes[i];
       }
     }
-    step1[j] = step1[N-1];
-    step2[j] = step2[N-1];
-    return j+1;
+    for (std::size_t i = 0; i < j; ++i)
+    {
+      sizes[i] = 1;
+      step1[i] = 1;
+      step2[i] = 1;
+    }
+
+    return N - j;
   }
 
 } // namespace detail
@@ -926,16 +1042,16 @@ namespace detail
   }
 
   template <class T, std::size_t N>
-  NArray<T, N>::NArray(std::shared_ptr<T> data, const Point<N>& sizes) noexcept
+  NArray<T, N>::NArray(std::shared_ptr<T> data, const Point<N>& sizes)
     : data_(std::move(data))
     , sizes_()
     , steps_()
   {
-    if (!wilt::detail::validSize(size))
-      throw std::invalid_argument("NArray(data, size): size is not valid");
+    if (!wilt::detail::validSize(sizes))
+      throw std::invalid_argument("NArray(data, sizes): sizes is not valid");
 
-    sizes_ = size;
-    steps_ = wilt::detail::step(size);
+    sizes_ = sizes;
+    steps_ = wilt::detail::step(sizes);
   }
 
   template <class T, std::size_t N>
@@ -1007,6 +1123,7 @@ namespace detail
     if (empty())
       return *this;
 
+    WILT_TRACE_SCOPE("operator+=", sizes_, (std::size_t)size() * sizeof(T) * 3);
     wilt::detail::binary<N>(sizes_.data(), 
           data_.get(),     steps_.data(), 
       arr.data_.get(), arr.steps_.data(), 
@@ -1023,6 +1140,7 @@ namespace detail
     if (empty())
       return *this;
 
+    WILT_TRACE_SCOPE("operator+=", sizes_, (std::size_t)size() * sizeof(T) * 2);
     wilt::detail::unary<N>(sizes_.data(), data_.get(), steps_.data(), [&val](T& lhs) {lhs += val; });
 
     return *this;
@@ -1038,6 +1156,7 @@ namespace detail
     if (empty())
       return *this;
 
+    WILT_TRACE_SCOPE("operator-=", sizes_, (std::size_t)size() * sizeof(T) * 3);
     wilt::detail::binary<N>(sizes_.data(), 
           data_.get(),     steps_.data(), 
       arr.data_.get(), arr.steps_.data(), 
@@ -1054,6 +1173,7 @@ namespace detail
     if (empty())
       return *this;
 
+    WILT_TRACE_SCOPE("operator-=", sizes_, (std::size_t)size() * sizeof(T) * 2);
     wilt::detail::unary<N>(sizes_.data(), data_.get(), steps_.data(), [&val](T& lhs) {lhs -= val; });
 
     return *this;
@@ -1067,6 +1187,7 @@ namespace detail
     if (empty())
       return *this;
 
+    WILT_TRACE_SCOPE("operator*=", sizes_, (std::size_t)size() * sizeof(T) * 2);
     wilt::detail::unary<N>(sizes_.data(), data_.get(), steps_.data(), [&val](T& lhs) {lhs *= val; });
 
     return *this;
@@ -1080,6 +1201,7 @@ namespace detail
     if (empty())
       return *this;
 
+    WILT_TRACE_SCOPE("operator/=", sizes_, (std::size_t)size() * sizeof(T) * 2);
     wilt::detail::unary<N>(sizes_.data(), data_.get(), steps_.data(), [&val](T& lhs) {lhs /= val; });
 
     return *this;
@@ -1168,7 +1290,7 @@ namespace detail
     for (std::size_t i = 0; i < N; ++i)
       stepSize += steps_[i] * (sizes_[i] - 1);
 
-    return stepSize + 1 == this->size();
+    return stepSize + 1 == (pos_t)this->size();
   }
 
   template <class T, std::size_t N>
@@ -1244,8 +1366,10 @@ namespace detail
   }
 
   template <class T, std::size_t N>
-  typename NArray<T, N>::iterator NArray<T, N>::begin() const
+  WILT_DIAGNOSTIC_NOINLINE typename NArray<T, N>::iterator NArray<T, N>::begin() const
   {
+    WILT_DIAGNOSTIC_ENTRY();
+    WILT_DIAGNOSE(!empty() && !isAligned(), ITERATE_UNALIGNED, 1);
     return iterator(*this);
   }
 
@@ -1258,8 +1382,10 @@ namespace detail
   }
 
   template <class T, std::size_t N>
-  typename NArray<T, N>::const_iterator NArray<T, N>::cbegin() const
+  WILT_DIAGNOSTIC_NOINLINE typename NArray<T, N>::const_iterator NArray<T, N>::cbegin() const
   {
+    WILT_DIAGNOSTIC_ENTRY();
+    WILT_DIAGNOSE(!empty() && !isAligned(), ITERATE_UNALIGNED, 1);
     return const_iterator(*this);
   }
 
@@ -1285,11 +1411,13 @@ namespace detail
   }
 
   template <class T, std::size_t N>
-  typename NArray<T, N-1>::exposed_type NArray<T, N>::operator[] (pos_t n) const
+  WILT_DIAGNOSTIC_NOINLINE typename NArray<T, N-1>::exposed_type NArray<T, N>::operator[] (pos_t n) const
   {
+    WILT_DIAGNOSTIC_ENTRY();
     if (n < 0 || n >= sizes_[0])
       throw std::out_of_range("operator[](): n out of bounds");
 
+    WILT_DIAGNOSE(N > 1, BRACKET_TEMPORARY, 1);
     return slice_(0, n);
   }
 
@@ -1804,18 +1932,24 @@ namespace detail
   }
 
   template <class T, std::size_t N>
-  NArray<typename std::remove_const<T>::type, N> NArray<T, N>::clone() const
+  WILT_DIAGNOSTIC_NOINLINE NArray<typename std::remove_const<T>::type, N> NArray<T, N>::clone() const
   {
+    WILT_DIAGNOSTIC_ENTRY();
     if (empty())
       return NArray<typename std::remove_const<T>::type, N>();
 
-    return NArray<typename std::remove_const<T>::type, N>(sizes_, [iter = this->begin()]() mutable -> T& { return *iter++; });
+    WILT_TRACE_SCOPE("clone", sizes_, (std::size_t)size() * sizeof(T) * 2);
+    WILT_DIAGNOSE(!isAligned(), CLONE_UNALIGNED, 1);
+    // the iterator is made directly rather than with 'begin()' so the slow
+    // path is only reported once
+    return NArray<typename std::remove_const<T>::type, N>(sizes_, [iter = iterator(*this)]() mutable -> T& { return *iter++; });
   }
 
   template <class T, std::size_t N>
   template <class U>
-  NArray<U, N> NArray<T, N>::convertTo() const
+  WILT_DIAGNOSTIC_NOINLINE NArray<U, N> NArray<T, N>::convertTo() const
   {
+    WILT_DIAGNOSTIC_ENTRY();
     NArray<U, N> ret(sizes_);
     convertTo_(*this, ret, [](const T& t) {return static_cast<U>(t); });
     return ret;
@@ -1823,8 +1957,9 @@ namespace detail
 
   template <class T, std::size_t N>
   template <class U, class Converter>
-  NArray<U, N> NArray<T, N>::convertTo(Converter func) const
+  WILT_DIAGNOSTIC_NOINLINE NArray<U, N> NArray<T, N>::convertTo(Converter func) const
   {
+    WILT_DIAGNOSTIC_ENTRY();
     NArray<U, N> ret(sizes_);
     convertTo_(*this, ret, func);
     return ret;
@@ -1832,8 +1967,9 @@ namespace detail
 
   template<class T, std::size_t N>
   template<std::size_t M, class Compressor>
-  NArray<T, M> NArray<T, N>::compress(Compressor func) const
+  WILT_DIAGNOSTIC_NOINLINE NArray<T, M> NArray<T, N>::compress(Compressor func) const
   {
+    WILT_DIAGNOSTIC_ENTRY();
     static_assert(M <= N, "compress(func): invalid when M > N");
     static_assert(M != 0, "compress(func): invalid when M is zero");
 
@@ -1841,6 +1977,7 @@ namespace detail
       return NArray<T, M>();
 
     NArray<T, M> ret(sizes_.template high<M>());
+    WILT_DIAGNOSE(M < N, COMPRESS_TEMPORARIES, (std::size_t)ret.size());
 
     auto dstIt = ret.begin();
     for (auto&& val : subarrays<N-M>())
@@ -1853,6 +1990,8 @@ namespace detail
   template <class U, class Converter>
   void NArray<T, N>::convertTo_(const wilt::NArray<T, N>& lhs, wilt::NArray<U, N>& rhs, Converter func)
   {
+    WILT_TRACE_SCOPE("convertTo", lhs.sizes(), (std::size_t)lhs.size() * (sizeof(T) + sizeof(U)));
+    WILT_DIAGNOSE(wilt::detail::stridedInner(lhs), STRIDED_INNER, 1);
     Point<N> sizes = lhs.sizes();
     Point<N> step1 = lhs.steps();
     Point<N> step2 = rhs.steps();
@@ -1864,13 +2003,16 @@ namespace detail
   }
 
   template <class T, std::size_t N>
-  void NArray<T, N>::setTo(const NArray<const T, N>& arr) const
+  WILT_DIAGNOSTIC_NOINLINE void NArray<T, N>::setTo(const NArray<const T, N>& arr) const
   {
+    WILT_DIAGNOSTIC_ENTRY();
     static_assert(!std::is_const<T>::value, "setTo(arr): invalid when element type is const");
 
     if (sizes_ != arr.sizes())
       throw std::invalid_argument("setTo(arr): dimensions must match");
 
+    WILT_TRACE_SCOPE("setTo", sizes_, (std::size_t)size() * sizeof(T) * 2);
+    WILT_DIAGNOSE(wilt::detail::stridedInner(*this) || wilt::detail::stridedInner(arr), STRIDED_INNER, 1);
     wilt::detail::binary<N>(sizes_.data(), 
           data_.get(),     steps_.data(), 
       arr.data_.get(), arr.steps_.data(),
@@ -1882,6 +2024,7 @@ namespace detail
   {
     static_assert(!std::is_const<T>::value, "setTo(val): invalid when element type is const");
 
+    WILT_TRACE_SCOPE("setTo", sizes_, (std::size_t)size() * sizeof(T));
     wilt::detail::unary<N>(sizes_.data(), data_.get(), steps_.data(), [&val](T& r) { r = val; });
   }
 
@@ -1893,6 +2036,7 @@ namespace detail
     if (sizes_ != arr.sizes() || sizes_ != mask.sizes())
       throw std::invalid_argument("setTo(arr, mask): dimensions must match");
 
+    WILT_TRACE_SCOPE("setTo", sizes_, (std::size_t)size() * (sizeof(T) * 2 + sizeof(bool)));
     wilt::detail::ternary<N>(sizes_.data(), 
            data_.get(),      steps_.data(), 
        arr.data_.get(),  arr.steps_.data(), 
@@ -1905,6 +2049,7 @@ namespace detail
   {
     static_assert(!std::is_const<T>::value, "setTo(val, mask): invalid when element type is const");
 
+    WILT_TRACE_SCOPE("setTo", sizes_, (std::size_t)size() * (sizeof(T) + sizeof(bool)));
     wilt::detail::binary<N>(sizes_.data(), 
            data_.get(),      steps_.data(), 
       mask.data_.get(), mask.steps_.data(),
@@ -1924,4 +2069,8 @@ namespace detail
 #include "narrayiterator.hpp"
 #include "operators.hpp"
 
+#ifdef WILT_NARRAY_EXTERN_TEMPLATES
+#include "narrayinstances.hpp"
+#endif
+
 #endif // !WILT_NARRAY_HPP
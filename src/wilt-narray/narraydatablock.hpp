@@ -32,6 +32,12 @@
 #include <cstddef>
 #include <type_traits>
 
+#include "trace.hpp"
+
+#ifdef WILT_NARRAY_MEMORY_REGISTRY
+#include "memoryregistry.hpp"
+#endif
+
 namespace wilt
 {
   enum NArrayDataAcquireType
@@ -67,7 +73,7 @@ namespace detail
         alloc_(),
         owned_(true)
     {
-
+      track_();
     }
 
     NArrayDataBlock(std::size_t size)
@@ -76,10 +82,12 @@ namespace detail
         alloc_(),
         owned_(true)
     {
+      WILT_TRACE_SCOPE("allocate", size * sizeof(T));
       data_ = std::allocator_traits<A>::allocate(alloc_, size);
       if (!std::is_trivially_default_constructible<T>::value)
         for (std::size_t i = 0; i < size; ++i)
           std::allocator_traits<A>::construct(alloc_, data_ + i);
+      track_();
     }
 
     NArrayDataBlock(std::size_t size, const T& val)
@@ -88,9 +96,11 @@ namespace detail
         alloc_(),
         owned_(true)
     {
+      WILT_TRACE_SCOPE("allocate", size * sizeof(T));
       data_ = std::allocator_traits<A>::allocate(alloc_, size);
       for (std::size_t i = 0; i < size; ++i)
         std::allocator_traits<A>::construct(alloc_, data_ + i, val);
+      track_();
     }
 
     NArrayDataBlock(std::size_t size, T* data, NArrayDataAcquireType atype)
@@ -105,15 +115,19 @@ namespace detail
         data_ = data;
         break;
       case wilt::COPY:
+      {
+        WILT_TRACE_SCOPE("allocate", size * sizeof(T));
         data_ = std::allocator_traits<A>::allocate(alloc_, size);
         for (size_t i = 0; i < size; ++i)
           std::allocator_traits<A>::construct(alloc_, data_ + i, data[i]);
         break;
+      }
       case wilt::REFERENCE:
         data_ = data;
         owned_ = false;
         break;
       }
+      track_();
     }
 
     template <class Generator>
@@ -123,9 +137,11 @@ namespace detail
         alloc_(),
         owned_(true)
     {
+      WILT_TRACE_SCOPE("allocate", size * sizeof(T));
       data_ = std::allocator_traits<A>::allocate(alloc_, size);
       for (std::size_t i = 0; i < size; ++i)
         std::allocator_traits<A>::construct(alloc_, data_ + i, gen());
+      track_();
     }
 
     template <class Iterator>
@@ -135,6 +151,7 @@ namespace detail
         alloc_(),
         owned_(true)
     {
+      WILT_TRACE_SCOPE("allocate", size * sizeof(T));
       data_ = std::allocator_traits<A>::allocate(alloc_, size);
 
       std::size_t i = 0;
@@ -144,10 +161,14 @@ namespace detail
       if (i != size)
         for (; i < size; ++i)
           std::allocator_traits<A>::construct(alloc_, data_ + i);
+      track_();
     }
 
     ~NArrayDataBlock()
     {
+#ifdef WILT_NARRAY_MEMORY_REGISTRY
+      wilt::memoryRegistry().remove(this);
+#endif
       if (data_ && owned_)
       {
         if (!std::is_trivially_destructible<T>::value)
@@ -164,7 +185,25 @@ namespace detail
 
     std::shared_ptr<T> data() const
     {
-      return std::shared_ptr<T>(this->shared_from_this(), data_);
+      auto self = this->shared_from_this();
+#ifdef WILT_NARRAY_MEMORY_REGISTRY
+      wilt::memoryRegistry().attach(this, self);
+#endif
+      return std::shared_ptr<T>(self, data_);
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // registers the block once it is constructed, does nothing unless the
+    // registry is enabled
+    void track_()
+    {
+#ifdef WILT_NARRAY_MEMORY_REGISTRY
+      wilt::memoryRegistry().add(this, size_ * sizeof(T), owned_);
+#endif
     }
 
   }; // class NArrayDataBlock
@@ -0,0 +1,150 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: narrayinstances.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Declares the precompiled NArray instantiations
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_NARRAYINSTANCES_HPP
+#define WILT_NARRAYINSTANCES_HPP
+
+#include <cstdint>
+#include <utility>
+
+#include "narray.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+// The library is header-only, so every translation unit that uses an
+// 'NArray<float, 2>' compiles all of it again and the linker throws away the
+// copies. For large projects, the common instantiations can instead be
+// compiled once in "narrayinstances.cpp":
+//
+//  - add "narrayinstances.cpp" to the build as a separate library or object
+//  - define WILT_NARRAY_EXTERN_TEMPLATES for every file that includes
+//    "narray.hpp", so this header is included and the instantiations below
+//    are declared 'extern' and not compiled there
+//
+// The element types are uint8_t, uint16_t, int32_t, float and double with 1
+// to 4 dimensions. It covers the constructors, transformations, 'clone()',
+// 'setTo()', the compound assignments, the data blocks, and the +, -, *, and
+// / operators between arrays of the same type and with a scalar of the same
+// type. Small accessors and the iterators are left to the headers since an
+// extern member can't be inlined. Member templates like 'foreach()' and
+// other types or dimensions are compiled as usual where they're used.
+//
+// NOTE: the component must be compiled with the same WILT_* configuration
+// macros and compatible compiler flags as the files using it
+
+// Calls 'X(T)' for every precompiled element type
+#define WILT_NARRAY_FOR_EACH_TYPE(X) \
+  X(std::uint8_t) X(std::uint16_t) X(std::int32_t) X(float) X(double)
+
+// The members that exist for all dimensions, the small accessors like 'at()'
+// and 'data()' are left out so they can still be inlined
+#define WILT_NARRAY_MEMBERS(PREFIX, T, N)                                                                     \
+  PREFIX template NArray<T, N>::NArray(const Point<N>&);                                                      \
+  PREFIX template NArray<T, N>::NArray(const Point<N>&, T*, NArrayDataAcquireType);                           \
+  PREFIX template NArray<T, N>::NArray(std::shared_ptr<T>, const Point<N>&);                                  \
+  PREFIX template NArray<T, N>& NArray<T, N>::operator+= (const NArray<const T, N>&);                         \
+  PREFIX template NArray<T, N>& NArray<T, N>::operator-= (const NArray<const T, N>&);                         \
+  PREFIX template NArray<T, N>& NArray<T, N>::operator+= (const T&);                                          \
+  PREFIX template NArray<T, N>& NArray<T, N>::operator-= (const T&);                                          \
+  PREFIX template NArray<T, N>& NArray<T, N>::operator*= (const T&);                                          \
+  PREFIX template NArray<T, N>& NArray<T, N>::operator/= (const T&);                                          \
+  PREFIX template bool NArray<T, N>::isContiguous() const noexcept;                                           \
+  PREFIX template bool NArray<T, N>::isAligned() const noexcept;                                              \
+  PREFIX template typename NArray<T, N-1>::exposed_type NArray<T, N>::slice(std::size_t, pos_t) const;        \
+  PREFIX template NArray<T, N> NArray<T, N>::range(std::size_t, pos_t, pos_t) const;                          \
+  PREFIX template NArray<T, N> NArray<T, N>::rangeX(pos_t, pos_t) const;                                      \
+  PREFIX template NArray<T, N> NArray<T, N>::flip(std::size_t) const;                                         \
+  PREFIX template NArray<T, N> NArray<T, N>::flipX() const;                                                   \
+  PREFIX template NArray<T, N> NArray<T, N>::skip(std::size_t, pos_t, pos_t) const;                           \
+  PREFIX template NArray<T, N> NArray<T, N>::skipX(pos_t, pos_t) const;                                       \
+  PREFIX template NArray<T, N> NArray<T, N>::transpose(std::size_t, std::size_t) const;                       \
+  PREFIX template NArray<T, N> NArray<T, N>::subarray(const Point<N>&, const Point<N>&) const;                \
+  PREFIX template NArray<T, N+1> NArray<T, N>::repeat(pos_t) const;                                           \
+  PREFIX template NArray<T, N+1> NArray<T, N>::window(std::size_t, pos_t) const;                              \
+  PREFIX template NArray<T, N+1> NArray<T, N>::windowX(pos_t) const;                                          \
+  PREFIX template NArray<T, N> NArray<T, N>::asAligned() const noexcept;                                      \
+  PREFIX template NArray<T, N> NArray<T, N>::asCondensed() const noexcept;                                    \
+  PREFIX template NArray<T, N> NArray<T, N>::clone() const;                                                   \
+  PREFIX template void NArray<T, N>::setTo(const NArray<const T, N>&) const;                                  \
+  PREFIX template void NArray<T, N>::setTo(const T&) const;                                                   \
+  PREFIX template void NArray<T, N>::setTo(const NArray<const T, N>&, const NArray<const bool, N>&) const;    \
+  PREFIX template void NArray<T, N>::setTo(const T&, const NArray<const bool, N>&) const;                     \
+  WILT_NARRAY_OPERATORS(PREFIX, T, N, +)                                                                      \
+  WILT_NARRAY_OPERATORS(PREFIX, T, N, -)                                                                      \
+  WILT_NARRAY_OPERATORS(PREFIX, T, N, *)                                                                      \
+  WILT_NARRAY_OPERATORS(PREFIX, T, N, /)
+
+// The members that need at least 2, 3, or 4 dimensions
+#define WILT_NARRAY_MEMBERS_Y(PREFIX, T, N)                                   \
+  PREFIX template NArray<T, N-1> NArray<T, N>::sliceY(pos_t) const;           \
+  PREFIX template NArray<T, N> NArray<T, N>::rangeY(pos_t, pos_t) const;      \
+  PREFIX template NArray<T, N> NArray<T, N>::flipY() const;                   \
+  PREFIX template NArray<T, N> NArray<T, N>::skipY(pos_t, pos_t) const;       \
+  PREFIX template NArray<T, N> NArray<T, N>::transpose() const;               \
+  PREFIX template NArray<T, N+1> NArray<T, N>::windowY(pos_t) const;
+
+#define WILT_NARRAY_MEMBERS_Z(PREFIX, T, N)                                   \
+  PREFIX template NArray<T, N-1> NArray<T, N>::sliceZ(pos_t) const;           \
+  PREFIX template NArray<T, N> NArray<T, N>::rangeZ(pos_t, pos_t) const;      \
+  PREFIX template NArray<T, N> NArray<T, N>::flipZ() const;                   \
+  PREFIX template NArray<T, N> NArray<T, N>::skipZ(pos_t, pos_t) const;       \
+  PREFIX template NArray<T, N+1> NArray<T, N>::windowZ(pos_t) const;
+
+#define WILT_NARRAY_MEMBERS_W(PREFIX, T, N)                                   \
+  PREFIX template NArray<T, N-1> NArray<T, N>::sliceW(pos_t) const;           \
+  PREFIX template NArray<T, N> NArray<T, N>::rangeW(pos_t, pos_t) const;      \
+  PREFIX template NArray<T, N> NArray<T, N>::flipW() const;                   \
+  PREFIX template NArray<T, N> NArray<T, N>::skipW(pos_t, pos_t) const;       \
+  PREFIX template NArray<T, N+1> NArray<T, N>::windowW(pos_t) const;
+
+// The operators between arrays of the same type and with a scalar
+#define WILT_NARRAY_OPERATORS(PREFIX, T, N, OP)                                                      \
+  PREFIX template NArray<decltype(std::declval<T>() OP std::declval<T>()), N>                        \
+    operator OP (const NArray<T, N>&, const NArray<T, N>&);                                          \
+  PREFIX template NArray<decltype(std::declval<T>() OP std::declval<T>()), N>                        \
+    operator OP (const NArray<T, N>&, const T&);
+
+// Declares ('PREFIX' is extern) or defines ('PREFIX' is empty) all the
+// instantiations for one element type
+#define WILT_NARRAY_INSTANCES(PREFIX, T)                                                                           \
+  PREFIX template class detail::NArrayDataBlock<T>;                                                                \
+  WILT_NARRAY_MEMBERS(PREFIX, T, 1)                                                                                \
+  WILT_NARRAY_MEMBERS(PREFIX, T, 2) WILT_NARRAY_MEMBERS_Y(PREFIX, T, 2)                                            \
+  WILT_NARRAY_MEMBERS(PREFIX, T, 3) WILT_NARRAY_MEMBERS_Y(PREFIX, T, 3) WILT_NARRAY_MEMBERS_Z(PREFIX, T, 3)        \
+  WILT_NARRAY_MEMBERS(PREFIX, T, 4) WILT_NARRAY_MEMBERS_Y(PREFIX, T, 4) WILT_NARRAY_MEMBERS_Z(PREFIX, T, 4)        \
+    WILT_NARRAY_MEMBERS_W(PREFIX, T, 4)
+
+#define WILT_NARRAY_EXTERN_INSTANCES(T) WILT_NARRAY_INSTANCES(extern, T)
+
+namespace wilt
+{
+  WILT_NARRAY_FOR_EACH_TYPE(WILT_NARRAY_EXTERN_INSTANCES)
+
+} // namespace wilt
+
+#undef WILT_NARRAY_EXTERN_INSTANCES
+
+#endif // !WILT_NARRAYINSTANCES_HPP
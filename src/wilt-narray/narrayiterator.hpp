@@ -28,9 +28,11 @@
 #ifndef WILT_NARRAYITERATOR_HPP
 #define WILT_NARRAYITERATOR_HPP
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <iterator>
+#include <memory>
 #include <type_traits>
 
 #include "util.hpp"
@@ -43,11 +45,14 @@ namespace wilt
 
 namespace detail
 {
+  // - defined in "narray.hpp"
+  template <std::size_t N> pos_t size(const Point<N>& size) noexcept;
+
   // - defined below
-  template <std::size_t N> void addValueToPosition(Point<N>& pos, const pos_t* sizes, pos_t value);
   template <std::size_t N> void addOneToPosition(Point<N>& pos, const pos_t* sizes);
-  template <std::size_t N> void subValueFromPosition(Point<N>& pos, const pos_t* sizes, pos_t value);
   template <std::size_t N> void subOneFromPosition(Point<N>& pos, const pos_t* sizes);
+  template <std::size_t N> Point<N> indexToPosition(pos_t index, const Point<N>& sizes);
+  template <std::size_t N> pos_t positionToIndex(const Point<N>& pos, const Point<N>& sizes);
 
 } // namespace detail
 
@@ -55,9 +60,14 @@ namespace detail
   // This class is designed to iterate through all elements or subarrays of an
   // `NArray`.
   //
-  // This class works by keeping the point that its currently referencing and
-  // uses its reference to the array to get the element or subarray. It also
-  // provides the functions required to make it a "random access" iterator.
+  // This class works by keeping the linear index of the element it is
+  // currently referencing, so that random access (`+=`, `-`, `[]`, and the
+  // comparisons) is a constant-time integer operation. If the iterated
+  // dimensions collapse into a single run of equally spaced elements (like a
+  // row-major array or any 1D view), the element address is computed straight
+  // from that index. Otherwise the iterator also keeps the point of the current
+  // position and carries it along on increments, only falling back to
+  // recomputing it when jumping out of the innermost row.
   //
   // The template parameters `T` and `N` correspond to the `NArray` that is
   // being iterated over, but the parameter `M` is the dimensionality of the
@@ -68,6 +78,10 @@ namespace detail
   // implementation can satisfy both the normal `begin()` and `end()` iterations
   // as well as those returned by `subarrays<M>()` since almost all the logic is
   // the same.
+  //
+  // The iterator also exposes its innermost row as a "segment" so algorithms
+  // can work on whole runs at a time instead of element by element, see
+  // `segmentSize()`, `segmentStep()`, and `forEachSegment()` below.
 
   template <class T, std::size_t N, std::size_t M>
   class NArrayIterator
@@ -85,10 +99,10 @@ namespace detail
     ////////////////////////////////////////////////////////////////////////////
 
     using iterator_category = std::random_access_iterator_tag;
-    using value_type = typename NArray<T, M>::exposed_type;
+    using value_type = typename std::remove_cv<typename std::remove_reference<typename NArray<T, M>::exposed_type>::type>::type;
     using difference_type = std::ptrdiff_t;
-    using pointer = std::remove_reference<value_type>*;
-    using reference = value_type;
+    using pointer = typename std::remove_reference<typename NArray<T, M>::exposed_type>::type*;
+    using reference = typename NArray<T, M>::exposed_type;
 
   private:
     ////////////////////////////////////////////////////////////////////////////
@@ -96,7 +110,13 @@ namespace detail
     ////////////////////////////////////////////////////////////////////////////
 
     const wilt::NArray<T, N>* array_; // pointer to the array
-    Point<N-M> position_;             // position of the iterator in the array
+    T* base_;                         // pointer to the first element
+    Point<N-M> sizes_;                // sizes of the iterated dimensions
+    Point<N-M> steps_;                // steps of the iterated dimensions
+    Point<N-M> position_;             // position, only kept if not flat
+    pos_t index_;                     // linear index of the position
+    pos_t flatStep_;                  // step between positions if flat
+    bool flat_;                       // the dimensions collapse into one
 
   public:
     ////////////////////////////////////////////////////////////////////////////
@@ -105,58 +125,79 @@ namespace detail
 
     NArrayIterator()
       : array_(nullptr)
+      , base_(nullptr)
+      , sizes_()
+      , steps_()
       , position_()
+      , index_(0)
+      , flatStep_(0)
+      , flat_(true)
     { }
 
     // Creates the iterator from an array
     NArrayIterator(const wilt::NArray<T, N>& arr)
       : array_(&arr)
+      , base_(arr.data())
+      , sizes_(arr.sizes().template high<N-M>())
+      , steps_(arr.steps().template high<N-M>())
       , position_()
-    { }
+      , index_(0)
+      , flatStep_(0)
+      , flat_(true)
+    {
+      init_();
+    }
 
     // Creates the iterator from an array and position
     NArrayIterator(const wilt::NArray<T, N>& arr, const Point<N-M>& pos)
-      : array_(&arr)
-      , position_(pos)
-    { }
+      : NArrayIterator(arr)
+    {
+      setIndex_(wilt::detail::positionToIndex(pos, sizes_));
+    }
 
     // Creates the iterator from another iterator
-    NArrayIterator(const NArrayIterator<T, N, M>& iter)
-      : array_(iter.array_)
-      , position_(iter.position_)
-    { }
+    NArrayIterator(const NArrayIterator<T, N, M>& iter) = default;
 
     // Creates the iterator from another iterator and position
     NArrayIterator(const NArrayIterator<T, N, M>& iter, const Point<N-M>& pos)
-      : array_(iter.array_)
-      , position_(pos)
-    { }
+      : NArrayIterator(iter)
+    {
+      setIndex_(wilt::detail::positionToIndex(pos, sizes_));
+    }
 
   public:
     ////////////////////////////////////////////////////////////////////////////
     // ASSIGNMENT OPERATORS
     ////////////////////////////////////////////////////////////////////////////
 
-    NArrayIterator<T, N, M>& operator= (const NArrayIterator<T, N, M>& iter)
-    {
-      array_ = iter.array_;
-      position_ = iter.position_;
-
-      return *this;
-    }
+    NArrayIterator<T, N, M>& operator= (const NArrayIterator<T, N, M>& iter) = default;
 
     // in-place addition operator, offsets the position by +pos
     NArrayIterator<T, N, M>& operator+= (const ptrdiff_t pos)
     {
-      wilt::detail::addValueToPosition(position_, array_->sizes().data(), pos);
+      if (flat_)
+      {
+        index_ += pos;
+        return *this;
+      }
+
+      // stays within the innermost row, no need to carry
+      pos_t inner = position_[N-M-1] + pos;
+      if (inner >= 0 && inner < sizes_[N-M-1])
+      {
+        position_[N-M-1] = inner;
+        index_ += pos;
+        return *this;
+      }
+
+      setIndex_(index_ + pos);
       return *this;
     }
 
     // in-place subtraction operator, offsets the position by -pos
     NArrayIterator<T, N, M>& operator-= (const ptrdiff_t pos)
     {
-      wilt::detail::subValueFromPosition(position_, array_->sizes().data(), pos);
-      return *this;
+      return *this += -pos;
     }
 
   public:
@@ -164,22 +205,77 @@ namespace detail
     // ACCESS FUNCTIONS
     ////////////////////////////////////////////////////////////////////////////
 
-    value_type operator* () const
+    reference operator* () const
     {
-      return at_(position_);
+      return at_(ptr(), std::integral_constant<bool, M == 0>());
     }
 
-    value_type operator[] (pos_t pos) const
+    reference operator[] (pos_t pos) const
     {
-      auto newposition = position_;
-      wilt::detail::addValueToPosition(newposition, array_->sizes().data(), pos);
-      return at_(newposition);
+      return *(*this + pos);
     }
 
     // gets the position of the iterator
     Point<N-M> position() const
     {
-      return position_;
+      return flat_ ? wilt::detail::indexToPosition(index_, sizes_) : position_;
+    }
+
+    // gets the linear index of the iterator, in the range [0, count]
+    pos_t index() const noexcept
+    {
+      return index_;
+    }
+
+    // gets a pointer to the element, or first element of the subarray, that
+    // the iterator is currently referencing
+    T* ptr() const noexcept
+    {
+      if (flat_)
+        return base_ + index_ * flatStep_;
+
+      T* ptr = base_;
+      for (std::size_t i = 0; i < N-M; ++i)
+        ptr += position_[i] * steps_[i];
+      return ptr;
+    }
+
+    // returns true if all positions form a single run of equally spaced
+    // values, so `(*this + n).ptr()` is `ptr() + n * segmentStep()`
+    bool isFlat() const noexcept
+    {
+      return flat_;
+    }
+
+    // returns true if the elements yielded are adjacent in memory in order, so
+    // the whole range can be handed off as a plain pointer range
+    bool isContiguous() const noexcept
+    {
+      return M == 0 && flat_ && (flatStep_ == 1 || wilt::detail::size(sizes_) <= 1);
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // SEGMENT FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+    // The positions are split into segments, rows of equally spaced values. If
+    // the iterator is flat there is a single segment for the whole range, else
+    // each segment is a row along the last iterated dimension.
+
+    // gets the number of positions left in the current segment, including the
+    // current one
+    pos_t segmentSize() const noexcept
+    {
+      if (flat_)
+        return wilt::detail::size(sizes_) - index_;
+      return sizes_[N-M-1] - position_[N-M-1];
+    }
+
+    // gets the distance in elements between consecutive positions in the
+    // current segment
+    pos_t segmentStep() const noexcept
+    {
+      return flat_ ? flatStep_ : steps_[N-M-1];
     }
 
   public:
@@ -190,65 +286,52 @@ namespace detail
     // equal operator, returns true if they point to the same position
     bool operator== (const NArrayIterator<T, N, M>& iter) const
     {
-      assert(array_ == iter.array_);
+      assert(base_ == iter.base_);
 
-      return position_ == iter.position_;
+      return index_ == iter.index_;
     }
 
     // not equal operator, returns false if they point to the same position
     bool operator!= (const NArrayIterator<T, N, M>& iter) const
     {
-      assert(array_ == iter.array_);
+      assert(base_ == iter.base_);
 
-      return !(*this == iter);
+      return index_ != iter.index_;
     }
 
     bool operator<  (const NArrayIterator<T, N, M>& iter) const
     {
-      assert(array_ == iter.array_);
-
-      // simple lexigraphical comparison
-      for (std::size_t i = 0; i < N-M; ++i)
-      {
-        if (position_[i] < iter.position_[i]) return true;
-        if (position_[i] > iter.position_[i]) return false;
-      }
+      assert(base_ == iter.base_);
 
-      return false;
+      return index_ < iter.index_;
     }
 
     bool operator>  (const NArrayIterator<T, N, M>& iter) const
     {
-      assert(array_ == iter.array_);
+      assert(base_ == iter.base_);
 
-      return iter < *this;
+      return index_ > iter.index_;
     }
 
     bool operator<= (const NArrayIterator<T, N, M>& iter) const
     {
-      assert(array_ == iter.array_);
+      assert(base_ == iter.base_);
 
-      return !(iter < *this);
+      return index_ <= iter.index_;
     }
 
     bool operator>= (const NArrayIterator<T, N, M>& iter) const
     {
-      assert(array_ == iter.array_);
+      assert(base_ == iter.base_);
 
-      return !(*this < iter);
+      return index_ >= iter.index_;
     }
 
     difference_type operator- (const NArrayIterator<T, N, M>& iter) const
     {
-      assert(array_ == iter.array_);
+      assert(base_ == iter.base_);
 
-      pos_t diff = 0;
-      for (std::size_t i = 0; i < N - M; ++i)
-      {
-        diff *= array_->sizes()[i];
-        diff += (position_[i] - iter.position_[i]);
-      }
-      return diff;
+      return index_ - iter.index_;
     }
 
   public:
@@ -258,72 +341,124 @@ namespace detail
 
     NArrayIterator<T, N, M>& operator++ ()
     {
-      wilt::detail::addOneToPosition(position_, array_->sizes().data());
+      ++index_;
+      if (!flat_)
+        wilt::detail::addOneToPosition(position_, sizes_.data());
       return *this;
     }
 
     NArrayIterator<T, N, M>& operator-- ()
     {
-      wilt::detail::subOneFromPosition(position_, array_->sizes().data());
+      --index_;
+      if (!flat_)
+        wilt::detail::subOneFromPosition(position_, sizes_.data());
       return *this;
     }
 
     NArrayIterator<T, N, M> operator++ (int)
     {
-      auto oldposition = position_;
+      auto olditer = *this;
       ++(*this);
-      return NArrayIterator<T, N, M>(*this, oldposition);
+      return olditer;
     }
 
     NArrayIterator<T, N, M> operator-- (int)
     {
-      auto oldposition = position_;
+      auto olditer = *this;
       --(*this);
-      return NArrayIterator<T, N, M>(*this, oldposition);
+      return olditer;
     }
 
-    NArrayIterator<T, N, M> operator+ (const ptrdiff_t pos)
+    NArrayIterator<T, N, M> operator+ (const ptrdiff_t pos) const
     {
       auto newiter = *this;
       newiter += pos;
       return newiter;
     }
 
-    NArrayIterator<T, N, M> operator- (const ptrdiff_t pos)
+    NArrayIterator<T, N, M> operator- (const ptrdiff_t pos) const
     {
       auto newiter = *this;
       newiter -= pos;
       return newiter;
     }
 
+    friend NArrayIterator<T, N, M> operator+ (const ptrdiff_t pos, const NArrayIterator<T, N, M>& iter)
+    {
+      return iter + pos;
+    }
+
   private:
     ////////////////////////////////////////////////////////////////////////////
     // PRIVATE FUNCTIONS
     ////////////////////////////////////////////////////////////////////////////
 
-    value_type at_(const Point<N-M>& pos) const
+    // determines if the iterated dimensions can be walked with a single step,
+    // ignoring dimensions of size 1 since their step is never used
+    void init_()
     {
-      return array_->subarrayAtUnchecked(pos);
+      bool found = false;
+      pos_t expected = 0;
+      for (std::size_t i = N-M; i > 0; --i)
+      {
+        if (sizes_[i-1] == 1)
+          continue;
+
+        if (!found)
+        {
+          found = true;
+          flatStep_ = steps_[i-1];
+        }
+        else if (steps_[i-1] != expected)
+        {
+          flat_ = false;
+          return;
+        }
+        expected = steps_[i-1] * sizes_[i-1];
+      }
+    }
+
+    void setIndex_(pos_t index)
+    {
+      index_ = index;
+      if (!flat_)
+        position_ = wilt::detail::indexToPosition(index, sizes_);
+    }
+
+    reference at_(T* ptr, std::true_type) const
+    {
+      return *ptr;
+    }
+
+    reference at_(T* ptr, std::false_type) const
+    {
+      return NArray<T, M>(std::shared_ptr<T>(array_->data_, ptr), array_->sizes().template low<M>(), array_->steps().template low<M>());
     }
 
   }; // class NArrayIterator
 
-namespace detail
-{
-  template <std::size_t N>
-  void addValueToPosition(Point<N>& pos, const pos_t* sizes, pos_t value)
+  //! @brief  Calls func(ptr, count, step) for each run of equally spaced
+  //!         elements in [first, last), in order
+  //! @param[in]  first - the iterator to start at
+  //! @param[in]  last - the iterator to stop at
+  //! @param[in]  func - called with a pointer to the first element of the run,
+  //!             the number of elements, and the step between them
+  //!
+  //! A contiguous or otherwise flat range is handed to func in one call, else
+  //! func is called once for each (partial) row along the last dimension.
+  template <class T, std::size_t N, class Function>
+  void forEachSegment(NArrayIterator<T, N, 0> first, const NArrayIterator<T, N, 0>& last, Function func)
   {
-    for (std::size_t i = N-1; i > 0; --i)
+    while (first < last)
     {
-      pos[i] += value;
-      if (pos[i] < sizes[i])
-        return;
-      value = pos[i] / sizes[i];
-      pos[i] = pos[i] % sizes[i];
+      pos_t count = std::min<pos_t>(first.segmentSize(), last - first);
+      func(first.ptr(), count, first.segmentStep());
+      first += count;
     }
-    pos[0] += value;
   }
 
+namespace detail
+{
   template <std::size_t N>
   void addOneToPosition(Point<N>& pos, const pos_t* sizes)
   {
@@ -338,30 +473,44 @@ namespace detail
   }
 
   template <std::size_t N>
-  void subValueFromPosition(Point<N>& pos, const pos_t* sizes, pos_t value)
+  void subOneFromPosition(Point<N>& pos, const pos_t* sizes)
   {
     for (std::size_t i = N-1; i > 0; --i)
     {
-      pos[i] -= value;
+      pos[i] -= 1;
       if (pos[i] >= 0)
         return;
-      value = -(pos[i] / sizes[i]);
-      pos[i] = (pos[i] % sizes[i]) + sizes[i];
+      pos[i] = sizes[i]-1;
     }
-    pos[0] -= value;
+    pos[0] -= 1;
   }
 
+  // the one-past-the-end index maps to {sizes[0], 0, ...} like end() uses
   template <std::size_t N>
-  void subOneFromPosition(Point<N>& pos, const pos_t* sizes)
+  Point<N> indexToPosition(pos_t index, const Point<N>& sizes)
   {
+    Point<N> pos;
     for (std::size_t i = N-1; i > 0; --i)
     {
-      pos[i] -= 1;
-      if (pos[i] >= 0)
-        return;
-      pos[i] = sizes[i]-1;
+      if (sizes[i] == 0)
+        return Point<N>();
+      pos[i] = index % sizes[i];
+      index /= sizes[i];
     }
-    pos[0] -= 1;
+    pos[0] = index;
+    return pos;
+  }
+
+  template <std::size_t N>
+  pos_t positionToIndex(const Point<N>& pos, const Point<N>& sizes)
+  {
+    pos_t index = 0;
+    for (std::size_t i = 0; i < N; ++i)
+    {
+      index *= sizes[i];
+      index += pos[i];
+    }
+    return index;
   }
 
 } // namespace detail
@@ -51,8 +51,10 @@ namespace wilt
 
 #define MAKE_COMPARE_OP(NAME, OP) \
   template <class T, class U, std::size_t N>                                        \
+  WILT_DIAGNOSTIC_NOINLINE                                                          \
   NArray<bool, N> NAME(const NArray<T, N>& lhs, const NArray<U, N>& rhs)            \
   {                                                                                 \
+    WILT_DIAGNOSTIC_ENTRY();                                                        \
     if (lhs.sizes() != rhs.sizes())                                                 \
       throw std::invalid_argument(#NAME "(): dimensions must match");               \
     if (lhs.empty())                                                                \
@@ -62,8 +64,10 @@ namespace wilt
   }                                                                                 \
                                                                                     \
   template <class T, class U, std::size_t N>                                        \
+  WILT_DIAGNOSTIC_NOINLINE                                                          \
   NArray<bool, N> NAME(const NArray<T, N>& lhs, const U& rhs)                       \
   {                                                                                 \
+    WILT_DIAGNOSTIC_ENTRY();                                                        \
     if (lhs.empty())                                                                \
       return NArray<bool, N>();                                                     \
                                                                                     \
@@ -71,8 +75,10 @@ namespace wilt
   }                                                                                 \
                                                                                     \
   template <class T, class U, std::size_t N>                                        \
+  WILT_DIAGNOSTIC_NOINLINE                                                          \
   NArray<bool, N> NAME(const T& lhs, const NArray<U, N>& rhs)                       \
   {                                                                                 \
+    WILT_DIAGNOSTIC_ENTRY();                                                        \
     if (rhs.empty())                                                                \
       return NArray<bool, N>();                                                     \
                                                                                     \
@@ -88,8 +94,10 @@ namespace wilt
 
 #define MAKE_BINARY_OP(NAME, OP) \
   template <class Ret, class T, class U, std::size_t N>                                                                      \
+  WILT_DIAGNOSTIC_NOINLINE                                                                                                   \
   NArray<Ret, N> NAME(const NArray<T, N>& lhs, const NArray<U, N>& rhs)                                                      \
   {                                                                                                                          \
+    WILT_DIAGNOSTIC_ENTRY();                                                                                                 \
     if (lhs.sizes() != rhs.sizes())                                                                                          \
       throw std::invalid_argument(#NAME "(): dimensions must match");                                                        \
     if (lhs.empty())                                                                                                         \
@@ -99,8 +107,10 @@ namespace wilt
   }                                                                                                                          \
                                                                                                                              \
   template <class Ret, class T, class U, std::size_t N>                                                                      \
+  WILT_DIAGNOSTIC_NOINLINE                                                                                                   \
   NArray<Ret, N> NAME(const NArray<T, N>& lhs, const U& rhs)                                                                 \
   {                                                                                                                          \
+    WILT_DIAGNOSTIC_ENTRY();                                                                                                 \
     if (lhs.empty())                                                                                                         \
       return NArray<Ret, N>();                                                                                               \
                                                                                                                              \
@@ -108,8 +118,10 @@ namespace wilt
   }                                                                                                                          \
                                                                                                                              \
   template <class Ret, class T, class U, std::size_t N>                                                                      \
+  WILT_DIAGNOSTIC_NOINLINE                                                                                                   \
   NArray<Ret, N> NAME(const T& lhs, const NArray<U, N>& rhs)                                                                 \
   {                                                                                                                          \
+    WILT_DIAGNOSTIC_ENTRY();                                                                                                 \
     if (rhs.empty())                                                                                                         \
       return NArray<Ret, N>();                                                                                               \
                                                                                                                              \
@@ -117,20 +129,26 @@ namespace wilt
   }                                                                                                                          \
                                                                                                                              \
   template <class T, class U, std::size_t N>                                                                                 \
+  WILT_DIAGNOSTIC_NOINLINE                                                                                                   \
   NArray<decltype(std::declval<T>() OP std::declval<U>()), N> operator OP (const NArray<T, N>& lhs, const NArray<U, N>& rhs) \
   {                                                                                                                          \
+    WILT_DIAGNOSTIC_ENTRY();                                                                                                 \
     return wilt::NAME<decltype(std::declval<T>() OP std::declval<U>())>(lhs, rhs);                                           \
   }                                                                                                                          \
                                                                                                                              \
   template <class T, class U, std::size_t N>                                                                                 \
+  WILT_DIAGNOSTIC_NOINLINE                                                                                                   \
   NArray<decltype(std::declval<T>() OP std::declval<U>()), N> operator OP (const NArray<T, N>& lhs, const U& rhs)            \
   {                                                                                                                          \
+    WILT_DIAGNOSTIC_ENTRY();                                                                                                 \
     return wilt::NAME<decltype(std::declval<T>() OP std::declval<U>())>(lhs, rhs);                                           \
   }                                                                                                                          \
                                                                                                                              \
   template <class T, class U, std::size_t N>                                                                                 \
+  WILT_DIAGNOSTIC_NOINLINE                                                                                                   \
   NArray<decltype(std::declval<T>() OP std::declval<U>()), N> operator OP (const T& lhs, const NArray<U, N>& rhs)            \
   {                                                                                                                          \
+    WILT_DIAGNOSTIC_ENTRY();                                                                                                 \
     return wilt::NAME<decltype(std::declval<T>() OP std::declval<U>())>(lhs, rhs);                                           \
   }                                                                                                                          \
 
@@ -0,0 +1,714 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: pipeline.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines bounded queues, a recycling array pool, and a staged pipeline
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_PIPELINE_HPP
+#define WILT_PIPELINE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "narray.hpp"
+
+namespace wilt
+{
+namespace detail
+{
+  // Rounds up to the next power of two, queues use it to index with a mask
+  inline std::size_t nextPowerOfTwo(std::size_t n) noexcept
+  {
+    std::size_t ret = 1;
+    while (ret < n)
+      ret <<= 1;
+    return ret;
+  }
+
+  // The `Backoff` class is used to wait on lock-free structures. It spins for
+  // a short while, then yields, and then sleeps so that a stalled consumer or
+  // producer doesn't burn a whole core.
+  class Backoff
+  {
+  public:
+    void wait() noexcept
+    {
+      if (count_ < 64)
+        ;
+      else if (count_ < 128)
+        std::this_thread::yield();
+      else
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+      ++count_;
+    }
+
+  private:
+    std::size_t count_ = 0;
+
+  }; // class Backoff
+
+  // Pushes into a queue, waiting while it is full. Returns false if the queue
+  // was closed.
+  template <class Queue, class T>
+  bool blockingPush(Queue& queue, T&& value)
+  {
+    Backoff backoff;
+    while (!queue.closed())
+    {
+      if (queue.tryPush(std::move(value)))
+        return true;
+      backoff.wait();
+    }
+    return false;
+  }
+
+  // Pops from a queue, waiting while it is empty. Returns false if the queue
+  // was closed and is empty.
+  template <class Queue, class T>
+  bool blockingPop(Queue& queue, T& value)
+  {
+    Backoff backoff;
+    for (;;)
+    {
+      if (queue.tryPop(value))
+        return true;
+      if (queue.closed())
+        return queue.tryPop(value);
+      backoff.wait();
+    }
+  }
+
+} // namespace detail
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is a bounded lock-free queue for a single producer thread and a
+  // single consumer thread.
+  //
+  // The capacity is rounded up to a power of two. 'tryPush()' and 'tryPop()'
+  // never block, 'push()' and 'pop()' wait until they can complete or until the
+  // queue is closed. Values are moved out of the queue when popped so handles
+  // like `NArray`s don't keep their data alive while sitting in a slot.
+
+  template <class T>
+  class SpscQueue
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    explicit SpscQueue(std::size_t capacity)
+      : slots_(new T[detail::nextPowerOfTwo(capacity)])
+      , mask_(detail::nextPowerOfTwo(capacity) - 1)
+      , padding1_()
+      , head_(0)
+      , padding2_()
+      , tail_(0)
+      , padding3_()
+      , closed_(false)
+    {
+      if (capacity == 0)
+        throw std::invalid_argument("SpscQueue(capacity): capacity must be positive");
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator= (const SpscQueue&) = delete;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::size_t capacity() const noexcept
+    {
+      return mask_ + 1;
+    }
+
+    bool closed() const noexcept
+    {
+      return closed_.load(std::memory_order_acquire);
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // MODIFIER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Pushes if there is room, 'value' is left untouched on failure
+    bool tryPush(T&& value)
+    {
+      std::size_t tail = tail_.load(std::memory_order_relaxed);
+      if (tail - head_.load(std::memory_order_acquire) > mask_)
+        return false;
+
+      slots_[tail & mask_] = std::move(value);
+      tail_.store(tail + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool tryPop(T& value)
+    {
+      std::size_t head = head_.load(std::memory_order_relaxed);
+      if (head == tail_.load(std::memory_order_acquire))
+        return false;
+
+      value = std::move(slots_[head & mask_]);
+      slots_[head & mask_] = T();
+      head_.store(head + 1, std::memory_order_release);
+      return true;
+    }
+
+    // Waits for room, returns false if the queue was closed
+    bool push(T value)
+    {
+      return detail::blockingPush(*this, std::move(value));
+    }
+
+    // Waits for a value, returns false if the queue is closed and empty
+    bool pop(T& value)
+    {
+      return detail::blockingPop(*this, value);
+    }
+
+    // Closes the queue, remaining values can still be popped
+    void close() noexcept
+    {
+      closed_.store(true, std::memory_order_release);
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // the padding keeps each end of the queue on its own cache line
+    std::unique_ptr<T[]> slots_;
+    std::size_t mask_;
+    char padding1_[64];
+    std::atomic<std::size_t> head_;
+    char padding2_[64];
+    std::atomic<std::size_t> tail_;
+    char padding3_[64];
+    std::atomic<bool> closed_;
+
+  }; // class SpscQueue
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is a bounded lock-free queue for any number of producer and
+  // consumer threads.
+  //
+  // It is the array-based queue described by Dmitry Vyukov: each slot has a
+  // sequence number that tells producers and consumers whose turn it is, so
+  // the only contended operations are a single compare-exchange on each end.
+  // It has the same interface as `SpscQueue`, except the capacity is at least
+  // 2 since the sequence numbers can't tell a full slot from an empty one with
+  // only one.
+
+  template <class T>
+  class MpmcQueue
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    explicit MpmcQueue(std::size_t capacity)
+      : cells_(new Cell[cellCount(capacity)])
+      , mask_(cellCount(capacity) - 1)
+      , padding1_()
+      , enqueue_(0)
+      , padding2_()
+      , dequeue_(0)
+      , padding3_()
+      , closed_(false)
+    {
+      if (capacity == 0)
+        throw std::invalid_argument("MpmcQueue(capacity): capacity must be positive");
+
+      for (std::size_t i = 0; i <= mask_; ++i)
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator= (const MpmcQueue&) = delete;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::size_t capacity() const noexcept
+    {
+      return mask_ + 1;
+    }
+
+    bool closed() const noexcept
+    {
+      return closed_.load(std::memory_order_acquire);
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // MODIFIER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Pushes if there is room, 'value' is left untouched on failure
+    bool tryPush(T&& value)
+    {
+      Cell* cell;
+      std::size_t pos = enqueue_.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        cell = &cells_[pos & mask_];
+        std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        std::intptr_t diff = (std::intptr_t)sequence - (std::intptr_t)pos;
+        if (diff == 0)
+        {
+          if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            break;
+        }
+        else if (diff < 0)
+          return false;
+        else
+          pos = enqueue_.load(std::memory_order_relaxed);
+      }
+
+      cell->value = std::move(value);
+      cell->sequence.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    bool tryPop(T& value)
+    {
+      Cell* cell;
+      std::size_t pos = dequeue_.load(std::memory_order_relaxed);
+      for (;;)
+      {
+        cell = &cells_[pos & mask_];
+        std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        std::intptr_t diff = (std::intptr_t)sequence - (std::intptr_t)(pos + 1);
+        if (diff == 0)
+        {
+          if (dequeue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            break;
+        }
+        else if (diff < 0)
+          return false;
+        else
+          pos = dequeue_.load(std::memory_order_relaxed);
+      }
+
+      value = std::move(cell->value);
+      cell->value = T();
+      cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+      return true;
+    }
+
+    // Waits for room, returns false if the queue was closed
+    bool push(T value)
+    {
+      return detail::blockingPush(*this, std::move(value));
+    }
+
+    // Waits for a value, returns false if the queue is closed and empty
+    bool pop(T& value)
+    {
+      return detail::blockingPop(*this, value);
+    }
+
+    // Closes the queue, remaining values can still be popped
+    void close() noexcept
+    {
+      closed_.store(true, std::memory_order_release);
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE TYPES
+    ////////////////////////////////////////////////////////////////////////////
+
+    struct Cell
+    {
+      std::atomic<std::size_t> sequence;
+      T value;
+    };
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    static std::size_t cellCount(std::size_t capacity) noexcept
+    {
+      return detail::nextPowerOfTwo(capacity < 2 ? 2 : capacity);
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // the padding keeps each end of the queue on its own cache line
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_;
+    char padding1_[64];
+    std::atomic<std::size_t> enqueue_;
+    char padding2_[64];
+    std::atomic<std::size_t> dequeue_;
+    char padding3_[64];
+    std::atomic<bool> closed_;
+
+  }; // class MpmcQueue
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class hands out arrays of a fixed size and takes their data back for
+  // reuse once every array referencing it is gone.
+  //
+  // The data of an acquired array is returned to the pool by the deleter of
+  // its `shared_ptr`, so views, copies, and transformations of it all keep it
+  // checked out. At most 'capacity' buffers are ever allocated; 'acquire()'
+  // waits for one to be released when they are all in use, which applies
+  // back-pressure to whatever is producing arrays. The pool may be destroyed
+  // before its arrays, the data is then freed when they are released.
+  //
+  // NOTE: recycled arrays keep the values they were released with
+
+  template <class T, std::size_t N>
+  class NArrayPool
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    NArrayPool(const Point<N>& sizes, std::size_t capacity)
+      : state_(std::make_shared<State>(sizes, capacity))
+    {
+      if (!wilt::detail::validSize(sizes))
+        throw std::invalid_argument("NArrayPool(sizes, capacity): sizes are not valid");
+      if (capacity == 0)
+        throw std::invalid_argument("NArrayPool(sizes, capacity): capacity must be positive");
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    const Point<N>& sizes() const noexcept
+    {
+      return state_->sizes;
+    }
+
+    std::size_t capacity() const noexcept
+    {
+      return state_->capacity;
+    }
+
+    // The number of buffers that have been allocated so far
+    std::size_t allocated() const noexcept
+    {
+      return state_->allocated.load();
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESS FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Gets an array with free data, or an empty array if all buffers are in
+    // use
+    NArray<T, N> tryAcquire()
+    {
+      T* data = nullptr;
+      if (!state_->available.tryPop(data))
+      {
+        std::size_t count = state_->allocated.load();
+        do
+        {
+          if (count == state_->capacity)
+            return NArray<T, N>();
+        } while (!state_->allocated.compare_exchange_weak(count, count + 1));
+
+        data = new T[(std::size_t)wilt::detail::size(state_->sizes)];
+      }
+
+      return NArray<T, N>(std::shared_ptr<T>(data, Recycler{ state_ }), state_->sizes, wilt::detail::step(state_->sizes));
+    }
+
+    // Gets an array with free data, waits for one if all buffers are in use
+    NArray<T, N> acquire()
+    {
+      detail::Backoff backoff;
+      for (;;)
+      {
+        auto ret = tryAcquire();
+        if (!ret.empty())
+          return ret;
+        backoff.wait();
+      }
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE TYPES
+    ////////////////////////////////////////////////////////////////////////////
+
+    struct State
+    {
+      State(const Point<N>& sizes_, std::size_t capacity_)
+        : sizes(sizes_)
+        , capacity(capacity_)
+        , allocated(0)
+        , available(capacity_)
+      { }
+
+      ~State()
+      {
+        T* data;
+        while (available.tryPop(data))
+          delete[] data;
+      }
+
+      Point<N> sizes;
+      std::size_t capacity;
+      std::atomic<std::size_t> allocated;
+      MpmcQueue<T*> available;
+    };
+
+    struct Recycler
+    {
+      std::shared_ptr<State> state;
+
+      void operator() (T* data) const
+      {
+        // there is always room since the queue holds every buffer that was
+        // ever allocated
+        state->available.tryPush(std::move(data));
+      }
+    };
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::shared_ptr<State> state_;
+
+  }; // class NArrayPool
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class runs items through a chain of stages, each on its own set of
+  // threads, connected by bounded lock-free queues.
+  //
+  // Items are handles (like `NArray`s) that are moved from stage to stage, no
+  // element data is copied. When a queue is full, the stage feeding it waits,
+  // so a slow stage will eventually make 'push()' wait too. Items are dropped
+  // after the last stage, which releases them back to an `NArrayPool` if that
+  // is where they came from.
+  //
+  // NArrayPool<std::uint8_t, 3> frames({ 1080, 1920, 3 }, 8);
+  // Pipeline<NArray<std::uint8_t, 3>> pipeline(4);
+  // pipeline.addStage(2, [](auto& frame) { denoise(frame); });
+  // pipeline.addStage(1, [](auto& frame) { display(frame); });
+  // pipeline.start();
+  // while (capturing) {
+  //   auto frame = frames.acquire();
+  //   capture(frame);
+  //   pipeline.push(std::move(frame));
+  // }
+  // pipeline.close();
+  //
+  // NOTE: with more than one thread in a stage, items may leave it in a
+  // different order than they entered
+  // NOTE: exceptions thrown by a stage function drop that item
+
+  template <class Item>
+  class Pipeline
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Creates a pipeline where each queue holds up to 'capacity' items
+    explicit Pipeline(std::size_t capacity = 16)
+      : capacity_(capacity)
+      , started_(false)
+    {
+      if (capacity == 0)
+        throw std::invalid_argument("Pipeline(capacity): capacity must be positive");
+    }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator= (const Pipeline&) = delete;
+
+    // Closes the pipeline and waits for all items to finish
+    ~Pipeline()
+    {
+      close();
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // MODIFIER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Adds a stage run by 'threads' threads, 'func' should have the signature
+    // void(Item&)
+    template <class Function>
+    Pipeline& addStage(std::size_t threads, Function func)
+    {
+      if (started_)
+        throw std::logic_error("addStage(threads, func): invalid after start()");
+      if (threads == 0)
+        throw std::invalid_argument("addStage(threads, func): threads must be positive");
+
+      stages_.emplace_back(new Stage(threads, std::function<void(Item&)>(std::move(func)), capacity_));
+      return *this;
+    }
+
+    // Starts the stage threads
+    void start()
+    {
+      if (started_)
+        throw std::logic_error("start(): already started");
+      if (stages_.empty())
+        throw std::logic_error("start(): no stages added");
+
+      started_ = true;
+      for (std::size_t i = 0; i < stages_.size(); ++i)
+      {
+        Stage* stage = stages_[i].get();
+        Stage* next = i + 1 < stages_.size() ? stages_[i + 1].get() : nullptr;
+        stage->running.store(stage->threads.size());
+        for (auto& thread : stage->threads)
+          thread = std::thread([stage, next]() { run_(*stage, next); });
+      }
+    }
+
+    // Pushes an item into the first stage, waits while the pipeline is full.
+    // Returns false if the pipeline was closed.
+    bool push(Item item)
+    {
+      if (!started_)
+        throw std::logic_error("push(item): invalid before start()");
+
+      return stages_.front()->input.push(std::move(item));
+    }
+
+    // Pushes an item into the first stage if there is room
+    bool tryPush(Item&& item)
+    {
+      if (!started_)
+        throw std::logic_error("tryPush(item): invalid before start()");
+      if (stages_.front()->input.closed())
+        return false;
+
+      return stages_.front()->input.tryPush(std::move(item));
+    }
+
+    // Stops accepting items and waits for the ones already pushed to finish
+    void close()
+    {
+      if (!started_)
+        return;
+
+      stages_.front()->input.close();
+      for (auto& stage : stages_)
+        for (auto& thread : stage->threads)
+          if (thread.joinable())
+            thread.join();
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE TYPES
+    ////////////////////////////////////////////////////////////////////////////
+
+    struct Stage
+    {
+      Stage(std::size_t count, std::function<void(Item&)> f, std::size_t capacity)
+        : func(std::move(f))
+        , input(capacity)
+        , threads(count)
+        , running(0)
+      { }
+
+      std::function<void(Item&)> func;
+      MpmcQueue<Item> input;
+      std::vector<std::thread> threads;
+      std::atomic<std::size_t> running;
+    };
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    static void run_(Stage& stage, Stage* next)
+    {
+      Item item;
+      while (stage.input.pop(item))
+      {
+        try
+        {
+          stage.func(item);
+          if (next)
+            next->input.push(std::move(item));
+        }
+        catch (...)
+        {
+
+        }
+        item = Item();
+      }
+
+      // the last thread out closes the next stage
+      if (--stage.running == 0 && next)
+        next->input.close();
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::vector<std::unique_ptr<Stage>> stages_;
+    std::size_t capacity_;
+    bool started_;
+
+  }; // class Pipeline
+
+} // namespace wilt
+
+#endif // !WILT_PIPELINE_HPP
@@ -355,6 +355,14 @@ namespace wilt
     return ret;
   }
 
+  // A box within an array, given by its first position and its sizes
+  template <std::size_t N>
+  struct Region
+  {
+    Point<N> loc;
+    Point<N> sizes;
+  };
+
 } // namespace wilt
 
 #endif // !WILT_POINT_HPP
@@ -0,0 +1,382 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: prefetch.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines a reader that prefetches regions of an on-disk array
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_PREFETCH_HPP
+#define WILT_PREFETCH_HPP
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "narray.hpp"
+#include "mapping.hpp"
+#include "pipeline.hpp"
+#include "threadpool.hpp"
+
+namespace wilt
+{
+  //! @brief         creates a plan that covers an array with tiles in
+  //!                row-major order
+  //! @param[in]     sizes - the dimensions of the array
+  //! @param[in]     tile - the dimensions of each tile
+  //! @return        the tiles, those at the far edges are clipped
+  template <std::size_t N>
+  std::vector<Region<N>> tilePlan(const Point<N>& sizes, const Point<N>& tile)
+  {
+    if (!wilt::detail::validSize(sizes))
+      throw std::invalid_argument("tilePlan(sizes, tile): sizes is not valid");
+    if (!wilt::detail::validSize(tile))
+      throw std::invalid_argument("tilePlan(sizes, tile): tile is not valid");
+
+    std::vector<Region<N>> ret;
+    Point<N> loc;
+    for (;;)
+    {
+      Region<N> region;
+      region.loc = loc;
+      for (std::size_t i = 0; i < N; ++i)
+        region.sizes[i] = std::min(tile[i], sizes[i] - loc[i]);
+      ret.push_back(region);
+
+      std::size_t i = N;
+      for (; i > 0; --i)
+      {
+        loc[i-1] += tile[i-1];
+        if (loc[i-1] < sizes[i-1])
+          break;
+        loc[i-1] = 0;
+      }
+      if (i == 0)
+        return ret;
+    }
+  }
+
+  //! @brief         creates a plan that visits the same M-dimensional slices,
+  //!                in the same order, as 'subarrays<M>()'
+  //! @param[in]     sizes - the dimensions of the array
+  //! @return        the slices, each has size 1 in the leading N-M dimensions
+  template <std::size_t M, std::size_t N>
+  std::vector<Region<N>> subarrayPlan(const Point<N>& sizes)
+  {
+    static_assert(M > 0 && M <= N, "subarrayPlan<M>(sizes): M must be in [1, N]");
+
+    Point<N> tile = sizes;
+    for (std::size_t i = 0; i < N - M; ++i)
+      tile[i] = 1;
+    return tilePlan(sizes, tile);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is designed to read the regions of a large on-disk array in a
+  // known order while the caller works on the previous ones.
+  //
+  // The file holds raw elements in row-major order, like 'readRaw()'. Given
+  // an access plan, the reader keeps up to 'depth' upcoming regions in flight
+  // on a thread pool and 'next()' hands them out in plan order, waiting only
+  // if the read of the next one hasn't finished. Each region is read with as
+  // few `preadv()` calls as possible: rows that are close together in the
+  // file are read in one call, with the bytes between them sent to a scratch
+  // buffer.
+  //
+  // Regions are read into buffers from an `NArrayPool` so a scan allocates
+  // only a handful of buffers, which are reused as soon as the caller drops
+  // the arrays it was given. If the caller keeps too many arrays, new
+  // buffers are allocated instead of waiting.
+  //
+  // auto plan = tilePlan<3>({ 2048, 2048, 2048 }, { 64, 64, 64 });
+  // PrefetchReader<float, 3> reader("volume.raw", { 2048, 2048, 2048 }, plan);
+  // for (auto tile = reader.next(); !tile.empty(); tile = reader.next())
+  //   process(tile);
+  //
+  // NOTE: if created from a thread of the pool, regions are read when they
+  // are requested, since waiting on the pool from within it could deadlock
+
+  template <class T, std::size_t N>
+  class PrefetchReader
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ASSERTS
+    ////////////////////////////////////////////////////////////////////////////
+    static_assert(std::is_trivially_copyable<T>::value, "PrefetchReader<T, N>: T must be trivially copyable");
+    static_assert(!std::is_const<T>::value, "PrefetchReader<T, N>: T must not be const");
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Opens the array of 'sizes' that starts at byte 'offset' of 'path' and
+    // starts reading the first regions of 'plan'
+    //
+    // Throws std::runtime_error if the file can't be opened or is too short
+    PrefetchReader(const std::string& path, const Point<N>& sizes, std::vector<Region<N>> plan,
+                   std::size_t depth = 4, off_t offset = 0, ThreadPool& pool = defaultThreadPool())
+      : file_(std::make_shared<detail::FileDescriptor>(::open(path.c_str(), O_RDONLY)))
+      , sizes_(sizes)
+      , offset_(offset)
+      , plan_(std::move(plan))
+      , depth_(pool.isWorker() ? 0 : std::max<std::size_t>(depth, 1))
+      , pool_(&pool)
+      , buffers_(Point<1>(std::max<pos_t>(maxElements_(plan_), 1)), depth_ + 2)
+      , next_(0)
+      , scheduled_(0)
+      , pending_()
+    {
+      if (file_->get() < 0)
+        throw std::runtime_error(detail::errnoMessage("PrefetchReader(): could not open '" + path + "'"));
+      if (!wilt::detail::validSize(sizes))
+        throw std::invalid_argument("PrefetchReader(): sizes is not valid");
+      for (auto& region : plan_)
+        for (std::size_t i = 0; i < N; ++i)
+          if (region.sizes[i] <= 0 || region.loc[i] < 0 || region.loc[i] + region.sizes[i] > sizes[i])
+            throw std::invalid_argument("PrefetchReader(): plan has a region out of bounds");
+
+      struct stat st;
+      if (::fstat(file_->get(), &st) != 0)
+        throw std::runtime_error(detail::errnoMessage("PrefetchReader(): could not stat '" + path + "'"));
+      if ((std::size_t)st.st_size < offset + wilt::detail::size(sizes) * sizeof(T))
+        throw std::runtime_error("PrefetchReader(): '" + path + "' is too short");
+
+      schedule_();
+    }
+
+    PrefetchReader(const PrefetchReader&) = delete;
+    PrefetchReader& operator= (const PrefetchReader&) = delete;
+
+    ~PrefetchReader()
+    {
+      for (auto& result : pending_)
+        result.wait();
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // The number of regions in the plan
+    std::size_t size() const noexcept
+    {
+      return plan_.size();
+    }
+
+    // The index of the region 'next()' will return
+    std::size_t position() const noexcept
+    {
+      return next_;
+    }
+
+    bool done() const noexcept
+    {
+      return next_ == plan_.size();
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESS FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Gets the next region of the plan, or an empty array once every region
+    // has been returned
+    //
+    // Throws std::runtime_error if the region couldn't be read
+    NArray<T, N> next()
+    {
+      if (done())
+        return NArray<T, N>();
+
+      NArray<T, N> ret;
+      if (pending_.empty())
+      {
+        ret = read_(plan_[next_]);
+        ++scheduled_;
+      }
+      else
+      {
+        auto result = std::move(pending_.front());
+        pending_.pop_front();
+        ret = result.get();
+      }
+
+      ++next_;
+      schedule_();
+      return ret;
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // The most bytes between rows that are read and discarded rather than
+    // starting a new read
+    static const std::size_t MAX_GAP = 64 * 1024;
+
+    static pos_t maxElements_(const std::vector<Region<N>>& plan) noexcept
+    {
+      pos_t ret = 0;
+      for (auto& region : plan)
+        ret = std::max(ret, wilt::detail::size(region.sizes));
+      return ret;
+    }
+
+    void schedule_()
+    {
+      while (pending_.size() < depth_ && scheduled_ < plan_.size())
+      {
+        Region<N> region = plan_[scheduled_++];
+        NArray<T, 1> buffer = buffers_.tryAcquire();
+        auto file = file_;
+        Point<N> sizes = sizes_;
+        off_t offset = offset_;
+        pending_.push_back(pool_->submit([file, sizes, offset, region, buffer]() {
+          return readInto_(file->get(), sizes, offset, region, buffer);
+        }));
+      }
+    }
+
+    NArray<T, N> read_(const Region<N>& region)
+    {
+      return readInto_(file_->get(), sizes_, offset_, region, buffers_.tryAcquire());
+    }
+
+    static NArray<T, N> readInto_(int fd, const Point<N>& sizes, off_t offset, const Region<N>& region, NArray<T, 1> buffer)
+    {
+      pos_t count = wilt::detail::size(region.sizes);
+      if (buffer.empty())
+        buffer = NArray<T, 1>(Point<1>(count));
+
+      readRegion_(fd, sizes, offset, region, buffer.data());
+      return buffer.range(0, 0, count).template reshape<N>(region.sizes);
+    }
+
+    static void readRegion_(int fd, const Point<N>& sizes, off_t offset, const Region<N>& region, T* dst)
+    {
+      // a run is the part of the region that is contiguous in the file, it
+      // covers the trailing dimensions that are fully spanned plus one more
+      std::size_t inner = 1;
+      while (inner < N && region.sizes[N-inner] == sizes[N-inner])
+        ++inner;
+
+      std::size_t outer = N - inner;
+      std::size_t runBytes = sizeof(T);
+      for (std::size_t i = outer; i < N; ++i)
+        runBytes *= (std::size_t)region.sizes[i];
+
+      const Point<N> steps = wilt::detail::step(sizes);
+#ifdef IOV_MAX
+      const std::size_t maxIov = IOV_MAX;
+#else
+      const std::size_t maxIov = 1024;
+#endif
+
+      std::vector<iovec> iov;
+      std::unique_ptr<char[]> scratch;
+      off_t groupStart = 0;
+      off_t groupEnd = 0;
+
+      auto flush = [&]() {
+        if (!iov.empty())
+          detail::preadvAll(fd, iov.data(), (int)iov.size(), groupStart);
+        iov.clear();
+      };
+
+      Point<N> pos;
+      for (;;)
+      {
+        off_t runStart = offset;
+        for (std::size_t i = 0; i < N; ++i)
+          runStart += (off_t)((region.loc[i] + (i < outer ? pos[i] : 0)) * steps[i] * (pos_t)sizeof(T));
+
+        std::size_t gap = (std::size_t)(runStart - groupEnd);
+        if (!iov.empty() && runStart >= groupEnd && gap <= MAX_GAP && iov.size() + 2 <= maxIov)
+        {
+          if (gap > 0)
+          {
+            if (!scratch)
+              scratch.reset(new char[MAX_GAP]);
+            iov.push_back(iovec{ scratch.get(), gap });
+          }
+        }
+        else
+        {
+          flush();
+          groupStart = runStart;
+        }
+
+        iov.push_back(iovec{ dst, runBytes });
+        groupEnd = runStart + (off_t)runBytes;
+        dst += runBytes / sizeof(T);
+
+        std::size_t i = outer;
+        for (; i > 0; --i)
+        {
+          if (++pos[i-1] < region.sizes[i-1])
+            break;
+          pos[i-1] = 0;
+        }
+        if (i == 0)
+          break;
+      }
+
+      flush();
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::shared_ptr<detail::FileDescriptor> file_;
+    Point<N> sizes_;
+    off_t offset_;
+    std::vector<Region<N>> plan_;
+    std::size_t depth_;
+    ThreadPool* pool_;
+    NArrayPool<T, 1> buffers_;
+    std::size_t next_;
+    std::size_t scheduled_;
+    std::deque<std::future<NArray<T, N>>> pending_;
+
+  }; // class PrefetchReader
+
+} // namespace wilt
+
+#endif // !WILT_PREFETCH_HPP
@@ -0,0 +1,145 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: rawio.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines functions for reading and writing arrays as raw binary files
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_RAWIO_HPP
+#define WILT_RAWIO_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <ios>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "narray.hpp"
+#include "byteorder.hpp"
+
+namespace wilt
+{
+  //! @brief         reads an array from a file of raw elements in row-major
+  //!                order
+  //! @param[in]     path - the file to read
+  //! @param[in]     sizes - the dimensions of the array
+  //! @param[in]     offset - the byte offset in the file the elements start at
+  //! @return        the newly read array
+  //!
+  //! Throws std::runtime_error if the file can't be opened or is too short
+  template <class T, std::size_t N>
+  NArray<T, N> readRaw(const std::string& path, const Point<N>& sizes, std::streamoff offset = 0)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "readRaw(): invalid when element type is not trivially copyable");
+
+    WILT_TRACE_SCOPE("readRaw", sizes, (std::size_t)wilt::detail::size(sizes) * sizeof(T));
+    NArray<T, N> ret(sizes);
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+      throw std::runtime_error("readRaw(): could not open '" + path + "'");
+
+    file.seekg(offset);
+    file.read(reinterpret_cast<char*>(ret.data()), (std::streamsize)(ret.size() * sizeof(T)));
+    if (!file)
+      throw std::runtime_error("readRaw(): '" + path + "' is too short");
+
+    return ret;
+  }
+
+  //! @brief         reads an array from a file of raw elements in row-major
+  //!                order stored in the given byte order
+  //! @param[in]     path - the file to read
+  //! @param[in]     sizes - the dimensions of the array
+  //! @param[in]     order - the byte order of the elements in the file
+  //! @param[in]     offset - the byte offset in the file the elements start at
+  //! @return        the newly read array, in native byte order
+  //!
+  //! Throws std::runtime_error if the file can't be opened or is too short
+  //! Foreign elements are read in blocks and swapped while being copied into
+  //! the array, so the array is only passed over once.
+  template <class T, std::size_t N>
+  NArray<T, N> readRaw(const std::string& path, const Point<N>& sizes, ByteOrder order, std::streamoff offset = 0)
+  {
+    static_assert(std::is_arithmetic<T>::value, "readRaw(): invalid when element type is not arithmetic");
+
+    if (order == ByteOrder::NATIVE || sizeof(T) == 1)
+      return readRaw<T>(path, sizes, offset);
+
+    WILT_TRACE_SCOPE("readRaw", sizes, (std::size_t)wilt::detail::size(sizes) * sizeof(T));
+    NArray<T, N> ret(sizes);
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+      throw std::runtime_error("readRaw(): could not open '" + path + "'");
+    file.seekg(offset);
+
+    const std::size_t blockElements = (64 * 1024) / sizeof(T);
+    std::vector<char> block(blockElements * sizeof(T));
+    T* dst = ret.data();
+    for (std::size_t remaining = ret.size(); remaining > 0; )
+    {
+      std::size_t count = std::min(remaining, blockElements);
+      file.read(block.data(), (std::streamsize)(count * sizeof(T)));
+      if (!file)
+        throw std::runtime_error("readRaw(): '" + path + "' is too short");
+
+      detail::swapCopy<sizeof(T)>(block.data(), dst, count);
+      dst += count;
+      remaining -= count;
+    }
+
+    return ret;
+  }
+
+  //! @brief         writes an array to a file as raw elements in row-major
+  //!                order
+  //! @param[in]     path - the file to write, it is replaced if it exists
+  //! @param[in]     arr - the array to write
+  //!
+  //! Throws std::runtime_error if the file can't be written
+  //! Arrays that aren't contiguous and in-order are copied before writing
+  template <class T, std::size_t N>
+  void writeRaw(const std::string& path, const NArray<T, N>& arr)
+  {
+    static_assert(std::is_trivially_copyable<T>::value, "writeRaw(): invalid when element type is not trivially copyable");
+
+    WILT_TRACE_SCOPE("writeRaw", arr.sizes(), (std::size_t)arr.size() * sizeof(T));
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+      throw std::runtime_error("writeRaw(): could not open '" + path + "'");
+    if (arr.empty())
+      return;
+
+    auto data = arr.isContiguous() && arr.isAligned() ? NArray<const T, N>(arr) : NArray<const T, N>(arr.clone());
+    file.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)(data.size() * sizeof(T)));
+    if (!file)
+      throw std::runtime_error("writeRaw(): could not write '" + path + "'");
+  }
+
+} // namespace wilt
+
+#endif // !WILT_RAWIO_HPP
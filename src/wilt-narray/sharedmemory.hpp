@@ -0,0 +1,339 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: sharedmemory.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines arrays backed by named POSIX shared memory
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_SHAREDMEMORY_HPP
+#define WILT_SHAREDMEMORY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "narray.hpp"
+#include "mapping.hpp"
+
+namespace wilt
+{
+namespace detail
+{
+  static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared memory arrays require lock-free 64-bit atomics");
+
+  // The layout at the start of every shared memory segment. The elements start
+  // at 'dataOffset' bytes from the start of the header.
+  struct SharedNArrayHeader
+  {
+    static constexpr std::uint32_t MAGIC = 0x52414E57; // "WNAR"
+    static constexpr std::uint16_t VERSION = 1;
+    static constexpr std::size_t MAX_DIMENSIONS = 16;
+
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint8_t elementType;
+    std::uint8_t dimensions;
+    std::uint32_t elementSize;
+    std::uint32_t reserved;
+    std::uint64_t dataOffset;
+    std::atomic<std::uint64_t> sequence;
+    std::int64_t sizes[MAX_DIMENSIONS];
+    std::int64_t steps[MAX_DIMENSIONS];
+  };
+
+  // The offset where elements start, cache-line aligned
+  constexpr std::size_t sharedDataOffset() noexcept
+  {
+    return (sizeof(SharedNArrayHeader) + 63) / 64 * 64;
+  }
+
+} // namespace detail
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is designed to share an array between processes through a named
+  // POSIX shared memory segment (`shm_open()` + `mmap()`).
+  //
+  // A producer calls 'create()' to make the segment, and consumers call
+  // 'open()' with the same name to map it. The segment starts with a small
+  // header holding the element type, sizes, and steps which 'open()' checks
+  // against `T` and `N`, so consumers see the exact same array. Using a const
+  // `T` maps the segment read-only.
+  //
+  // The header also has a sequence counter for lock-free publishing, used like
+  // a seqlock: the writer makes it odd while writing and even when done, so a
+  // reader can tell if it saw a consistent snapshot.
+  //
+  // SharedNArray<float, 2> out = SharedNArray<float, 2>::create("/frames", { 480, 640 });
+  // out.publish([&](auto& arr) { arr.setTo(frame); });
+  //
+  // SharedNArray<const float, 2> in = SharedNArray<const float, 2>::open("/frames");
+  // in.tryRead([&](auto& arr) { copy.setTo(arr); });
+  //
+  // NOTE: the segment name stays registered until 'unlink()' is called, even
+  // after all processes have unmapped it
+  // NOTE: T must be trivially copyable since its bytes are shared directly
+
+  template <class T, std::size_t N>
+  class SharedNArray
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ASSERTS
+    ////////////////////////////////////////////////////////////////////////////
+    static_assert(std::is_trivially_copyable<T>::value, "SharedNArray<T, N>: T must be trivially copyable");
+    static_assert(N > 0 && N <= detail::SharedNArrayHeader::MAX_DIMENSIONS, "SharedNArray<T, N>: N is out of range");
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    SharedNArray() = default;
+
+    // Creates a new segment with the given name holding an array of 'sizes',
+    // elements are zero-initialized
+    //
+    // NOTE: fails if a segment with the name already exists
+    static SharedNArray<T, N> create(const std::string& name, const Point<N>& sizes)
+    {
+      static_assert(!std::is_const<T>::value, "create(name, sizes): invalid when element type is const");
+
+      if (!wilt::detail::validSize(sizes))
+        throw std::invalid_argument("create(name, sizes): sizes are not valid");
+
+      std::size_t length = detail::sharedDataOffset() + (std::size_t)wilt::detail::size(sizes) * sizeof(T);
+
+      detail::FileDescriptor fd(::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600));
+      if (fd.get() < 0)
+        throw std::runtime_error(detail::errnoMessage("create(name, sizes): shm_open('" + name + "') failed"));
+
+      // the segment is removed again if anything below fails, otherwise it
+      // would be left behind and block the next create() with the name
+      try
+      {
+        if (::ftruncate(fd.get(), (off_t)length) != 0)
+          throw std::runtime_error(detail::errnoMessage("create(name, sizes): ftruncate() failed"));
+
+        auto mapping = std::make_shared<detail::MemoryMapping>(fd.get(), length, true);
+        auto header = new (mapping->data()) detail::SharedNArrayHeader();
+        header->magic = detail::SharedNArrayHeader::MAGIC;
+        header->version = detail::SharedNArrayHeader::VERSION;
+        header->elementType = (std::uint8_t)elementTypeOf<T>();
+        header->dimensions = (std::uint8_t)N;
+        header->elementSize = (std::uint32_t)sizeof(T);
+        header->dataOffset = detail::sharedDataOffset();
+
+        auto steps = wilt::detail::step(sizes);
+        for (std::size_t i = 0; i < N; ++i)
+        {
+          header->sizes[i] = sizes[i];
+          header->steps[i] = steps[i];
+        }
+        header->sequence.store(0, std::memory_order_release);
+
+        return SharedNArray<T, N>(std::move(mapping));
+      }
+      catch (...)
+      {
+        ::shm_unlink(name.c_str());
+        throw;
+      }
+    }
+
+    // Maps an existing segment, throws if its element type or dimensions don't
+    // match the array type
+    static SharedNArray<T, N> open(const std::string& name)
+    {
+      const bool writable = !std::is_const<T>::value;
+
+      detail::FileDescriptor fd(::shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0));
+      if (fd.get() < 0)
+        throw std::runtime_error(detail::errnoMessage("open(name): shm_open('" + name + "') failed"));
+
+      struct stat info;
+      if (::fstat(fd.get(), &info) != 0)
+        throw std::runtime_error(detail::errnoMessage("open(name): fstat() failed"));
+      if ((std::size_t)info.st_size < detail::sharedDataOffset())
+        throw std::runtime_error("open(name): '" + name + "' is too small to be an array");
+
+      auto mapping = std::make_shared<detail::MemoryMapping>(fd.get(), (std::size_t)info.st_size, writable);
+      auto header = reinterpret_cast<const detail::SharedNArrayHeader*>(mapping->data());
+
+      if (header->magic != detail::SharedNArrayHeader::MAGIC || header->version != detail::SharedNArrayHeader::VERSION)
+        throw std::runtime_error("open(name): '" + name + "' is not an array segment");
+      if (header->elementType != (std::uint8_t)elementTypeOf<T>() || header->elementSize != sizeof(T))
+        throw std::runtime_error("open(name): '" + name + "' has a different element type");
+      if (header->dimensions != N)
+        throw std::runtime_error("open(name): '" + name + "' has different dimensions");
+
+      pos_t span = 0;
+      for (std::size_t i = 0; i < N; ++i)
+        span += (header->sizes[i] - 1) * std::abs(header->steps[i]);
+      if (header->dataOffset + (std::size_t)(span + 1) * sizeof(T) > (std::size_t)info.st_size)
+        throw std::runtime_error("open(name): '" + name + "' is too small for its array");
+
+      return SharedNArray<T, N>(std::move(mapping));
+    }
+
+    // Removes the name of a segment, existing mappings remain valid
+    static void unlink(const std::string& name)
+    {
+      if (::shm_unlink(name.c_str()) != 0)
+        throw std::runtime_error(detail::errnoMessage("unlink(name): shm_unlink('" + name + "') failed"));
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // ACCESS FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Gets the array in shared memory, it keeps the segment mapped
+    const NArray<T, N>& array() const noexcept
+    {
+      return array_;
+    }
+
+    // Gets the publish counter, odd while a write is in progress
+    std::uint64_t sequence() const noexcept
+    {
+      return header_()->sequence.load(std::memory_order_acquire);
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // MODIFIER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Marks the start of a write, readers will retry until 'endWrite()'
+    void beginWrite() const noexcept
+    {
+      static_assert(!std::is_const<T>::value, "beginWrite(): invalid when element type is const");
+
+      auto header = header_();
+      header->sequence.store(header->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    // Marks the end of a write, publishing the new contents
+    void endWrite() const noexcept
+    {
+      static_assert(!std::is_const<T>::value, "endWrite(): invalid when element type is const");
+
+      auto header = header_();
+      header->sequence.store(header->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Calls 'write(array())' between 'beginWrite()' and 'endWrite()'
+    //
+    // NOTE: only one process should write at a time
+    template <class Writer>
+    void publish(Writer write) const
+    {
+      beginWrite();
+      try
+      {
+        write(array_);
+      }
+      catch (...)
+      {
+        endWrite();
+        throw;
+      }
+      endWrite();
+    }
+
+    // Calls 'read(array())' and returns true if no write happened during the
+    // call, so anything copied out is a consistent snapshot. Returns false
+    // without calling 'read' if a write is in progress.
+    template <class Reader>
+    bool tryRead(Reader read) const
+    {
+      auto header = header_();
+      std::uint64_t before = header->sequence.load(std::memory_order_acquire);
+      if (before & 1)
+        return false;
+
+      read(array_);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return header->sequence.load(std::memory_order_relaxed) == before;
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    explicit SharedNArray(std::shared_ptr<detail::MemoryMapping> mapping)
+      : mapping_(std::move(mapping))
+      , array_()
+    {
+      auto header = header_();
+
+      Point<N> sizes;
+      Point<N> steps;
+      for (std::size_t i = 0; i < N; ++i)
+      {
+        sizes[i] = (pos_t)header->sizes[i];
+        steps[i] = (pos_t)header->steps[i];
+      }
+
+      // arrays with negative steps start past the beginning of the data
+      pos_t offset = 0;
+      for (std::size_t i = 0; i < N; ++i)
+        if (steps[i] < 0)
+          offset -= steps[i] * (sizes[i] - 1);
+
+      T* data = reinterpret_cast<T*>(mapping_->data() + header->dataOffset) + offset;
+      array_ = NArray<T, N>(std::shared_ptr<T>(mapping_, data), sizes, steps);
+    }
+
+    detail::SharedNArrayHeader* header_() const noexcept
+    {
+      return reinterpret_cast<detail::SharedNArrayHeader*>(mapping_->data());
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::shared_ptr<detail::MemoryMapping> mapping_;
+    NArray<T, N> array_;
+
+  }; // class SharedNArray
+
+} // namespace wilt
+
+#endif // !WILT_SHAREDMEMORY_HPP
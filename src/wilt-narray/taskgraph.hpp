@@ -0,0 +1,405 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: taskgraph.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines a dependency graph for running array operations concurrently
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_TASKGRAPH_HPP
+#define WILT_TASKGRAPH_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "narray.hpp"
+#include "threadpool.hpp"
+
+namespace wilt
+{
+namespace detail
+{
+  // The `DataRegion` class describes the span of memory that an array view can
+  // touch and keeps the data alive while it is held. It is used to determine
+  // if two array operations may conflict.
+  //
+  // Notes:
+  // - the span is conservative, interleaved views (like those from byMember())
+  //   over the same data will be considered overlapping
+  // - empty arrays have an empty span and never overlap
+
+  class DataRegion
+  {
+  public:
+    template <class T, std::size_t N>
+    DataRegion(const NArray<T, N>& arr)
+      : owner_()
+      , first_(nullptr)
+      , last_(nullptr)
+    {
+      if (arr.empty())
+        return;
+
+      const char* base = reinterpret_cast<const char*>(arr.data());
+      pos_t low = 0;
+      pos_t high = 0;
+      for (std::size_t i = 0; i < N; ++i)
+      {
+        pos_t extent = arr.steps()[i] * (arr.sizes()[i] - 1);
+        if (extent < 0)
+          low += extent;
+        else
+          high += extent;
+      }
+
+      owner_ = std::make_shared<NArray<T, N>>(arr);
+      first_ = base + low * (pos_t)sizeof(T);
+      last_ = base + (high + 1) * (pos_t)sizeof(T);
+    }
+
+    bool empty() const noexcept
+    {
+      return first_ == last_;
+    }
+
+    bool overlaps(const DataRegion& other) const noexcept
+    {
+      return !empty() && !other.empty() && first_ < other.last_ && other.first_ < last_;
+    }
+
+  private:
+    std::shared_ptr<const void> owner_;
+    const char* first_;
+    const char* last_;
+
+  }; // class DataRegion
+
+} // namespace detail
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is designed to run a set of array operations concurrently while
+  // respecting the data dependencies between them.
+  //
+  // Each task is a function along with the arrays it reads and the arrays it
+  // writes. When a task is added, it will depend on every earlier task that
+  // writes data it reads or writes, or that reads data it writes. Tasks are
+  // therefore run as if they were called in the order they were added, but
+  // independent branches are run at the same time on the thread pool.
+  //
+  // The graph keeps the arrays and functions of a task only until that task is
+  // complete. So if intermediate arrays are only referenced by the graph (and
+  // the functions that use them), they are destroyed as soon as their last
+  // consumer is finished rather than at the end of the whole pipeline.
+  //
+  // TaskGraph graph;
+  // NArray<float, 2> blurred(size), mask(size);
+  // graph.addTask([=]{ blur(src, blurred); }, { src }, { blurred });
+  // graph.addTask([=]{ threshold(blurred, mask); }, { blurred }, { mask });
+  // graph.addTask([=]{ stats(src); }, { src }, { });
+  // graph.run();
+  //
+  // NOTE: the first exception thrown by a task is rethrown by 'run()', tasks
+  // that depend on a failed task are not run
+
+  class TaskGraph
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // TYPE DEFINITIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    using TaskId = std::size_t;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    TaskGraph() = default;
+    TaskGraph(const TaskGraph&) = delete;
+    TaskGraph(TaskGraph&&) = default;
+
+    TaskGraph& operator= (const TaskGraph&) = delete;
+    TaskGraph& operator= (TaskGraph&&) = default;
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // The number of tasks that have yet to be run
+    std::size_t size() const noexcept
+    {
+      return nodes_.size();
+    }
+
+    // The tasks that must complete before the given task can start
+    std::vector<TaskId> dependencies(TaskId task) const
+    {
+      if (task >= nodes_.size())
+        throw std::out_of_range("dependencies(task): task out of bounds");
+
+      std::vector<TaskId> ret;
+      for (TaskId i = 0; i < task; ++i)
+        for (TaskId successor : nodes_[i].successors)
+          if (successor == task)
+            ret.push_back(i);
+      return ret;
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // MODIFIER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Adds a task that calls 'func' and infers its dependencies from the arrays
+    // it 'reads' and 'writes'
+    template <class Function>
+    TaskId addTask(Function func, std::initializer_list<detail::DataRegion> reads, std::initializer_list<detail::DataRegion> writes)
+    {
+      Node node;
+      node.func = std::move(func);
+      node.reads.assign(reads.begin(), reads.end());
+      node.writes.assign(writes.begin(), writes.end());
+      node.dependencies = 0;
+
+      TaskId id = nodes_.size();
+      for (TaskId i = 0; i < id; ++i)
+      {
+        if (conflicts_(nodes_[i], node))
+        {
+          nodes_[i].successors.push_back(id);
+          node.dependencies += 1;
+        }
+      }
+
+      nodes_.push_back(std::move(node));
+      return id;
+    }
+
+    // Adds a dependency that isn't expressed through data, 'after' will not
+    // start until 'before' is complete
+    void addDependency(TaskId before, TaskId after)
+    {
+      if (before >= nodes_.size() || after >= nodes_.size())
+        throw std::out_of_range("addDependency(before, after): task out of bounds");
+      if (before >= after)
+        throw std::invalid_argument("addDependency(before, after): before must be added earlier than after");
+
+      for (TaskId successor : nodes_[before].successors)
+        if (successor == after)
+          return;
+
+      nodes_[before].successors.push_back(after);
+      nodes_[after].dependencies += 1;
+    }
+
+    // Runs all the tasks and waits for them to complete. The graph is empty
+    // afterwards and can be reused.
+    //
+    // NOTE: if called from a worker of 'pool', the tasks are run in order on
+    // the calling thread to avoid starving the pool
+    void run(ThreadPool& pool = defaultThreadPool())
+    {
+      std::vector<Node> nodes = std::move(nodes_);
+      nodes_.clear();
+
+      if (nodes.empty())
+        return;
+
+      if (pool.isWorker())
+        runSerial_(nodes);
+      else
+        runParallel_(nodes, pool);
+    }
+
+    // Drops all tasks without running them
+    void clear() noexcept
+    {
+      nodes_.clear();
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE TYPES
+    ////////////////////////////////////////////////////////////////////////////
+
+    struct Node
+    {
+      std::function<void()> func;
+      std::vector<detail::DataRegion> reads;
+      std::vector<detail::DataRegion> writes;
+      std::vector<TaskId> successors;
+      std::size_t dependencies;
+    };
+
+    struct RunState
+    {
+      std::vector<Node>* nodes;
+      std::unique_ptr<std::atomic<std::size_t>[]> remaining;
+      std::unique_ptr<std::atomic<bool>[]> skipped;
+      std::size_t completed;
+      std::exception_ptr error;
+      std::mutex mutex;
+      std::condition_variable condition;
+    };
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    static bool conflicts_(const Node& earlier, const Node& later) noexcept
+    {
+      for (auto& w : later.writes)
+      {
+        for (auto& r : earlier.reads)
+          if (w.overlaps(r))
+            return true;
+        for (auto& e : earlier.writes)
+          if (w.overlaps(e))
+            return true;
+      }
+      for (auto& r : later.reads)
+        for (auto& e : earlier.writes)
+          if (r.overlaps(e))
+            return true;
+
+      return false;
+    }
+
+    static void release_(Node& node) noexcept
+    {
+      node.func = nullptr;
+      node.reads.clear();
+      node.writes.clear();
+    }
+
+    static void runSerial_(std::vector<Node>& nodes)
+    {
+      // tasks are added after all their dependencies, so the insertion order
+      // is always a valid order to run them in
+      std::vector<bool> skipped(nodes.size(), false);
+      std::exception_ptr error;
+      for (std::size_t i = 0; i < nodes.size(); ++i)
+      {
+        if (!skipped[i])
+        {
+          try
+          {
+            nodes[i].func();
+          }
+          catch (...)
+          {
+            if (!error)
+              error = std::current_exception();
+            skipped[i] = true;
+          }
+        }
+        if (skipped[i])
+          for (TaskId successor : nodes[i].successors)
+            skipped[successor] = true;
+        release_(nodes[i]);
+      }
+
+      if (error)
+        std::rethrow_exception(error);
+    }
+
+    static void runParallel_(std::vector<Node>& nodes, ThreadPool& pool)
+    {
+      auto state = std::make_shared<RunState>();
+      state->nodes = &nodes;
+      state->remaining.reset(new std::atomic<std::size_t>[nodes.size()]);
+      state->skipped.reset(new std::atomic<bool>[nodes.size()]);
+      state->completed = 0;
+      for (std::size_t i = 0; i < nodes.size(); ++i)
+      {
+        state->remaining[i] = nodes[i].dependencies;
+        state->skipped[i] = false;
+      }
+
+      for (std::size_t i = 0; i < nodes.size(); ++i)
+        if (nodes[i].dependencies == 0)
+          pool.post([state, &pool, i]() { execute_(state, pool, i); });
+
+      std::unique_lock<std::mutex> lock(state->mutex);
+      state->condition.wait(lock, [&]() { return state->completed == nodes.size(); });
+
+      if (state->error)
+        std::rethrow_exception(state->error);
+    }
+
+    static void execute_(const std::shared_ptr<RunState>& state, ThreadPool& pool, TaskId id)
+    {
+      Node& node = (*state->nodes)[id];
+      bool skipped = state->skipped[id];
+      if (!skipped)
+      {
+        try
+        {
+          node.func();
+        }
+        catch (...)
+        {
+          std::lock_guard<std::mutex> lock(state->mutex);
+          if (!state->error)
+            state->error = std::current_exception();
+          skipped = true;
+        }
+      }
+      release_(node);
+
+      for (TaskId successor : node.successors)
+      {
+        if (skipped)
+          state->skipped[successor] = true;
+        if (--state->remaining[successor] == 0)
+          pool.post([state, &pool, successor]() { execute_(state, pool, successor); });
+      }
+
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (++state->completed == state->nodes->size())
+        state->condition.notify_all();
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::vector<Node> nodes_;
+
+  }; // class TaskGraph
+
+} // namespace wilt
+
+#endif // !WILT_TASKGRAPH_HPP
@@ -0,0 +1,253 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: threadpool.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines a simple thread pool used for concurrent array operations
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_THREADPOOL_HPP
+#define WILT_THREADPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace wilt
+{
+  // Parameters that decide how work is split across threads. The defaults are
+  // reasonable everywhere, 'autotune()' in "autotune.hpp" can pick them for
+  // the current machine.
+  struct TuningParameters
+  {
+    std::size_t threads = 0;                   // workers in the default pool, 0 for one per hardware thread
+    std::size_t grainBytes = 1 << 20;          // bytes of work handed to a worker at a time
+    std::size_t parallelThreshold = 1 << 20;   // bytes of work below which it is done serially
+  };
+
+  // Gets the parameters used by the library, they should only be changed at
+  // startup before the library is used from multiple threads
+  inline TuningParameters& tuningParameters()
+  {
+    static TuningParameters params;
+    return params;
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class is designed to run jobs on a fixed set of worker threads.
+  //
+  // Jobs are run in the order they are posted but may complete in any order.
+  // The pool joins all of its workers on destruction after draining any jobs
+  // that are still queued.
+  //
+  // Most users will not need their own pool and can instead use the shared one
+  // returned by `defaultThreadPool()`.
+
+  class ThreadPool
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Creates a pool with 'threads' workers, or one per hardware thread if zero
+    explicit ThreadPool(std::size_t threads = 0)
+      : stopping_(false)
+    {
+      if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+      if (threads == 0)
+        threads = 1;
+
+      workers_.reserve(threads);
+      for (std::size_t i = 0; i < threads; ++i)
+        workers_.emplace_back([this]() { work_(); });
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator= (const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+      }
+      condition_.notify_all();
+      for (auto& worker : workers_)
+        worker.join();
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // The number of worker threads
+    std::size_t size() const noexcept
+    {
+      return workers_.size();
+    }
+
+    // Whether the calling thread is one of this pool's workers
+    bool isWorker() const noexcept
+    {
+      auto id = std::this_thread::get_id();
+      for (auto& worker : workers_)
+        if (worker.get_id() == id)
+          return true;
+      return false;
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // MODIFIER FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Queues a job to be run, exceptions thrown by the job are discarded
+    void post(std::function<void()> job)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        jobs_.push_back(std::move(job));
+      }
+      condition_.notify_one();
+    }
+
+    // Queues a job to be run, the returned future holds the result or the
+    // exception thrown by the job
+    template <class Function>
+    auto submit(Function func) -> std::future<decltype(func())>
+    {
+      using result_type = decltype(func());
+
+      auto task = std::make_shared<std::packaged_task<result_type()>>(std::move(func));
+      auto future = task->get_future();
+      post([task]() { (*task)(); });
+
+      return future;
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    void work_()
+    {
+      for (;;)
+      {
+        std::function<void()> job;
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          condition_.wait(lock, [this]() { return stopping_ || !jobs_.empty(); });
+          if (jobs_.empty())
+            return;
+          job = std::move(jobs_.front());
+          jobs_.pop_front();
+        }
+
+        try
+        {
+          job();
+        }
+        catch (...)
+        {
+
+        }
+      }
+    }
+
+  private:
+    ////////////////////////////////////////////////////////////////////////////
+    // PRIVATE MEMBERS
+    ////////////////////////////////////////////////////////////////////////////
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> jobs_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    bool stopping_;
+
+  }; // class ThreadPool
+
+  // Gets the pool shared by the library, it is created on first use with
+  // 'tuningParameters().threads' workers
+  inline ThreadPool& defaultThreadPool()
+  {
+    static ThreadPool pool(tuningParameters().threads);
+    return pool;
+  }
+
+  //! @brief         gets the number of parallel jobs to split work into
+  //! @param[in]     bytes - the bytes of work
+  //! @return        the number of jobs, 1 if the work is below the parallel
+  //!                threshold, else one per grain
+  inline std::size_t parallelJobs(std::size_t bytes) noexcept
+  {
+    const TuningParameters& params = tuningParameters();
+    if (bytes < params.parallelThreshold || params.grainBytes == 0)
+      return 1;
+    return (bytes + params.grainBytes - 1) / params.grainBytes;
+  }
+
+  //! @brief         calls a function for every index in [0, count) on a pool
+  //!                and waits for them all
+  //! @param[in]     count - the number of indexes
+  //! @param[in]     func - the function to call, as 'func(i)'
+  //! @param[in]     pool - the pool to run on
+  //!
+  //! The first exception thrown by 'func' is rethrown once every call has
+  //! finished. When called from one of the pool's workers, or when there is
+  //! only one index, the calls are made serially on the calling thread since
+  //! waiting on the pool from within it could deadlock.
+  template <class Function>
+  void parallelFor(std::size_t count, Function func, ThreadPool& pool = defaultThreadPool())
+  {
+    if (count <= 1 || pool.isWorker())
+    {
+      for (std::size_t i = 0; i < count; ++i)
+        func(i);
+      return;
+    }
+
+    std::vector<std::future<void>> results;
+    results.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+      results.push_back(pool.submit([&func, i]() { func(i); }));
+
+    for (auto& result : results)
+      result.wait();
+    for (auto& result : results)
+      result.get();
+  }
+
+} // namespace wilt
+
+#endif // !WILT_THREADPOOL_HPP
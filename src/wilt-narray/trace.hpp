@@ -0,0 +1,353 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: trace.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines the tracing of library operations and its Chrome trace export
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_TRACE_HPP
+#define WILT_TRACE_HPP
+
+#ifdef WILT_NARRAY_TRACING
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "point.hpp"
+
+// Records the enclosing scope as a traced operation, see 'TraceScope'
+#define WILT_TRACE_SCOPE(...) wilt::TraceScope wiltTraceScope_(__VA_ARGS__)
+
+namespace wilt
+{
+  // A single traced operation
+  struct TraceEvent
+  {
+    enum : std::size_t { MAX_DIMS = 8 };
+
+    const char* name;         // must be a string that lives forever
+    std::size_t bytes;        // bytes of element data read and written
+    std::uint64_t start;      // nanoseconds since tracing started
+    std::uint64_t duration;   // nanoseconds
+    std::uint32_t thread;     // small sequential id of the recording thread
+    std::uint32_t dims;       // number of dimensions, 0 if there is no shape
+    pos_t shape[MAX_DIMS];    // sizes, only the first 'MAX_DIMS' are kept
+  };
+
+namespace detail
+{
+  inline std::chrono::steady_clock::time_point traceOrigin()
+  {
+    static const auto origin = std::chrono::steady_clock::now();
+    return origin;
+  }
+
+  inline std::uint64_t traceNow()
+  {
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceOrigin()).count();
+  }
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class holds the events recorded by one thread. Only the owning thread
+  // adds events and it never waits, the events are stored in fixed chunks that
+  // are never moved so that other threads can read the committed ones at the
+  // same time.
+
+  class TraceBuffer
+  {
+  public:
+    enum : std::size_t { CHUNK_SIZE = 1024 };
+
+    explicit TraceBuffer(std::uint32_t thread)
+      : thread_(thread)
+      , tail_(&head_)
+      , count_(0)
+      , first_(0)
+    { }
+
+    ~TraceBuffer()
+    {
+      Chunk* chunk = head_.next.load(std::memory_order_relaxed);
+      while (chunk)
+      {
+        Chunk* next = chunk->next.load(std::memory_order_relaxed);
+        delete chunk;
+        chunk = next;
+      }
+    }
+
+    std::uint32_t thread() const noexcept
+    {
+      return thread_;
+    }
+
+    // called only by the owning thread
+    void push(const TraceEvent& event)
+    {
+      std::size_t index = count_.load(std::memory_order_relaxed);
+      if (index > 0 && index % CHUNK_SIZE == 0)
+      {
+        Chunk* chunk = new Chunk();
+        tail_->next.store(chunk, std::memory_order_release);
+        tail_ = chunk;
+      }
+      tail_->events[index % CHUNK_SIZE] = event;
+      count_.store(index + 1, std::memory_order_release);
+    }
+
+    // calls func with each event recorded since the last 'discard()'
+    template <class Function>
+    void forEach(Function func) const
+    {
+      std::size_t count = count_.load(std::memory_order_acquire);
+      std::size_t first = first_.load(std::memory_order_relaxed);
+      const Chunk* chunk = &head_;
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        if (i > 0 && i % CHUNK_SIZE == 0)
+          chunk = chunk->next.load(std::memory_order_acquire);
+        if (i >= first)
+          func(chunk->events[i % CHUNK_SIZE]);
+      }
+    }
+
+    // hides the events recorded so far, their memory is kept since the owning
+    // thread may be writing next to them
+    void discard() noexcept
+    {
+      first_.store(count_.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+
+  private:
+    struct Chunk
+    {
+      TraceEvent events[CHUNK_SIZE];
+      std::atomic<Chunk*> next{ nullptr };
+    };
+
+    std::uint32_t thread_;
+    Chunk head_;
+    Chunk* tail_;
+    std::atomic<std::size_t> count_;
+    std::atomic<std::size_t> first_;
+
+  }; // class TraceBuffer
+
+  // The buffers of every thread that has traced something, buffers of threads
+  // that have exited are kept so their events can still be exported
+  class TraceRegistry
+  {
+  public:
+    std::shared_ptr<TraceBuffer> create()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      buffers_.push_back(std::make_shared<TraceBuffer>((std::uint32_t)buffers_.size() + 1));
+      return buffers_.back();
+    }
+
+    std::vector<std::shared_ptr<TraceBuffer>> buffers() const
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return buffers_;
+    }
+
+  private:
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<TraceBuffer>> buffers_;
+
+  }; // class TraceRegistry
+
+  inline TraceRegistry& traceRegistry()
+  {
+    static TraceRegistry* registry = new TraceRegistry();
+    return *registry;
+  }
+
+  inline TraceBuffer& localTraceBuffer()
+  {
+    static thread_local std::shared_ptr<TraceBuffer> buffer = traceRegistry().create();
+    return *buffer;
+  }
+
+  inline void writeJsonString(std::ostream& out, const char* str)
+  {
+    out << '"';
+    for (; *str; ++str)
+    {
+      if (*str == '"' || *str == '\\')
+        out << '\\' << *str;
+      else if ((unsigned char)*str < 0x20)
+        out << ' ';
+      else
+        out << *str;
+    }
+    out << '"';
+  }
+
+  // the trace format uses microseconds, this keeps nanosecond precision
+  inline std::array<char, 32> formatMicroseconds(std::uint64_t ns)
+  {
+    std::array<char, 32> buffer;
+    std::snprintf(buffer.data(), buffer.size(), "%llu.%03u", (unsigned long long)(ns / 1000), (unsigned)(ns % 1000));
+    return buffer;
+  }
+
+} // namespace detail
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class records the time between its construction and destruction as a
+  // traced operation on the current thread. The library uses it through
+  // 'WILT_TRACE_SCOPE' for element-wise operations, copies, reductions,
+  // allocations, and file I/O, but it can be used to mark user operations too.
+  //
+  // {
+  //   WILT_TRACE_SCOPE("denoise", frame.sizes(), frame.size() * sizeof(float));
+  //   ...
+  // }
+  //
+  // NOTE: 'name' must point to a string that outlives the trace, like a literal
+
+  class TraceScope
+  {
+  public:
+    TraceScope(const char* name, std::size_t bytes = 0) noexcept
+    {
+      event_.name = name;
+      event_.bytes = bytes;
+      event_.dims = 0;
+      event_.start = wilt::detail::traceNow();
+    }
+
+    template <std::size_t N>
+    TraceScope(const char* name, const Point<N>& shape, std::size_t bytes) noexcept
+    {
+      event_.name = name;
+      event_.bytes = bytes;
+      event_.dims = (std::uint32_t)(N < TraceEvent::MAX_DIMS ? N : TraceEvent::MAX_DIMS);
+      for (std::size_t i = 0; i < event_.dims; ++i)
+        event_.shape[i] = shape[i];
+      event_.start = wilt::detail::traceNow();
+    }
+
+    ~TraceScope()
+    {
+      event_.duration = wilt::detail::traceNow() - event_.start;
+      try
+      {
+        auto& buffer = wilt::detail::localTraceBuffer();
+        event_.thread = buffer.thread();
+        buffer.push(event_);
+      }
+      catch (...)
+      {
+        // dropping the event is better than failing the operation
+      }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator= (const TraceScope&) = delete;
+
+  private:
+    TraceEvent event_;
+
+  }; // class TraceScope
+
+  //! @brief         gets the events recorded by all threads since the last
+  //!                'clearTrace()'
+  //! @return        the events, grouped by thread and in order within each
+  inline std::vector<TraceEvent> traceEvents()
+  {
+    std::vector<TraceEvent> ret;
+    for (auto& buffer : wilt::detail::traceRegistry().buffers())
+      buffer->forEach([&](const TraceEvent& event) { ret.push_back(event); });
+    return ret;
+  }
+
+  //! @brief         hides the events recorded so far from later exports
+  inline void clearTrace()
+  {
+    for (auto& buffer : wilt::detail::traceRegistry().buffers())
+      buffer->discard();
+  }
+
+  //! @brief         writes the recorded events in the Chrome trace event
+  //!                format, which can be opened in chrome://tracing or
+  //!                Perfetto
+  //! @param[in]     out - the stream to write to
+  inline void writeChromeTrace(std::ostream& out)
+  {
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (auto& buffer : wilt::detail::traceRegistry().buffers())
+    {
+      buffer->forEach([&](const TraceEvent& event) {
+        out << (first ? "\n" : ",\n");
+        first = false;
+
+        out << "{\"name\":";
+        wilt::detail::writeJsonString(out, event.name);
+        out << ",\"cat\":\"wilt\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+            << ",\"ts\":" << wilt::detail::formatMicroseconds(event.start).data()
+            << ",\"dur\":" << wilt::detail::formatMicroseconds(event.duration).data()
+            << ",\"args\":{\"bytes\":" << event.bytes << ",\"shape\":[";
+        for (std::size_t i = 0; i < event.dims; ++i)
+          out << (i ? "," : "") << event.shape[i];
+        out << "]}}";
+      });
+    }
+    out << "\n]}\n";
+  }
+
+  //! @brief         writes the recorded events to a file in the Chrome trace
+  //!                event format
+  //! @param[in]     path - the file to write
+  inline void writeChromeTrace(const std::string& path)
+  {
+    std::ofstream file(path);
+    if (!file)
+      throw std::runtime_error("writeChromeTrace(path): failed to open " + path);
+    writeChromeTrace(file);
+    if (!file)
+      throw std::runtime_error("writeChromeTrace(path): failed to write " + path);
+  }
+
+} // namespace wilt
+
+#else
+
+#define WILT_TRACE_SCOPE(...) ((void)0)
+
+#endif // WILT_NARRAY_TRACING
+
+#endif // !WILT_TRACE_HPP
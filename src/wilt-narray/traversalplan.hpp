@@ -0,0 +1,303 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: traversalplan.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Defines reusable traversal plans for arrays with the same geometry
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef WILT_TRAVERSALPLAN_HPP
+#define WILT_TRAVERSALPLAN_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "narray.hpp"
+
+namespace wilt
+{
+namespace detail
+{
+  // Runs the element loops on the last 'dims' of the N dimensions of
+  // condensed size and step arrays, so a plan only pays for the loops it
+  // actually needs
+  template <std::size_t N>
+  struct PlanLoops
+  {
+    template <class T, class Functor>
+    static void unary(std::size_t dims, const pos_t* sizes, T* data, const pos_t* steps, Functor& f)
+    {
+      if (dims >= N)
+        unaryHelper<N, T, Functor>::call(sizes, data, steps, f);
+      else
+        PlanLoops<N-1>::unary(dims, sizes + 1, data, steps + 1, f);
+    }
+
+    template <class T, class U, class Functor>
+    static void binary(std::size_t dims, const pos_t* sizes, T* data1, const pos_t* steps1, U* data2, const pos_t* steps2, Functor& f)
+    {
+      if (dims >= N)
+        binaryHelper<N, T, U, Functor>::call(sizes, data1, steps1, data2, steps2, f);
+      else
+        PlanLoops<N-1>::binary(dims, sizes + 1, data1, steps1 + 1, data2, steps2 + 1, f);
+    }
+  };
+
+  template <>
+  struct PlanLoops<1>
+  {
+    template <class T, class Functor>
+    static void unary(std::size_t, const pos_t* sizes, T* data, const pos_t* steps, Functor& f)
+    {
+      unaryHelper<1, T, Functor>::call(sizes, data, steps, f);
+    }
+
+    template <class T, class U, class Functor>
+    static void binary(std::size_t, const pos_t* sizes, T* data1, const pos_t* steps1, U* data2, const pos_t* steps2, Functor& f)
+    {
+      binaryHelper<1, T, U, Functor>::call(sizes, data1, steps1, data2, steps2, f);
+    }
+  };
+
+} // namespace detail
+
+  //////////////////////////////////////////////////////////////////////////////
+  // This class holds the work 'foreach()', 'setTo()' and 'convertTo()' do
+  // before touching any elements: checking the arrays, condensing their sizes
+  // and steps, and picking the loops. A plan is made once for a geometry and
+  // can then be run on any arrays with the same sizes and steps, which makes a
+  // difference when the same operation is done on many small tiles.
+  //
+  // NArray<float, 2> tile({ 8, 8 });
+  // TraversalPlan<2> plan(tile, image.subarray({ 0, 0 }, { 8, 8 }));
+  // for (pos_t x = 0; x + 8 <= image.sizes()[1]; x += 8)
+  // {
+  //   plan.convertTo(tile, image.subarray({ 0, x }, { 8, 8 }));
+  //   process(tile);
+  // }
+  //
+  // A plan is made for one array or for a destination and a source, and can
+  // only run operations on that many arrays. Running it checks that the
+  // arrays' sizes and steps are the ones it was made for, and throws
+  // 'std::invalid_argument' if not.
+
+  template <std::size_t N>
+  class TraversalPlan
+  {
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // CONSTRUCTORS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // Creates an empty plan that matches no arrays
+    TraversalPlan() noexcept
+      : arrays_(0)
+      , dims_(0)
+      , empty_(true)
+    {
+
+    }
+
+    // Creates a plan for operations on one array with the same geometry
+    template <class T>
+    explicit TraversalPlan(const NArray<T, N>& arr) noexcept
+      : sizes_(arr.sizes())
+      , steps1_(arr.steps())
+      , steps2_(arr.steps())
+      , arrays_(1)
+      , empty_(arr.empty())
+    {
+      condensedSizes_ = sizes_;
+      condensedSteps1_ = steps1_;
+      condensedSteps2_ = steps2_;
+      dims_ = detail::condense(condensedSizes_, condensedSteps1_);
+    }
+
+    // Creates a plan for operations from a source array into a destination
+    // array with the same geometries, throws std::invalid_argument if their
+    // sizes don't match
+    template <class T, class U>
+    TraversalPlan(const NArray<T, N>& dst, const NArray<U, N>& src)
+      : sizes_(dst.sizes())
+      , steps1_(dst.steps())
+      , steps2_(src.steps())
+      , arrays_(2)
+      , empty_(dst.empty())
+    {
+      if (dst.sizes() != src.sizes())
+        throw std::invalid_argument("TraversalPlan(dst, src): dimensions must match");
+
+      condensedSizes_ = sizes_;
+      condensedSteps1_ = steps1_;
+      condensedSteps2_ = steps2_;
+      dims_ = detail::condense(condensedSizes_, condensedSteps1_, condensedSteps2_);
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // QUERY FUNCTIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    // The number of arrays the plan runs on, 0 if empty
+    std::size_t arrays() const noexcept { return arrays_; }
+
+    // The number of loops the plan runs after condensing
+    std::size_t dims() const noexcept { return dims_; }
+
+    // The sizes the plan was made for
+    const Point<N>& sizes() const noexcept { return sizes_; }
+
+    // True if every array is traversed as a single run of adjacent elements
+    bool isLinear() const noexcept
+    {
+      return dims_ == 1 && condensedSteps1_[N-1] == 1 && (arrays_ < 2 || condensedSteps2_[N-1] == 1);
+    }
+
+    // True if the plan can run on this array
+    template <class T>
+    bool matches(const NArray<T, N>& arr) const noexcept
+    {
+      return arrays_ == 1 && arr.sizes() == sizes_ && arr.steps() == steps1_;
+    }
+
+    // True if the plan can run on these arrays
+    template <class T, class U>
+    bool matches(const NArray<T, N>& dst, const NArray<U, N>& src) const noexcept
+    {
+      return arrays_ == 2 && dst.sizes() == sizes_ && dst.steps() == steps1_ && src.sizes() == sizes_ && src.steps() == steps2_;
+    }
+
+  public:
+    ////////////////////////////////////////////////////////////////////////////
+    // OPERATIONS
+    ////////////////////////////////////////////////////////////////////////////
+
+    //! @brief         calls an operation on every element in order, like
+    //!                'foreach()'
+    //! @param[in]     arr - the array, must match the plan
+    //! @param[in]     op - function or function object with the signature
+    //!                void(T&) or similar
+    //! @throws        std::invalid_argument if the array doesn't match
+    template <class T, class Operator>
+    void foreach(const NArray<T, N>& arr, Operator op) const
+    {
+      if (!matches(arr))
+        throw std::invalid_argument("foreach(arr, op): array doesn't match the plan");
+      if (empty_)
+        return;
+
+      run_(arr.data(), op);
+    }
+
+    //! @brief         sets every element to a value, like 'setTo(val)'
+    //! @param[in]     arr - the array, must match the plan
+    //! @param[in]     val - the value
+    //! @throws        std::invalid_argument if the array doesn't match
+    template <class T>
+    void setTo(const NArray<T, N>& arr, const T& val) const
+    {
+      static_assert(!std::is_const<T>::value, "setTo(arr, val): invalid when element type is const");
+
+      if (!matches(arr))
+        throw std::invalid_argument("setTo(arr, val): array doesn't match the plan");
+      if (empty_)
+        return;
+
+      run_(arr.data(), [&val](T& r) { r = val; });
+    }
+
+    //! @brief         copies the elements of one array into another, like
+    //!                'dst.setTo(src)'
+    //! @param[in]     dst - the destination array, must match the plan
+    //! @param[in]     src - the source array, must match the plan
+    //! @throws        std::invalid_argument if the arrays don't match
+    template <class T, class U>
+    void setTo(const NArray<T, N>& dst, const NArray<U, N>& src) const
+    {
+      static_assert(!std::is_const<T>::value, "setTo(dst, src): invalid when element type is const");
+      static_assert(std::is_same<T, typename std::remove_const<U>::type>::value, "setTo(dst, src): element types must match");
+
+      if (!matches(dst, src))
+        throw std::invalid_argument("setTo(dst, src): arrays don't match the plan");
+      if (empty_)
+        return;
+
+      run_(dst.data(), src.data(), [](T& r, const U& v) { r = v; });
+    }
+
+    //! @brief         converts the elements of one array into another, like
+    //!                'src.convertTo<T>()' but into an existing array
+    //! @param[in]     dst - the destination array, must match the plan
+    //! @param[in]     src - the source array, must match the plan
+    //! @param[in]     func - function or function object with the signature
+    //!                T(U) or similar, a static_cast by default
+    //! @throws        std::invalid_argument if the arrays don't match
+    template <class T, class U>
+    void convertTo(const NArray<T, N>& dst, const NArray<U, N>& src) const
+    {
+      convertTo(dst, src, [](const U& u) { return static_cast<T>(u); });
+    }
+
+    template <class T, class U, class Converter>
+    void convertTo(const NArray<T, N>& dst, const NArray<U, N>& src, Converter func) const
+    {
+      static_assert(!std::is_const<T>::value, "convertTo(dst, src, func): invalid when destination element type is const");
+
+      if (!matches(dst, src))
+        throw std::invalid_argument("convertTo(dst, src, func): arrays don't match the plan");
+      if (empty_)
+        return;
+
+      run_(dst.data(), src.data(), [&func](T& t, const U& u) { t = func(u); });
+    }
+
+  private:
+    template <class T, class Functor>
+    void run_(T* data, Functor&& f) const
+    {
+      detail::PlanLoops<N>::unary(dims_, condensedSizes_.data(), data, condensedSteps1_.data(), f);
+    }
+
+    template <class T, class U, class Functor>
+    void run_(T* data1, U* data2, Functor&& f) const
+    {
+      detail::PlanLoops<N>::binary(dims_, condensedSizes_.data(),
+        data1, condensedSteps1_.data(),
+        data2, condensedSteps2_.data(), f);
+    }
+
+    Point<N> sizes_;
+    Point<N> steps1_;
+    Point<N> steps2_;
+    Point<N> condensedSizes_;
+    Point<N> condensedSteps1_;
+    Point<N> condensedSteps2_;
+    std::size_t arrays_;
+    std::size_t dims_;
+    bool empty_;
+
+  }; // class TraversalPlan
+
+} // namespace wilt
+
+#endif // !WILT_TRAVERSALPLAN_HPP
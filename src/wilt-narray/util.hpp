@@ -28,10 +28,15 @@
 #ifndef WILT_UTIL_HPP
 #define WILT_UTIL_HPP
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <type_traits>
 #include <vector>
 
+#include "dispatch.hpp"
 #include "point.hpp"
 
 namespace wilt
@@ -39,8 +44,161 @@ namespace wilt
   // type aliases
   using pos_t = std::ptrdiff_t;
 
+  // Identifies the arithmetic element types when arrays leave the type system,
+  // like when they are written to files or shared with other processes
+  enum class ElementType : std::uint8_t
+  {
+    UNKNOWN = 0,
+    BOOL,
+    INT8,
+    UINT8,
+    INT16,
+    UINT16,
+    INT32,
+    UINT32,
+    INT64,
+    UINT64,
+    FLOAT32,
+    FLOAT64
+  };
+
+  // Gets the element type code for 'T', or UNKNOWN if it isn't arithmetic
+  template <class T>
+  constexpr ElementType elementTypeOf() noexcept
+  {
+    using U = typename std::remove_cv<T>::type;
+
+    if (std::is_same<U, bool>::value)
+      return ElementType::BOOL;
+    if (std::is_integral<U>::value && std::is_signed<U>::value)
+      return sizeof(U) == 1 ? ElementType::INT8
+           : sizeof(U) == 2 ? ElementType::INT16
+           : sizeof(U) == 4 ? ElementType::INT32
+           : sizeof(U) == 8 ? ElementType::INT64
+           : ElementType::UNKNOWN;
+    if (std::is_integral<U>::value)
+      return sizeof(U) == 1 ? ElementType::UINT8
+           : sizeof(U) == 2 ? ElementType::UINT16
+           : sizeof(U) == 4 ? ElementType::UINT32
+           : sizeof(U) == 8 ? ElementType::UINT64
+           : ElementType::UNKNOWN;
+    if (std::is_floating_point<U>::value)
+      return sizeof(U) == 4 ? ElementType::FLOAT32
+           : sizeof(U) == 8 ? ElementType::FLOAT64
+           : ElementType::UNKNOWN;
+
+    return ElementType::UNKNOWN;
+  }
+
+  // Controls the software prefetching done by the element loops. Loops whose
+  // step is at least 'minStrideBytes' fetch elements ahead of their use since
+  // the hardware prefetchers don't follow strides that cross pages. The
+  // distance ahead is 'windowBytes' divided by the step, within the limits.
+  struct PrefetchParameters
+  {
+    std::size_t minStrideBytes = 2048;    // smaller steps are left to the hardware
+    std::size_t windowBytes = 256 << 10;  // the span of memory to fetch ahead over
+    pos_t minDistance = 4;                // the fewest elements to fetch ahead
+    pos_t maxDistance = 32;               // the most elements to fetch ahead, 0 to disable
+  };
+
+  // Gets the prefetch parameters used by the library, they should only be
+  // changed at startup before the library is used from multiple threads
+  inline PrefetchParameters& prefetchParameters() noexcept
+  {
+    static PrefetchParameters params;
+    return params;
+  }
+
 namespace detail
 {
+  // Gets how many elements ahead to prefetch in a loop over 'count' elements
+  // that are 'stride' bytes apart, 0 if it shouldn't prefetch
+  inline pos_t prefetchDistance(pos_t stride, pos_t count) noexcept
+  {
+    const PrefetchParameters& params = prefetchParameters();
+    const std::size_t bytes = (std::size_t)(stride < 0 ? -stride : stride);
+    if (bytes < params.minStrideBytes || params.maxDistance <= 0)
+      return 0;
+
+    pos_t distance = (pos_t)(params.windowBytes / bytes);
+    distance = std::min(std::max(distance, params.minDistance), params.maxDistance);
+    return distance < count ? distance : 0;
+  }
+
+  // Hints that the element at 'ptr' will be used soon, for writing unless it
+  // is const
+  template <class T>
+  inline void prefetch(T* ptr) noexcept
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(ptr, std::is_const<T>::value ? 0 : 1, 3);
+#else
+    (void)ptr;
+#endif
+  }
+
+  // The shortest contiguous row that is handed to a dispatched kernel, shorter
+  // rows aren't worth the indirect call
+  const pos_t DISPATCH_MIN_ROW = 16;
+
+  // Calls 'Kernel::run()' through a function compiled for the instruction set
+  // level picked by 'cpuLevel()'. The variants only differ by their target
+  // attribute, the compiler vectorizes the inlined kernel differently in each.
+  // The choice is made on the first call and kept in a function pointer.
+  template <class Kernel, class... Args>
+  struct Dispatched {
+    using function_type = void(*)(Args...);
+
+    static void generic(Args... args) { Kernel::run(args...); }
+#ifdef WILT_HAS_TARGET_DISPATCH
+    WILT_TARGET("ssse3,sse4.2") static void sse42(Args... args) { Kernel::run(args...); }
+    WILT_TARGET("avx2") static void avx2(Args... args) { Kernel::run(args...); }
+    WILT_TARGET("avx512f,avx512bw,avx512vl") static void avx512(Args... args) { Kernel::run(args...); }
+#endif
+
+    static function_type select(CpuLevel level) noexcept {
+      switch (level) {
+#ifdef WILT_HAS_TARGET_DISPATCH
+      case CpuLevel::AVX512: return &avx512;
+      case CpuLevel::AVX2: return &avx2;
+      case CpuLevel::SSE42: return &sse42;
+#endif
+      default: return &generic;
+      }
+    }
+
+    static void call(Args... args) {
+      static const function_type function = select(cpuLevel());
+      function(args...);
+    }
+  };
+
+  // Kernels for contiguous rows used by the helpers below
+  template <class T, class U, class V, class Functor>
+  struct TernaryRow {
+    static WILT_ALWAYS_INLINE void run(pos_t count, T* data1, U* data2, V* data3, Functor& f) {
+      for (T* end = data1 + count; data1 != end; ++data1, ++data2, ++data3)
+        f(*data1, *data2, *data3);
+    }
+  };
+
+  template <class T, class U, class Functor>
+  struct BinaryRow {
+    static WILT_ALWAYS_INLINE void run(pos_t count, T* data1, U* data2, Functor& f) {
+      for (T* end = data1 + count; data1 != end; ++data1, ++data2)
+        f(*data1, *data2);
+    }
+  };
+
+  template <class T, class Functor>
+  struct UnaryRow {
+    static WILT_ALWAYS_INLINE void run(pos_t count, T* data, Functor& f) {
+      for (T* end = data + count; data != end; ++data)
+        f(*data);
+    }
+  };
+
   // Calls a functor on all corresponding elements from three arrays that are
   // accessed by their provided size and step pointers. 
   //
@@ -52,7 +210,7 @@ namespace detail
   template <std::size_t N, class T, class U, class V, class Functor>
   struct ternaryHelper {
     static void call(const pos_t* sizes, T* data1, const pos_t* steps1, U* data2, const pos_t* steps2, V* data3, const pos_t* steps3, Functor& f) {
-      for (T* end = data1 + *sizes * *steps1; data1 != end; data1 += *steps1, data2 += *steps2, data3 += *steps3)
+      for (pos_t i = *sizes; i > 0; --i, data1 += *steps1, data2 += *steps2, data3 += *steps3)
         ternaryHelper<N-1, T, U, V, Functor>::call(sizes + 1, data1, steps1 + 1, data2, steps2 + 1, data3, steps3 + 1, f);
     }
   };
@@ -60,7 +218,21 @@ namespace detail
   template <class T, class U, class V, class Functor>
   struct ternaryHelper<1u, T, U, V, Functor> {
     static void call(const pos_t* sizes, T* data1, const pos_t* steps1, U* data2, const pos_t* steps2, V* data3, const pos_t* steps3, Functor& f) {
-      for (T* end = data1 + *sizes * *steps1; data1 != end; data1 += *steps1, data2 += *steps2, data3 += *steps3)
+      if (*steps1 == 1 && *steps2 == 1 && *steps3 == 1 && *sizes >= DISPATCH_MIN_ROW)
+        return Dispatched<TernaryRow<T, U, V, Functor>, pos_t, T*, U*, V*, Functor&>::call(*sizes, data1, data2, data3, f);
+
+      pos_t count = *sizes;
+      const pos_t stride = std::max({ std::abs(*steps1 * (pos_t)sizeof(T)), std::abs(*steps2 * (pos_t)sizeof(U)), std::abs(*steps3 * (pos_t)sizeof(V)) });
+      const pos_t ahead = prefetchDistance(stride, count);
+      if (ahead > 0) {
+        for (; count > ahead; --count, data1 += *steps1, data2 += *steps2, data3 += *steps3) {
+          prefetch(data1 + ahead * *steps1);
+          prefetch(data2 + ahead * *steps2);
+          prefetch(data3 + ahead * *steps3);
+          f(*data1, *data2, *data3);
+        }
+      }
+      for (; count > 0; --count, data1 += *steps1, data2 += *steps2, data3 += *steps3)
         f(*data1, *data2, *data3);
     }
   };
@@ -82,7 +254,7 @@ namespace detail
   template <std::size_t N, class T, class U, class Functor>
   struct binaryHelper {
     static void call(const pos_t* sizes, T* data1, const pos_t* steps1, U* data2, const pos_t* steps2, Functor& f) {
-      for (T* end = data1 + *sizes * *steps1; data1 != end; data1 += *steps1, data2 += *steps2)
+      for (pos_t i = *sizes; i > 0; --i, data1 += *steps1, data2 += *steps2)
         binaryHelper<N-1, T, U, Functor>::call(sizes + 1, data1, steps1 + 1, data2, steps2 + 1, f);
     }
   };
@@ -90,7 +262,20 @@ namespace detail
   template <class T, class U, class Functor>
   struct binaryHelper<1u, T, U, Functor> {
     static void call(const pos_t* sizes, T* data1, const pos_t* steps1, U* data2, const pos_t* steps2, Functor& f) {
-      for (T* end = data1 + *sizes * *steps1; data1 != end; data1 += *steps1, data2 += *steps2)
+      if (*steps1 == 1 && *steps2 == 1 && *sizes >= DISPATCH_MIN_ROW)
+        return Dispatched<BinaryRow<T, U, Functor>, pos_t, T*, U*, Functor&>::call(*sizes, data1, data2, f);
+
+      pos_t count = *sizes;
+      const pos_t stride = std::max(std::abs(*steps1 * (pos_t)sizeof(T)), std::abs(*steps2 * (pos_t)sizeof(U)));
+      const pos_t ahead = prefetchDistance(stride, count);
+      if (ahead > 0) {
+        for (; count > ahead; --count, data1 += *steps1, data2 += *steps2) {
+          prefetch(data1 + ahead * *steps1);
+          prefetch(data2 + ahead * *steps2);
+          f(*data1, *data2);
+        }
+      }
+      for (; count > 0; --count, data1 += *steps1, data2 += *steps2)
         f(*data1, *data2);
     }
   };
@@ -111,7 +296,7 @@ namespace detail
   template <std::size_t N, class T, class Functor>
   struct unaryHelper {
     static void call(const pos_t* sizes, T* data, const pos_t* steps, Functor& f) {
-      for (T* end = data + *sizes * *steps; data != end; data += *steps)
+      for (pos_t i = *sizes; i > 0; --i, data += *steps)
         unaryHelper<N-1, T, Functor>::call(sizes + 1, data, steps + 1, f);
     }
   };
@@ -119,7 +304,18 @@ namespace detail
   template <class T, class Functor>
   struct unaryHelper<1u, T, Functor> {
     static void call(const pos_t* sizes, T* data, const pos_t* steps, Functor& f) {
-      for (T* end = data + *sizes * *steps; data != end; data += *steps)
+      if (*steps == 1 && *sizes >= DISPATCH_MIN_ROW)
+        return Dispatched<UnaryRow<T, Functor>, pos_t, T*, Functor&>::call(*sizes, data, f);
+
+      pos_t count = *sizes;
+      const pos_t ahead = prefetchDistance(*steps * (pos_t)sizeof(T), count);
+      if (ahead > 0) {
+        for (; count > ahead; --count, data += *steps) {
+          prefetch(data + ahead * *steps);
+          f(*data);
+        }
+      }
+      for (; count > 0; --count, data += *steps)
         f(*data);
     }
   };
@@ -149,16 +345,15 @@ namespace detail
     Operator op, 
     std::size_t n)
   {
-    const T* end = src1 + sizes[0] * s1steps[0];
     if (n == 1)
     {
-      for (; src1 != end; src1 += s1steps[0], src2 += s2steps[0])
+      for (pos_t i = sizes[0]; i > 0; --i, src1 += s1steps[0], src2 += s2steps[0])
         if (!op(src1[0], src2[0]))
           return false;
     }
     else
     {
-      for (; src1 != end; src1 += s1steps[0], src2 += s2steps[0])
+      for (pos_t i = sizes[0]; i > 0; --i, src1 += s1steps[0], src2 += s2steps[0])
         if (!allOf(src1, src2, sizes + 1, s1steps + 1, s2steps + 1, op, n - 1))
           return false;
     }
@@ -180,16 +375,15 @@ namespace detail
     Operator op,
     std::size_t n)
   {
-    const T* end = src + sizes[0] * ssteps[0];
     if (n == 1)
     {
-      for (; src != end; src += ssteps[0])
+      for (pos_t i = sizes[0]; i > 0; --i, src += ssteps[0])
         if (!op(src[0]))
           return false;
     }
     else
     {
-      for (; src != end; src += ssteps[0])
+      for (pos_t i = sizes[0]; i > 0; --i, src += ssteps[0])
         if (!allOf(src, sizes + 1, ssteps + 1, op, n - 1))
           return false;
     }
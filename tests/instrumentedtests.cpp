@@ -0,0 +1,204 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: instrumentedtests.cpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: Tests for the wilt NArray library built with instrumentation enabled
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// These tests cover the instrumentation that is compiled out by default. The
+// macros change what the library compiles to and must match in every
+// translation unit, so this file is built into its own test executable with
+// tests.cpp rather than alongside narraytests.cpp.
+
+#include <catch2/catch.hpp>
+
+#define WILT_NARRAY_MEMORY_REGISTRY
+#define WILT_NARRAY_TRACING
+#define WILT_NARRAY_DIAGNOSTICS
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "../src/wilt-narray/narray.hpp"
+
+TEST_CASE("memoryRegistry() tracks live data blocks by tag")
+{
+  // arrange
+  auto& registry = wilt::memoryRegistry();
+  auto before = registry.liveBytes();
+  registry.resetPeak();
+  wilt::NArray<double, 2> arr;
+
+  // act
+  {
+    wilt::MemoryTag tag("registry-test");
+    arr = wilt::NArray<double, 2>({ 100, 10 });
+  }
+  auto view = arr.rangeX(0, 10);
+  auto blocks = registry.blocks();
+  auto block = std::find_if(blocks.begin(), blocks.end(), [](const wilt::MemoryBlockInfo& info) { return info.tag == "registry-test"; });
+  std::ostringstream dump;
+  registry.dump(dump);
+
+  // assert
+  REQUIRE(wilt::MemoryRegistry::enabled());
+  REQUIRE(registry.liveBytes() == before + 8000);
+  REQUIRE(registry.bytesByTag()["registry-test"] == 8000);
+  REQUIRE(block != blocks.end());
+  REQUIRE(block->bytes == 8000);
+  REQUIRE(block->views == 2);
+  REQUIRE(dump.str().find("[registry-test] 8000 bytes") != std::string::npos);
+
+  arr.clear();
+  view.clear();
+  REQUIRE(registry.liveBytes() == before);
+  REQUIRE(registry.peakBytes() >= before + 8000);
+}
+
+TEST_CASE("WILT_TRACE_SCOPE records library operations with shapes and bytes")
+{
+  // arrange
+  wilt::NArray<float, 2> a({ 3, 4 }, 1.0f);
+  wilt::NArray<float, 2> b({ 3, 4 }, 2.0f);
+  wilt::clearTrace();
+
+  // act
+  auto c = a + b;
+  {
+    WILT_TRACE_SCOPE("user-op");
+  }
+  auto events = wilt::traceEvents();
+  std::ostringstream json;
+  wilt::writeChromeTrace(json);
+
+  // assert
+  auto op = std::find_if(events.begin(), events.end(), [](const wilt::TraceEvent& e) { return std::string(e.name) == "binaryOp"; });
+  REQUIRE(op != events.end());
+  REQUIRE(op->dims == 2);
+  REQUIRE(op->shape[0] == 3);
+  REQUIRE(op->shape[1] == 4);
+  REQUIRE(op->bytes == 12 * 3 * sizeof(float));
+  REQUIRE(std::any_of(events.begin(), events.end(), [](const wilt::TraceEvent& e) { return std::string(e.name) == "allocate" && e.bytes == 12 * sizeof(float); }));
+  REQUIRE(std::any_of(events.begin(), events.end(), [](const wilt::TraceEvent& e) { return std::string(e.name) == "user-op"; }));
+  REQUIRE(json.str().find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[") == 0);
+  REQUIRE(json.str().find("\"name\":\"binaryOp\",\"cat\":\"wilt\",\"ph\":\"X\"") != std::string::npos);
+  REQUIRE(json.str().find("\"args\":{\"bytes\":144,\"shape\":[3,4]}") != std::string::npos);
+
+  wilt::clearTrace();
+  REQUIRE(wilt::traceEvents().empty());
+}
+
+TEST_CASE("traceEvents() collects events from every thread")
+{
+  // arrange
+  wilt::clearTrace();
+
+  // act
+  std::thread worker([]() {
+    for (int i = 0; i < 3000; ++i)
+      WILT_TRACE_SCOPE("worker-op");
+  });
+  worker.join();
+  auto events = wilt::traceEvents();
+
+  // assert
+  REQUIRE(std::count_if(events.begin(), events.end(), [](const wilt::TraceEvent& e) { return std::string(e.name) == "worker-op"; }) == 3000);
+}
+
+TEST_CASE("slowPathReport() counts slow paths per call site and scope")
+{
+  // arrange
+  wilt::NArray<int, 3> arr({ 4, 5, 6 }, 1);
+  int unalignedSum = 0;
+  wilt::resetDiagnostics();
+
+  // act
+  {
+    wilt::DiagnosticScope scope("diagnostics-test");
+    for (int i = 0; i < 3; ++i)
+      arr[1][2][3] = 2;
+    auto copy = arr.transpose(0, 2).clone();
+    auto transposed = arr.transpose(0, 2);
+    unalignedSum = std::accumulate(transposed.begin(), transposed.end(), 0);
+    auto doubled = wilt::unaryOp<int>(arr.skipZ(2), [](int v) { return v * 2; });
+    auto sums = arr.compress<2>([](const wilt::NArray<int, 1>& row) { return row.at(0); });
+  }
+  auto aligned = std::accumulate(arr.begin(), arr.end(), 0);
+  auto records = wilt::slowPathReport();
+  std::ostringstream summary;
+  wilt::printDiagnostics(summary);
+
+  // assert
+  auto countOf = [&](wilt::SlowPath kind) {
+    std::size_t count = 0;
+    for (auto& record : records)
+      if (record.kind == kind)
+        count += record.count;
+    return count;
+  };
+  REQUIRE(aligned == 121);
+  REQUIRE(unalignedSum == 121);
+  REQUIRE(countOf(wilt::SlowPath::BRACKET_TEMPORARY) == 6);
+  REQUIRE(countOf(wilt::SlowPath::CLONE_UNALIGNED) == 1);
+  REQUIRE(countOf(wilt::SlowPath::ITERATE_UNALIGNED) == 1); // only the user iteration, not clone()
+  REQUIRE(countOf(wilt::SlowPath::STRIDED_INNER) == 1);
+  REQUIRE(countOf(wilt::SlowPath::COMPRESS_TEMPORARIES) == 20);
+  REQUIRE(std::all_of(records.begin(), records.end(), [](const wilt::SlowPathRecord& r) { return r.scope == "diagnostics-test"; }));
+  REQUIRE(summary.str().find("use at(x, y, ...)") != std::string::npos);
+  REQUIRE(summary.str().find("in diagnostics-test") != std::string::npos);
+}
+
+WILT_NOINLINE int sumTransposedA(const wilt::NArray<int, 2>& arr)
+{
+  auto transposed = arr.transpose();
+  return std::accumulate(transposed.begin(), transposed.end(), 0);
+}
+
+WILT_NOINLINE int sumTransposedB(const wilt::NArray<int, 2>& arr)
+{
+  auto transposed = arr.transpose();
+  return std::accumulate(transposed.begin(), transposed.end(), 0);
+}
+
+TEST_CASE("slowPathReport() separates call sites in user code")
+{
+  // arrange
+  wilt::NArray<int, 2> arr({ 3, 4 }, 1);
+  wilt::resetDiagnostics();
+
+  // act
+  int sum = sumTransposedA(arr) + sumTransposedB(arr) + sumTransposedB(arr);
+  auto records = wilt::slowPathReport();
+
+  // assert
+  REQUIRE(sum == 36);
+  REQUIRE(records.size() == 2);
+  REQUIRE(records[0].kind == wilt::SlowPath::ITERATE_UNALIGNED);
+  REQUIRE(records[0].count == 2);
+  REQUIRE(records[1].count == 1);
+  REQUIRE(records[0].address != records[1].address);
+  REQUIRE(records[1].address != nullptr);
+}
@@ -0,0 +1,411 @@
+////////////////////////////////////////////////////////////////////////////////
+// FILE: mdspansubset.hpp
+// DATE: 2026-10-18
+// AUTH: Trevor Wilson <kmdreko@gmail.com>
+// DESC: A subset of C++23 mdspan for testing mdspan.hpp without a standard one
+
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2019 Trevor Wilson
+// 
+// Permission is hereby granted, free of charge, to any person obtaining a copy 
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights 
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell 
+// copies of the Software, and to permit persons to whom the Software is 
+// furnished to do so, subject to the following conditions :
+// 
+//   The above copyright notice and this permission notice shall be included in
+//   all copies or substantial portions of the Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE 
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// The test suite uses this when neither <mdspan> nor the reference
+// <experimental/mdspan> is available, so the conversions in mdspan.hpp are
+// still compiled and run. It follows the C++23 wording for the parts that
+// mdspan.hpp and the tests use: extents, layout_right, layout_stride,
+// default_accessor, and mdspan. It only needs C++14 and leaves out
+// conversions between different extents, layout_left, and submdspan.
+
+#ifndef WILT_MDSPANSUBSET_HPP
+#define WILT_MDSPANSUBSET_HPP
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace mdspansubset
+{
+  constexpr std::size_t dynamic_extent = std::numeric_limits<std::size_t>::max();
+
+namespace detail
+{
+  template <class To, class... From>
+  struct AllConvertible : std::true_type {};
+
+  template <class To, class First, class... Rest>
+  struct AllConvertible<To, First, Rest...>
+    : std::integral_constant<bool, std::is_convertible<First, To>::value && AllConvertible<To, Rest...>::value> {};
+
+} // namespace detail
+
+  template <class IndexType, std::size_t... Extents>
+  class extents
+  {
+  public:
+    using index_type = IndexType;
+    using size_type = typename std::make_unsigned<IndexType>::type;
+    using rank_type = std::size_t;
+
+    static constexpr rank_type rank() noexcept { return sizeof...(Extents); }
+
+    static constexpr rank_type rank_dynamic() noexcept
+    {
+      return countDynamic_(0);
+    }
+
+    static constexpr std::size_t static_extent(rank_type r) noexcept
+    {
+      return staticExtents_()[r];
+    }
+
+    // all static extents, or one value per dynamic extent, or one value per
+    // extent
+    template <class... Indexes, class = typename std::enable_if<detail::AllConvertible<IndexType, Indexes...>::value &&
+      (sizeof...(Indexes) == rank() || (sizeof...(Indexes) == rank_dynamic() && sizeof...(Indexes) != 0))>::type>
+    constexpr explicit extents(Indexes... exts) noexcept
+      : extents(std::array<index_type, sizeof...(Indexes)>{ { static_cast<index_type>(exts)... } })
+    {
+
+    }
+
+    constexpr extents() noexcept
+      : extents_(fromStatic_())
+    {
+
+    }
+
+    template <class OtherIndexType, std::size_t M, class = typename std::enable_if<M == rank() || M == rank_dynamic()>::type>
+    constexpr explicit extents(const std::array<OtherIndexType, M>& exts) noexcept
+      : extents_(fromArray_(exts))
+    {
+
+    }
+
+    constexpr index_type extent(rank_type r) const noexcept
+    {
+      return extents_[r];
+    }
+
+    template <class OtherIndexType, std::size_t... OtherExtents>
+    friend constexpr bool operator== (const extents& lhs, const extents<OtherIndexType, OtherExtents...>& rhs) noexcept
+    {
+      if (lhs.rank() != rhs.rank())
+        return false;
+      for (rank_type r = 0; r < lhs.rank(); ++r)
+        if ((std::size_t)lhs.extent(r) != (std::size_t)rhs.extent(r))
+          return false;
+      return true;
+    }
+
+  private:
+    static constexpr std::array<std::size_t, sizeof...(Extents)> staticExtents_() noexcept
+    {
+      return std::array<std::size_t, sizeof...(Extents)>{ { Extents... } };
+    }
+
+    static constexpr rank_type countDynamic_(rank_type r) noexcept
+    {
+      return r == rank() ? 0 : (staticExtents_()[r] == dynamic_extent ? 1 : 0) + countDynamic_(r + 1);
+    }
+
+    static std::array<index_type, sizeof...(Extents)> fromStatic_() noexcept
+    {
+      std::array<index_type, sizeof...(Extents)> ret{};
+      for (rank_type r = 0; r < rank(); ++r)
+        ret[r] = static_extent(r) == dynamic_extent ? 0 : static_cast<index_type>(static_extent(r));
+      return ret;
+    }
+
+    template <class OtherIndexType, std::size_t M>
+    static std::array<index_type, sizeof...(Extents)> fromArray_(const std::array<OtherIndexType, M>& exts) noexcept
+    {
+      std::array<index_type, sizeof...(Extents)> ret{};
+      std::size_t next = 0;
+      for (rank_type r = 0; r < rank(); ++r)
+      {
+        if (M == rank())
+          ret[r] = static_cast<index_type>(exts[r]);
+        else if (static_extent(r) == dynamic_extent)
+          ret[r] = static_cast<index_type>(exts[next++]);
+        else
+          ret[r] = static_cast<index_type>(static_extent(r));
+      }
+      return ret;
+    }
+
+    std::array<index_type, sizeof...(Extents)> extents_;
+
+  }; // class extents
+
+namespace detail
+{
+  template <class IndexType, class Sequence>
+  struct DynamicExtents;
+
+  template <class IndexType, std::size_t... Is>
+  struct DynamicExtents<IndexType, std::index_sequence<Is...>>
+  {
+    using type = extents<IndexType, ((void)Is, dynamic_extent)...>;
+  };
+
+  template <class Extents, class... Indexes>
+  typename Extents::index_type offset(const Extents&, const std::array<typename Extents::index_type, Extents::rank()>& strides, Indexes... indexes) noexcept
+  {
+    const typename Extents::index_type idx[] = { static_cast<typename Extents::index_type>(indexes)..., 0 };
+    typename Extents::index_type ret = 0;
+    for (std::size_t r = 0; r < Extents::rank(); ++r)
+      ret += idx[r] * strides[r];
+    return ret;
+  }
+
+} // namespace detail
+
+  template <class IndexType, std::size_t Rank>
+  using dextents = typename detail::DynamicExtents<IndexType, std::make_index_sequence<Rank>>::type;
+
+  struct layout_right
+  {
+    template <class Extents>
+    class mapping
+    {
+    public:
+      using extents_type = Extents;
+      using index_type = typename Extents::index_type;
+      using layout_type = layout_right;
+
+      mapping() noexcept = default;
+
+      mapping(const extents_type& exts) noexcept
+        : extents_(exts)
+      {
+
+      }
+
+      const extents_type& extents() const noexcept { return extents_; }
+
+      index_type required_span_size() const noexcept
+      {
+        index_type size = 1;
+        for (std::size_t r = 0; r < Extents::rank(); ++r)
+          size *= extents_.extent(r);
+        return size;
+      }
+
+      template <class... Indexes>
+      index_type operator()(Indexes... indexes) const noexcept
+      {
+        return detail::offset(extents_, strides_(), indexes...);
+      }
+
+      static constexpr bool is_always_unique() noexcept { return true; }
+      static constexpr bool is_always_exhaustive() noexcept { return true; }
+      static constexpr bool is_always_strided() noexcept { return true; }
+      static constexpr bool is_unique() noexcept { return true; }
+      static constexpr bool is_exhaustive() noexcept { return true; }
+      static constexpr bool is_strided() noexcept { return true; }
+
+      index_type stride(std::size_t r) const noexcept
+      {
+        index_type stride = 1;
+        for (std::size_t i = r + 1; i < Extents::rank(); ++i)
+          stride *= extents_.extent(i);
+        return stride;
+      }
+
+    private:
+      std::array<index_type, Extents::rank()> strides_() const noexcept
+      {
+        std::array<index_type, Extents::rank()> ret{};
+        for (std::size_t r = 0; r < Extents::rank(); ++r)
+          ret[r] = stride(r);
+        return ret;
+      }
+
+      extents_type extents_;
+
+    }; // class mapping
+  };
+
+  struct layout_stride
+  {
+    template <class Extents>
+    class mapping
+    {
+    public:
+      using extents_type = Extents;
+      using index_type = typename Extents::index_type;
+      using layout_type = layout_stride;
+
+      template <class OtherIndexType>
+      mapping(const extents_type& exts, const std::array<OtherIndexType, Extents::rank()>& strides) noexcept
+        : extents_(exts)
+        , strides_()
+      {
+        for (std::size_t r = 0; r < Extents::rank(); ++r)
+          strides_[r] = static_cast<index_type>(strides[r]);
+      }
+
+      const extents_type& extents() const noexcept { return extents_; }
+      const std::array<index_type, Extents::rank()>& strides() const noexcept { return strides_; }
+
+      index_type required_span_size() const noexcept
+      {
+        index_type size = 1;
+        for (std::size_t r = 0; r < Extents::rank(); ++r)
+        {
+          if (extents_.extent(r) == 0)
+            return 0;
+          size += (extents_.extent(r) - 1) * strides_[r];
+        }
+        return size;
+      }
+
+      template <class... Indexes>
+      index_type operator()(Indexes... indexes) const noexcept
+      {
+        return detail::offset(extents_, strides_, indexes...);
+      }
+
+      static constexpr bool is_always_unique() noexcept { return true; }
+      static constexpr bool is_always_exhaustive() noexcept { return false; }
+      static constexpr bool is_always_strided() noexcept { return true; }
+      static constexpr bool is_unique() noexcept { return true; }
+      static constexpr bool is_strided() noexcept { return true; }
+
+      bool is_exhaustive() const noexcept
+      {
+        index_type size = 1;
+        for (std::size_t r = 0; r < Extents::rank(); ++r)
+          size *= extents_.extent(r);
+        return required_span_size() == size;
+      }
+
+      index_type stride(std::size_t r) const noexcept
+      {
+        return strides_[r];
+      }
+
+    private:
+      extents_type extents_;
+      std::array<index_type, Extents::rank()> strides_;
+
+    }; // class mapping
+  };
+
+  template <class ElementType>
+  struct default_accessor
+  {
+    using offset_policy = default_accessor;
+    using element_type = ElementType;
+    using reference = ElementType&;
+    using data_handle_type = ElementType*;
+
+    reference access(data_handle_type p, std::size_t i) const noexcept { return p[i]; }
+    data_handle_type offset(data_handle_type p, std::size_t i) const noexcept { return p + i; }
+  };
+
+  template <class ElementType, class Extents, class LayoutPolicy = layout_right, class AccessorPolicy = default_accessor<ElementType>>
+  class mdspan
+  {
+  public:
+    using extents_type = Extents;
+    using layout_type = LayoutPolicy;
+    using accessor_type = AccessorPolicy;
+    using mapping_type = typename LayoutPolicy::template mapping<Extents>;
+    using element_type = ElementType;
+    using index_type = typename Extents::index_type;
+    using size_type = typename Extents::size_type;
+    using data_handle_type = typename AccessorPolicy::data_handle_type;
+    using reference = typename AccessorPolicy::reference;
+
+    static constexpr std::size_t rank() noexcept { return Extents::rank(); }
+    static constexpr std::size_t rank_dynamic() noexcept { return Extents::rank_dynamic(); }
+    static constexpr std::size_t static_extent(std::size_t r) noexcept { return Extents::static_extent(r); }
+
+    template <class... Indexes, class = typename std::enable_if<detail::AllConvertible<index_type, Indexes...>::value &&
+      (sizeof...(Indexes) == Extents::rank() || sizeof...(Indexes) == Extents::rank_dynamic())>::type>
+    explicit mdspan(data_handle_type p, Indexes... exts)
+      : ptr_(p)
+      , map_(extents_type(static_cast<index_type>(exts)...))
+      , acc_()
+    {
+
+    }
+
+    mdspan(data_handle_type p, const mapping_type& m)
+      : ptr_(p)
+      , map_(m)
+      , acc_()
+    {
+
+    }
+
+    mdspan(data_handle_type p, const mapping_type& m, const accessor_type& a)
+      : ptr_(p)
+      , map_(m)
+      , acc_(a)
+    {
+
+    }
+
+    template <class... Indexes>
+    reference operator()(Indexes... indexes) const
+    {
+      static_assert(sizeof...(Indexes) == Extents::rank(), "mdspan::operator(): wrong number of indexes");
+      return acc_.access(ptr_, (std::size_t)map_(indexes...));
+    }
+
+    const extents_type& extents() const noexcept { return map_.extents(); }
+    index_type extent(std::size_t r) const noexcept { return extents().extent(r); }
+
+    size_type size() const noexcept
+    {
+      size_type size = 1;
+      for (std::size_t r = 0; r < rank(); ++r)
+        size *= static_cast<size_type>(extent(r));
+      return size;
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    const data_handle_type& data_handle() const noexcept { return ptr_; }
+    const mapping_type& mapping() const noexcept { return map_; }
+    const accessor_type& accessor() const noexcept { return acc_; }
+
+    static constexpr bool is_always_unique() { return mapping_type::is_always_unique(); }
+    static constexpr bool is_always_exhaustive() { return mapping_type::is_always_exhaustive(); }
+    static constexpr bool is_always_strided() { return mapping_type::is_always_strided(); }
+
+    bool is_unique() const { return map_.is_unique(); }
+    bool is_exhaustive() const { return map_.is_exhaustive(); }
+    bool is_strided() const { return map_.is_strided(); }
+    index_type stride(std::size_t r) const { return map_.stride(r); }
+
+  private:
+    data_handle_type ptr_;
+    mapping_type map_;
+    accessor_type acc_;
+
+  }; // class mdspan
+
+} // namespace mdspansubset
+
+#endif // !WILT_MDSPANSUBSET_HPP
@@ -29,10 +29,42 @@
 
 #include <cassert>
 #include <algorithm>
+#include <numeric>
 #include <chrono>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include "../src/wilt-narray/narray.hpp"
+#include "../src/wilt-narray/taskgraph.hpp"
+#include "../src/wilt-narray/async.hpp"
+#include "../src/wilt-narray/pipeline.hpp"
+#include "../src/wilt-narray/sharedmemory.hpp"
+#include "../src/wilt-narray/distributed.hpp"
+#include "../src/wilt-narray/checkpoint.hpp"
+#include "../src/wilt-narray/prefetch.hpp"
+#include "../src/wilt-narray/imageio.hpp"
+#include "../src/wilt-narray/csv.hpp"
+#include "../src/wilt-narray/byteorder.hpp"
+#include "../src/wilt-narray/checksum.hpp"
+// mdspan.hpp is tested against a subset of mdspan when there isn't a real one
+#if !(__cplusplus > 202002L && __has_include(<mdspan>)) && !__has_include(<experimental/mdspan>)
+#include "mdspansubset.hpp"
+#define WILT_MDSPAN_NAMESPACE mdspansubset
+#endif
+#include "../src/wilt-narray/mdspan.hpp"
+#include "../src/wilt-narray/dlpack.hpp"
+#include "../src/wilt-narray/dirtytracker.hpp"
+#include "../src/wilt-narray/autotune.hpp"
+#include "../src/wilt-narray/traversalplan.hpp"
+#include "../src/wilt-narray/computed.hpp"
 
 class NoDefault
 {
@@ -1604,102 +1636,1852 @@ TEST_CASE("make_narray(source) creates proper array from std::vector")
   REQUIRE(&a[1] == &data[1]);
 }
 
-int usingIterator(const wilt::NArray<int, 3>& arr)
+TEST_CASE("TaskGraph infers dependencies from overlapping arrays")
 {
-  int sum = 0;
-  for (int v : arr)
-    sum += v;
-  return sum;
+  // arrange
+  wilt::NArray<int, 2> src({ 4, 4 }, 1);
+  wilt::NArray<int, 2> a({ 4, 4 });
+  wilt::NArray<int, 2> b({ 4, 4 });
+  wilt::TaskGraph graph;
+
+  // act
+  auto t0 = graph.addTask([]() {}, { src }, { a });
+  auto t1 = graph.addTask([]() {}, { src }, { b });
+  auto t2 = graph.addTask([]() {}, { a.sliceX(1) }, { b.sliceY(0) });
+  auto t3 = graph.addTask([]() {}, { }, { src });
+
+  // assert
+  REQUIRE(graph.dependencies(t0).empty());
+  REQUIRE(graph.dependencies(t1).empty());
+  REQUIRE(graph.dependencies(t2) == std::vector<wilt::TaskGraph::TaskId>{ t0, t1 });
+  REQUIRE(graph.dependencies(t3) == std::vector<wilt::TaskGraph::TaskId>{ t0, t1 });
 }
 
-int usingIterator(const wilt::NArray<int, 1>& arr)
+TEST_CASE("TaskGraph runs tasks in dependency order")
 {
-  int sum = 0;
-  for (int v : arr)
-    sum += v;
-  return sum;
+  // arrange
+  wilt::ThreadPool pool(4);
+  wilt::NArray<int, 1> src({ 1000 }, 2);
+  wilt::NArray<int, 1> doubled({ 1000 }, 0);
+  wilt::NArray<int, 1> squared({ 1000 }, 0);
+  wilt::NArray<int, 1> result({ 1000 }, 0);
+  wilt::TaskGraph graph;
+
+  // act
+  graph.addTask([=]() mutable { doubled.setTo(src); doubled += src; }, { src }, { doubled });
+  graph.addTask([=]() mutable { squared.setTo(src); squared *= 2; }, { src }, { squared });
+  graph.addTask([=]() mutable { result.setTo(doubled); result += squared; }, { doubled, squared }, { result });
+  graph.run(pool);
+
+  // assert
+  REQUIRE(graph.size() == 0);
+  REQUIRE(std::all_of(result.begin(), result.end(), [](int v) { return v == 8; }));
 }
 
-int usingBrackets(const wilt::NArray<int, 3>& arr)
+int releasedCount = 0;
+
+struct Released
 {
-  int sum = 0;
-  for (std::size_t x = 0; x < arr.width(); ++x)
-    for (std::size_t y = 0; y < arr.height(); ++y)
-      for (std::size_t z = 0; z < arr.height(); ++z)
-        sum += arr[x][y][z];
-  return sum;
+  int value = 5;
+  ~Released() { ++releasedCount; }
+};
+
+TEST_CASE("TaskGraph releases arrays once their consumers are complete")
+{
+  // arrange
+  wilt::ThreadPool pool(2);
+  wilt::NArray<int, 1> result({ 10 }, 0);
+  int releasedBeforeLastTask = -1;
+  wilt::TaskGraph graph;
+  releasedCount = 0;
+  {
+    wilt::NArray<Released, 1> temp(wilt::Point<1>(10));
+    graph.addTask([temp, result]() { result.setTo(temp.convertTo<int>([](const Released& r) { return r.value; })); }, { temp }, { result });
+  }
+  graph.addTask([&]() { releasedBeforeLastTask = releasedCount; }, { result }, { });
+
+  // act
+  graph.run(pool);
+
+  // assert
+  REQUIRE(releasedBeforeLastTask == 10);
+  REQUIRE(result.at(0) == 5);
 }
 
-int usingBrackets(const wilt::NArray<int, 1>& arr)
+TEST_CASE("TaskGraph rethrows task exceptions and skips dependent tasks")
 {
-  int sum = 0;
-  for (std::size_t x = 0; x < arr.width(); ++x)
-    sum += arr[x];
-  return sum;
+  // arrange
+  wilt::ThreadPool pool(2);
+  wilt::NArray<int, 1> a({ 10 }, 0);
+  bool ran = false;
+  wilt::TaskGraph graph;
+  graph.addTask([]() { throw std::runtime_error("failed"); }, { }, { a });
+  graph.addTask([&]() { ran = true; }, { a }, { });
+
+  // act, assert
+  REQUIRE_THROWS_AS(graph.run(pool), std::runtime_error);
+  REQUIRE(!ran);
 }
 
-int usingForeach(const wilt::NArray<int, 3>& arr)
+TEST_CASE("reduce(src, init, op) combines elements in order")
 {
-  int sum = 0;
-  arr.foreach([&](int) mutable { sum++; });
-  return sum;
+  // arrange
+  wilt::NArray<int, 2> arr({ 2, 3 }, { 1, 2, 3, 4, 5, 6 });
+
+  // act
+  auto sum = wilt::reduce(arr, 0, [](int a, int b) { return a + b; });
+  auto digits = wilt::reduce(arr.transpose(), 0, [](int a, int b) { return a * 10 + b; });
+  auto empty = wilt::reduce(wilt::NArray<int, 2>(), 7, [](int a, int b) { return a + b; });
+
+  // assert
+  REQUIRE(sum == 21);
+  REQUIRE(digits == 142536);
+  REQUIRE(empty == 7);
 }
 
-int usingForeach(const wilt::NArray<int, 1>& arr)
+TEST_CASE("async operations produce the same results as their synchronous versions")
 {
-  int sum = 0;
-  arr.foreach([&](int) mutable { sum++; });
-  return sum;
+  // arrange
+  wilt::ThreadPool pool(2);
+  wilt::NArray<int, 2> arr({ 3, 4 }, 1);
+  wilt::NArray<int, 2> dst({ 3, 4 }, 0);
+
+  // act
+  auto cloned = wilt::asyncClone(arr.transpose(), pool);
+  auto converted = wilt::asyncConvertTo<double>(arr, pool);
+  auto summed = wilt::asyncBinaryOp<int>(arr, arr, [](int a, int b) { return a + b; }, pool);
+  auto reduced = wilt::asyncReduce(arr, 0, [](int a, int b) { return a + b; }, pool);
+  wilt::asyncSetTo(dst, arr, pool).get();
+
+  // assert
+  REQUIRE(cloned.get().sizes() == wilt::Point<2>(4, 3));
+  REQUIRE(converted.get().at(2, 3) == 1.0);
+  REQUIRE(summed.get().at(1, 1) == 2);
+  REQUIRE(reduced.get() == 12);
+  REQUIRE(dst.at(2, 3) == 1);
 }
 
-int usingAt(const wilt::NArray<int, 3>& arr)
+TEST_CASE("async operations keep their arrays alive until complete")
 {
-  int sum = 0;
-  for (std::size_t x = 0; x < arr.width(); ++x)
-    for (std::size_t y = 0; y < arr.height(); ++y)
-      for (std::size_t z = 0; z < arr.height(); ++z)
-        sum += arr.atUnchecked(wilt::Point<3>((wilt::pos_t)x, (wilt::pos_t)y, (wilt::pos_t)z));
-  return sum;
+  // arrange
+  wilt::ThreadPool pool(1);
+  std::promise<void> gate;
+  auto blocker = wilt::runAsync([&]() { gate.get_future().wait(); }, pool);
+
+  // act
+  auto result = wilt::asyncReduce(wilt::NArray<int, 1>({ 100 }, 2), 0, [](int a, int b) { return a + b; }, pool);
+  gate.set_value();
+
+  // assert
+  blocker.get();
+  REQUIRE(result.get() == 200);
 }
 
-int usingAt(const wilt::NArray<int, 1>& arr)
+TEST_CASE("async operations rethrow exceptions on get()")
 {
-  int sum = 0;
-  for (std::size_t x = 0; x < arr.width(); ++x)
-    sum += arr.atUnchecked(wilt::Point<1>((wilt::pos_t)x));
-  return sum;
+  // arrange
+  wilt::ThreadPool pool(1);
+
+  // act
+  auto result = wilt::asyncForeach(wilt::NArray<int, 1>({ 4 }, 0), [](int) { throw std::runtime_error("failed"); }, pool);
+
+  // assert
+  REQUIRE_THROWS_AS(result.get(), std::runtime_error);
 }
 
-int usingRaw(const wilt::NArray<int, 3>& arr)
+TEST_CASE("asyncWriteRaw() and asyncReadRaw() round-trip an array")
 {
-  int sum = 0;
-  int* data = arr.data();
-  for (std::size_t x = 0; x < arr.width(); ++x)
+  // arrange
+  wilt::NArray<short, 2> arr({ 3, 5 }, [i = 0]() mutable { return (short)i++; });
+
+  // act
+  wilt::asyncWriteRaw("narraytests_raw.bin", arr.flipY()).get();
+  auto read = wilt::asyncReadRaw<short>("narraytests_raw.bin", wilt::Point<2>(3, 5)).get();
+  std::remove("narraytests_raw.bin");
+
+  // assert
+  REQUIRE(read.at(0, 0) == 4);
+  REQUIRE(read.at(2, 4) == 10);
+}
+
+TEST_CASE("convertTo() converts contiguous multi-dimensional arrays")
+{
+  // arrange
+  wilt::NArray<int, 3> arr({ 2, 3, 4 }, 3);
+
+  // act
+  auto converted = arr.convertTo<double>();
+
+  // assert
+  REQUIRE(converted.sizes() == arr.sizes());
+  REQUIRE(std::all_of(converted.begin(), converted.end(), [](double v) { return v == 3.0; }));
+}
+
+#ifdef WILT_HAS_COROUTINES
+struct DetachedCoroutine
+{
+  struct promise_type
   {
-    int* datax = data + x * arr.step(0);
-    for (std::size_t y = 0; y < arr.height(); ++y)
-    {
-      int* datay = datax + y * arr.step(1);
-      for (std::size_t z = 0; z < arr.height(); ++z)
+    DetachedCoroutine get_return_object() { return {}; }
+    std::suspend_never initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() { }
+    void unhandled_exception() { std::terminate(); }
+  };
+};
+
+DetachedCoroutine awaitReduce(wilt::NArray<int, 1> arr, wilt::ThreadPool& pool, std::promise<int>& result)
+{
+  int sum = co_await wilt::asyncReduce(arr, 0, [](int a, int b) { return a + b; }, pool);
+  result.set_value(sum);
+}
+
+TEST_CASE("async operations can be awaited in coroutines")
+{
+  // arrange
+  wilt::ThreadPool pool(2);
+  std::promise<int> result;
+
+  // act
+  awaitReduce(wilt::NArray<int, 1>({ 50 }, 3), pool, result);
+
+  // assert
+  REQUIRE(result.get_future().get() == 150);
+}
+
+DetachedCoroutine awaitInvalid(std::promise<int>& result)
+{
+  try {
+    result.set_value(co_await wilt::AsyncResult<int>());
+  }
+  catch (...) {
+    result.set_exception(std::current_exception());
+  }
+}
+
+TEST_CASE("awaiting an invalid async result throws")
+{
+  // arrange
+  std::promise<int> result;
+
+  // act
+  awaitInvalid(result);
+
+  // assert
+  REQUIRE_THROWS_AS(result.get_future().get(), std::future_error);
+}
+#endif
+
+TEST_CASE("SpscQueue and MpmcQueue are bounded and first-in first-out")
+{
+  // arrange
+  wilt::SpscQueue<int> spsc(3);
+  wilt::MpmcQueue<int> mpmc(3);
+  int value = 0;
+
+  // act, assert
+  REQUIRE(spsc.capacity() == 4);
+  REQUIRE(mpmc.capacity() == 4);
+  for (int i = 0; i < 4; ++i)
+  {
+    REQUIRE(spsc.tryPush(int(i)));
+    REQUIRE(mpmc.tryPush(int(i)));
+  }
+  REQUIRE(!spsc.tryPush(4));
+  REQUIRE(!mpmc.tryPush(4));
+  for (int i = 0; i < 4; ++i)
+  {
+    REQUIRE((spsc.tryPop(value) && value == i));
+    REQUIRE((mpmc.tryPop(value) && value == i));
+  }
+  REQUIRE(!spsc.tryPop(value));
+  REQUIRE(!mpmc.tryPop(value));
+}
+
+TEST_CASE("MpmcQueue delivers every value once across threads")
+{
+  // arrange
+  wilt::MpmcQueue<long> queue(64);
+  std::atomic<long> total(0);
+  std::vector<std::thread> threads;
+
+  // act
+  for (int p = 0; p < 2; ++p)
+    threads.emplace_back([&]() { for (long i = 1; i <= 10000; ++i) queue.push(i); });
+  for (int c = 0; c < 2; ++c)
+    threads.emplace_back([&]() { long v; while (queue.pop(v)) total += v; });
+  threads[0].join();
+  threads[1].join();
+  queue.close();
+  threads[2].join();
+  threads[3].join();
+
+  // assert
+  REQUIRE(total == 2 * 10000L * 10001L / 2);
+}
+
+TEST_CASE("NArrayPool recycles data once all references are released")
+{
+  // arrange
+  wilt::NArrayPool<int, 2> pool({ 4, 4 }, 2);
+
+  // act
+  auto a = pool.acquire();
+  auto b = pool.acquire();
+  int* data = a.data();
+  auto view = a.transpose();
+  a.clear();
+  auto none = pool.tryAcquire();
+  view.clear();
+  auto c = pool.tryAcquire();
+
+  // assert
+  REQUIRE(none.empty());
+  REQUIRE(c.data() == data);
+  REQUIRE(c.sizes() == wilt::Point<2>(4, 4));
+  REQUIRE(pool.allocated() == 2);
+}
+
+TEST_CASE("NArrayPool data outlives the pool")
+{
+  // arrange
+  wilt::NArray<int, 1> arr;
+  {
+    wilt::NArrayPool<int, 1> pool(wilt::Point<1>(8), 1);
+    arr = pool.acquire();
+  }
+
+  // act
+  arr.setTo(3);
+
+  // assert
+  REQUIRE(arr.at(7) == 3);
+}
+
+TEST_CASE("MpmcQueue with capacity 1 doesn't overwrite items")
+{
+  // arrange
+  wilt::MpmcQueue<int> queue(1);
+  int first = 0;
+  int second = 0;
+  int third = 0;
+
+  // act
+  bool pushed1 = queue.tryPush(1);
+  bool pushed2 = queue.tryPush(2);
+  bool pushed3 = queue.tryPush(3);
+  bool popped1 = queue.tryPop(first);
+  bool popped2 = queue.tryPop(second);
+  bool popped3 = queue.tryPop(third);
+
+  // assert
+  REQUIRE(queue.capacity() == 2);
+  REQUIRE(pushed1);
+  REQUIRE(pushed2);
+  REQUIRE(!pushed3);
+  REQUIRE(popped1);
+  REQUIRE(popped2);
+  REQUIRE(!popped3);
+  REQUIRE(first == 1);
+  REQUIRE(second == 2);
+}
+
+TEST_CASE("Pipeline runs with a capacity of 1")
+{
+  // arrange
+  std::atomic<int> total(0);
+  wilt::Pipeline<wilt::NArray<int, 1>> pipeline(1);
+  pipeline.addStage(2, [](wilt::NArray<int, 1>& frame) { frame += 1; });
+  pipeline.addStage(1, [&](wilt::NArray<int, 1>& frame) { total += frame.at(0); });
+
+  // act
+  pipeline.start();
+  for (int i = 0; i < 50; ++i)
+    pipeline.push(wilt::NArray<int, 1>({ 1 }, i));
+  pipeline.close();
+
+  // assert
+  REQUIRE(total == 50 * 49 / 2 + 50);
+}
+
+TEST_CASE("Pipeline runs every item through every stage")
+{
+  // arrange
+  wilt::NArrayPool<int, 1> frames(wilt::Point<1>(16), 4);
+  std::atomic<int> total(0);
+  wilt::Pipeline<wilt::NArray<int, 1>> pipeline(2);
+  pipeline.addStage(3, [](wilt::NArray<int, 1>& frame) { frame += 1; });
+  pipeline.addStage(1, [&](wilt::NArray<int, 1>& frame) { total += frame.at(0); });
+
+  // act
+  pipeline.start();
+  for (int i = 0; i < 100; ++i)
+  {
+    auto frame = frames.acquire();
+    frame.setTo(i);
+    pipeline.push(std::move(frame));
+  }
+  pipeline.close();
+
+  // assert
+  REQUIRE(total == 100 * 99 / 2 + 100);
+  REQUIRE(frames.allocated() <= 4);
+  REQUIRE(!pipeline.push(frames.acquire()));
+}
+
+TEST_CASE("elementTypeOf<T>() identifies arithmetic types")
+{
+  REQUIRE(wilt::elementTypeOf<std::uint8_t>() == wilt::ElementType::UINT8);
+  REQUIRE(wilt::elementTypeOf<const std::int16_t>() == wilt::ElementType::INT16);
+  REQUIRE(wilt::elementTypeOf<float>() == wilt::ElementType::FLOAT32);
+  REQUIRE(wilt::elementTypeOf<double>() == wilt::ElementType::FLOAT64);
+  REQUIRE(wilt::elementTypeOf<bool>() == wilt::ElementType::BOOL);
+  REQUIRE(wilt::elementTypeOf<Tracker>() == wilt::ElementType::UNKNOWN);
+}
+
+TEST_CASE("SharedNArray can be created and opened by name with the same data")
+{
+  // arrange
+  const std::string name = "/narraytests_shared";
+  auto producer = wilt::SharedNArray<float, 2>::create(name, { 3, 4 });
+
+  // act
+  producer.publish([](const wilt::NArray<float, 2>& arr) { arr.setTo(2.5f); });
+  auto consumer = wilt::SharedNArray<const float, 2>::open(name);
+  wilt::SharedNArray<float, 2>::unlink(name);
+
+  // assert
+  REQUIRE(consumer.array().sizes() == wilt::Point<2>(3, 4));
+  REQUIRE(consumer.array().steps() == producer.array().steps());
+  REQUIRE(consumer.array().at(2, 3) == 2.5f);
+  REQUIRE(consumer.sequence() == 2);
+  producer.array().at(0, 0) = 7.0f;
+  REQUIRE(consumer.array().at(0, 0) == 7.0f);
+}
+
+TEST_CASE("SharedNArray::open() throws when the element type or dimensions don't match")
+{
+  // arrange
+  const std::string name = "/narraytests_shared_mismatch";
+  auto producer = wilt::SharedNArray<std::uint16_t, 2>::create(name, { 2, 2 });
+
+  // act, assert
+  REQUIRE_THROWS_AS((wilt::SharedNArray<float, 2>::open(name)), std::runtime_error);
+  REQUIRE_THROWS_AS((wilt::SharedNArray<std::uint16_t, 3>::open(name)), std::runtime_error);
+  REQUIRE_NOTHROW((wilt::SharedNArray<const std::uint16_t, 2>::open(name)));
+  wilt::SharedNArray<std::uint16_t, 2>::unlink(name);
+  REQUIRE_THROWS_AS((wilt::SharedNArray<std::uint16_t, 2>::open(name)), std::runtime_error);
+}
+
+TEST_CASE("SharedNArray::tryRead() fails while a write is in progress")
+{
+  // arrange
+  const std::string name = "/narraytests_shared_seqlock";
+  auto producer = wilt::SharedNArray<int, 1>::create(name, wilt::Point<1>(4));
+  auto consumer = wilt::SharedNArray<const int, 1>::open(name);
+  wilt::SharedNArray<int, 1>::unlink(name);
+  int value = 0;
+
+  // act
+  producer.beginWrite();
+  bool duringWrite = consumer.tryRead([&](const wilt::NArray<const int, 1>& arr) { value = arr.at(0); });
+  producer.array().at(0) = 9;
+  producer.endWrite();
+  bool afterWrite = consumer.tryRead([&](const wilt::NArray<const int, 1>& arr) { value = arr.at(0); });
+
+  // assert
+  REQUIRE(!duringWrite);
+  REQUIRE(afterWrite);
+  REQUIRE(value == 9);
+}
+
+TEST_CASE("DistributedNArray splits the global array and fills ghosts from neighbors")
+{
+  // arrange
+  const wilt::Point<2> global(7, 10);
+  auto transports = wilt::SocketTransport::createLocal(4);
+  std::vector<int> mismatches(4, -1);
+  std::vector<wilt::Point<2>> offsets(4);
+
+  // act
+  std::vector<std::thread> threads;
+  for (std::size_t r = 0; r < 4; ++r)
+  {
+    threads.emplace_back([&, r]() {
+      wilt::DistributedNArray<int, 2> arr(*transports[r], global, { 2, 2 }, 1);
+      const wilt::Point<2> offset = arr.globalOffset();
+      offsets[r] = offset;
+      for (wilt::pos_t y = 0; y < arr.interior().sizes()[0]; ++y)
+        for (wilt::pos_t x = 0; x < arr.interior().sizes()[1]; ++x)
+          arr.interior().at(y, x) = (offset[0] + y) * 100 + (offset[1] + x);
+
+      arr.exchangeHalos();
+
+      int bad = 0;
+      for (wilt::pos_t y = 0; y < arr.local().sizes()[0]; ++y)
       {
-        int* dataz = datay + z * arr.step(2);
-        sum += *dataz;
+        for (wilt::pos_t x = 0; x < arr.local().sizes()[1]; ++x)
+        {
+          wilt::pos_t gy = offset[0] + y - 1;
+          wilt::pos_t gx = offset[1] + x - 1;
+          if (gy < 0 || gy >= global[0] || gx < 0 || gx >= global[1])
+            continue;
+          if (arr.local().at(y, x) != gy * 100 + gx)
+            ++bad;
+        }
       }
-    }
+      mismatches[r] = bad;
+    });
   }
-  return sum;
+  for (auto& thread : threads)
+    thread.join();
+
+  // assert
+  REQUIRE(offsets[0] == wilt::Point<2>(0, 0));
+  REQUIRE(offsets[1] == wilt::Point<2>(0, 5));
+  REQUIRE(offsets[2] == wilt::Point<2>(4, 0));
+  REQUIRE(offsets[3] == wilt::Point<2>(4, 5));
+  REQUIRE(mismatches == std::vector<int>(4, 0));
 }
 
-int usingRaw(const wilt::NArray<int, 1>& arr)
+TEST_CASE("DistributedNArray only pads dimensions that are split")
 {
-  int sum = 0;
-  int* base = arr.data();
-  for (std::size_t x = 0; x < arr.width(); ++x)
+  // arrange
+  auto transports = wilt::SocketTransport::createLocal(1);
+
+  // act
+  wilt::DistributedNArray<float, 3> arr(*transports[0], { 4, 5, 6 }, { 1, 1, 1 }, 2);
+
+  // assert
+  REQUIRE(arr.local().sizes() == wilt::Point<3>(4, 5, 6));
+  REQUIRE(arr.interior().sizes() == wilt::Point<3>(4, 5, 6));
+  REQUIRE(arr.neighbor(0, 1) == wilt::Transport::NONE);
+  REQUIRE_NOTHROW(arr.exchangeHalos());
+  REQUIRE_THROWS_AS((wilt::DistributedNArray<float, 3>(*transports[0], { 4, 5, 6 }, { 2, 1, 1 }, 1)), std::invalid_argument);
+}
+
+TEST_CASE("CheckpointWriter and CheckpointReader round-trip named arrays")
+{
+  for (bool direct : { false, true })
   {
-    int* basex = base + x * arr.step(0);
-    sum += *basex;
+    // arrange
+    const std::string path = "narraytests_checkpoint.bin";
+    wilt::NArray<float, 3> volume({ 8, 16, 24 }, [i = 0]() mutable { return (float)i++; });
+    wilt::NArray<int, 2> grid({ 40, 30 }, [i = 0]() mutable { return i++; });
+    wilt::NArray<double, 1> series(wilt::Point<1>(3), 1.5);
+    auto allEqual = [](bool acc, bool v) { return acc && v; };
+
+    // act
+    wilt::CheckpointWriter writer(path, direct, 4096);
+    writer.add("volume", volume);
+    writer.add("grid", grid.transpose());
+    writer.add("series", series);
+    writer.add("empty", wilt::NArray<char, 2>());
+    writer.write();
+
+    wilt::CheckpointReader reader(path);
+    auto volumeRead = reader.read<float, 3>("volume");
+    auto gridRead = reader.read<int, 2>("grid");
+    auto volumeMapped = reader.map<float, 3>("volume");
+    auto seriesMapped = reader.map<double, 1>("series");
+    auto emptyRead = reader.read<char, 2>("empty");
+    std::remove(path.c_str());
+
+    // assert
+    REQUIRE(reader.entries().size() == 4);
+    REQUIRE(reader.entries()[1].name == "grid");
+    REQUIRE(reader.entries()[1].offset % 4096 == 0);
+    REQUIRE(wilt::reduce(wilt::compareEQ(volumeRead, volume), true, allEqual));
+    REQUIRE(wilt::reduce(wilt::compareEQ(gridRead, grid.transpose()), true, allEqual));
+    REQUIRE(wilt::reduce(wilt::compareEQ(volumeMapped, volume), true, allEqual));
+    REQUIRE(seriesMapped.at(2) == 1.5);
+    REQUIRE(emptyRead.empty());
+    REQUIRE_FALSE(reader.contains("missing"));
   }
-  return sum;
+}
+
+TEST_CASE("CheckpointReader throws when the element type or dimensions don't match")
+{
+  // arrange
+  const std::string path = "narraytests_checkpoint_mismatch.bin";
+  wilt::CheckpointWriter writer(path);
+  writer.add("values", wilt::NArray<std::uint16_t, 2>({ 2, 3 }, (std::uint16_t)7));
+  writer.write();
+
+  // act
+  wilt::CheckpointReader reader(path);
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE_THROWS_AS((reader.read<float, 2>("values")), std::runtime_error);
+  REQUIRE_THROWS_AS((reader.read<std::uint16_t, 3>("values")), std::runtime_error);
+  REQUIRE_THROWS_AS((reader.read<std::uint16_t, 2>("missing")), std::runtime_error);
+  REQUIRE(reader.read<std::uint16_t, 2>("values").at(1, 2) == 7);
+  REQUIRE_THROWS_AS((wilt::CheckpointReader(path)), std::runtime_error);
+}
+
+TEST_CASE("CheckpointReader rejects an index that doesn't match the data")
+{
+  // arrange
+  const std::string path = "narraytests_checkpoint_corrupt.bin";
+  wilt::CheckpointWriter writer(path);
+  writer.add("values", wilt::NArray<std::uint16_t, 2>({ 2, 3 }, (std::uint16_t)7));
+  writer.write();
+  std::uint64_t indexOffset = wilt::CheckpointReader(path).entries()[0].offset + 4096;
+  bool leftTemp = std::ifstream(path + ".tmp").good();
+
+  // the record is: length, "values", type, dimensions, reserved, element
+  // size, sizes[2], offset, bytes
+  auto patch = [&](std::uint64_t at, std::int64_t value) {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp((std::streamoff)(indexOffset + at));
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+  };
+
+  // act
+  patch(42, 4096);
+  bool rejectedBytes = false;
+  try { wilt::CheckpointReader reader(path); } catch (const std::runtime_error&) { rejectedBytes = true; }
+
+  patch(42, 12);
+  patch(18, -2);
+  bool rejectedSizes = false;
+  try { wilt::CheckpointReader reader(path); } catch (const std::runtime_error&) { rejectedSizes = true; }
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE_FALSE(leftTemp);
+  REQUIRE(rejectedBytes);
+  REQUIRE(rejectedSizes);
+}
+
+TEST_CASE("PrefetchReader returns the regions of a tile plan in order")
+{
+  // arrange
+  const std::string path = "narraytests_prefetch.bin";
+  const wilt::Point<3> sizes(6, 10, 12);
+  wilt::NArray<int, 3> arr(sizes, [i = 0]() mutable { return i++; });
+  wilt::writeRaw(path, arr);
+  auto plan = wilt::tilePlan(sizes, wilt::Point<3>(4, 3, 12));
+  auto allEqual = [](bool acc, bool v) { return acc && v; };
+
+  // act
+  wilt::PrefetchReader<int, 3> reader(path, sizes, plan, 3);
+  std::vector<wilt::NArray<int, 3>> tiles;
+  for (auto tile = reader.next(); !tile.empty(); tile = reader.next())
+    tiles.push_back(tile);
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE(plan.size() == 8);
+  REQUIRE(tiles.size() == plan.size());
+  REQUIRE(reader.done());
+  for (std::size_t i = 0; i < plan.size(); ++i)
+  {
+    REQUIRE(tiles[i].sizes() == plan[i].sizes);
+    REQUIRE(wilt::reduce(wilt::compareEQ(tiles[i], arr.subarray(plan[i].loc, plan[i].sizes)), true, allEqual));
+  }
+}
+
+TEST_CASE("PrefetchReader follows the order of subarrays<M>()")
+{
+  // arrange
+  const std::string path = "narraytests_prefetch_slices.bin";
+  const wilt::Point<3> sizes(4, 5, 6);
+  wilt::NArray<short, 3> arr(sizes, [i = 0]() mutable { return (short)i++; });
+  wilt::writeRaw(path, arr);
+  auto allEqual = [](bool acc, bool v) { return acc && v; };
+
+  // act
+  wilt::PrefetchReader<short, 3> reader(path, sizes, wilt::subarrayPlan<1>(sizes), 2);
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE(reader.size() == 20);
+  for (auto slice : arr.subarrays<1>())
+  {
+    auto read = reader.next();
+    REQUIRE(read.sizes() == wilt::Point<3>(1, 1, 6));
+    REQUIRE(wilt::reduce(wilt::compareEQ(read.reshape(wilt::Point<1>(6)), slice), true, allEqual));
+  }
+  REQUIRE(reader.next().empty());
+}
+
+TEST_CASE("PrefetchReader throws when the plan is out of bounds")
+{
+  // arrange
+  const std::string path = "narraytests_prefetch_bounds.bin";
+  wilt::writeRaw(path, wilt::NArray<int, 2>({ 3, 3 }, [](){ return 0; }));
+  std::vector<wilt::Region<2>> plan = { { { 2, 0 }, { 2, 3 } } };
+
+  // act, assert
+  REQUIRE_THROWS_AS((wilt::PrefetchReader<int, 2>(path, { 3, 3 }, plan)), std::invalid_argument);
+  REQUIRE_THROWS_AS((wilt::PrefetchReader<int, 2>(path, { 4, 4 }, wilt::tilePlan<2>({ 4, 4 }, { 2, 2 }))), std::runtime_error);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("writePgm() and readPgm() round-trip an image")
+{
+  // arrange
+  const std::string path = "narraytests_image.pgm";
+  wilt::NArray<std::uint8_t, 2> img({ 4, 6 }, [i = 0]() mutable { return (std::uint8_t)(i++ * 10); });
+  auto allEqual = [](bool acc, bool v) { return acc && v; };
+
+  // act
+  wilt::writePgm(path, img.flipY());
+  auto read = wilt::readPgm(path);
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE(read.sizes() == wilt::Point<2>(4, 6));
+  REQUIRE(wilt::reduce(wilt::compareEQ(read, img.flipY().asConst()), true, allEqual));
+}
+
+TEST_CASE("readPgm() skips header comments")
+{
+  // arrange
+  const std::string path = "narraytests_comment.pgm";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << "P5\n# a comment\n3 2 # another\n255\n";
+    file.write("\x01\x02\x03\x04\x05\x06", 6);
+  }
+
+  // act
+  auto read = wilt::readPgm(path);
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE(read.sizes() == wilt::Point<2>(2, 3));
+  REQUIRE(read.at(1, 0) == 4);
+}
+
+TEST_CASE("readPpm() throws for files that aren't PPM")
+{
+  // arrange
+  const std::string path = "narraytests_not.ppm";
+  wilt::writePgm(path, wilt::NArray<std::uint8_t, 2>({ 2, 2 }, (std::uint8_t)1));
+
+  // act, assert
+  REQUIRE_THROWS_AS(wilt::readPpm(path), std::runtime_error);
+  std::remove(path.c_str());
+  REQUIRE_THROWS_AS(wilt::readPpm(path), std::runtime_error);
+}
+
+TEST_CASE("writePpm() and readPpm() round-trip an image")
+{
+  // arrange
+  const std::string path = "narraytests_image.ppm";
+  wilt::NArray<std::uint8_t, 3> img({ 3, 5, 3 }, [i = 0]() mutable { return (std::uint8_t)i++; });
+
+  // act
+  wilt::writePpm(path, img);
+  auto read = wilt::readPpm(path);
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE(read.sizes() == wilt::Point<3>(3, 5, 3));
+  REQUIRE(read.at(2, 4, 2) == 44);
+}
+
+TEST_CASE("writeBmp() and readBmp() round-trip an image with padded rows")
+{
+  // arrange
+  const std::string path = "narraytests_image.bmp";
+  wilt::NArray<std::uint8_t, 3> img({ 3, 5, 3 }, [i = 0]() mutable { return (std::uint8_t)i++; });
+  auto allEqual = [](bool acc, bool v) { return acc && v; };
+
+  // act
+  wilt::writeBmp(path, img);
+  auto read = wilt::readBmp(path);
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  auto fileSize = file.tellg();
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE(fileSize == 54 + 16 * 3);
+  REQUIRE(read.sizes() == wilt::Point<3>(3, 5, 3));
+  REQUIRE(read.steps() == wilt::Point<3>(-16, 3, 1));
+  REQUIRE(wilt::reduce(wilt::compareEQ(read, img.asConst()), true, allEqual));
+}
+
+TEST_CASE("mapRaw() views the elements of a raw file")
+{
+  // arrange
+  const std::string path = "narraytests_mapraw.bin";
+  wilt::NArray<std::uint16_t, 2> arr({ 4, 4 }, [i = 0]() mutable { return (std::uint16_t)i++; });
+  wilt::writeRaw(path, arr);
+
+  // act
+  auto view = wilt::mapRaw<std::uint16_t>(path, wilt::Point<2>(3, 4), 8);
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE(view.at(0, 0) == 4);
+  REQUIRE(view.at(2, 3) == 15);
+  REQUIRE_THROWS_AS((wilt::mapRaw<std::uint16_t>(path, wilt::Point<2>(3, 4), 1)), std::invalid_argument);
+}
+
+TEST_CASE("writeCsv() and readCsv() round-trip an array")
+{
+  // arrange
+  const std::string path = "narraytests_values.csv";
+  wilt::NArray<double, 2> arr({ 20000, 12 }, [i = 0]() mutable { return i++ * 0.1 - 7.0 / 3.0; });
+  auto allEqual = [](bool acc, bool v) { return acc && v; };
+
+  // act
+  wilt::writeCsv(path, arr.transpose().asConst());
+  auto read = wilt::readCsv<double>(path);
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE(read.sizes() == wilt::Point<2>(12, 20000));
+  REQUIRE(wilt::reduce(wilt::compareEQ(read, arr.transpose()), true, allEqual));
+}
+
+TEST_CASE("readCsv() handles headers, spaces, line endings, and blank lines")
+{
+  // arrange
+  const std::string path = "narraytests_messy.csv";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << "a;b;c\r\n1; 2 ;3\r\n\r\n-4;5;\t6\n7;8;9";
+  }
+
+  // act
+  auto read = wilt::readCsv<int>(path, ';', true);
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE(read.sizes() == wilt::Point<2>(3, 3));
+  REQUIRE(read.at(0, 1) == 2);
+  REQUIRE(read.at(1, 0) == -4);
+  REQUIRE(read.at(1, 2) == 6);
+  REQUIRE(read.at(2, 2) == 9);
+}
+
+TEST_CASE("readCsv() throws on bad values and ragged rows")
+{
+  // arrange
+  const std::string badValue = "narraytests_bad_value.csv";
+  const std::string ragged = "narraytests_ragged.csv";
+  std::ofstream(badValue) << "1,2\n3,x\n";
+  std::ofstream(ragged) << "1,2\n3\n";
+
+  // act, assert
+  REQUIRE_THROWS_AS(wilt::readCsv<float>(badValue), std::runtime_error);
+  REQUIRE_THROWS_AS(wilt::readCsv<float>(ragged), std::runtime_error);
+  REQUIRE_THROWS_AS(wilt::readCsv<std::uint8_t>(badValue), std::runtime_error);
+  std::remove(badValue.c_str());
+  std::remove(ragged.c_str());
+}
+
+TEST_CASE("byteSwap() reverses the bytes of a value")
+{
+  REQUIRE(wilt::byteSwap((std::uint16_t)0x1234) == 0x3412);
+  REQUIRE(wilt::byteSwap((std::uint32_t)0x12345678) == 0x78563412);
+  REQUIRE(wilt::byteSwap((std::int64_t)0x0102030405060708) == 0x0807060504030201);
+  REQUIRE(wilt::byteSwap(wilt::byteSwap(1.25)) == 1.25);
+}
+
+TEST_CASE("Endian<T> stores values in its byte order")
+{
+  // arrange
+  wilt::BigEndian<std::uint32_t> big = 0x01020304u;
+  wilt::LittleEndian<std::uint32_t> little = 0x01020304u;
+  unsigned char bigBytes[4];
+  unsigned char littleBytes[4];
+
+  // act
+  std::memcpy(bigBytes, &big, 4);
+  std::memcpy(littleBytes, &little, 4);
+
+  // assert
+  REQUIRE(sizeof(big) == 4);
+  REQUIRE(bigBytes[0] == 0x01);
+  REQUIRE(bigBytes[3] == 0x04);
+  REQUIRE(littleBytes[0] == 0x04);
+  REQUIRE((std::uint32_t)big == 0x01020304u);
+}
+
+TEST_CASE("toNativeOrder() converts strided arrays of foreign elements")
+{
+  // arrange
+  wilt::NArray<wilt::BigEndian<std::int32_t>, 2> arr({ 7, 9 }, [i = 0]() mutable { return wilt::BigEndian<std::int32_t>(i++ - 20); });
+
+  // act
+  auto native = wilt::toNativeOrder(arr);
+  auto transposed = wilt::toNativeOrder(arr.transpose());
+
+  // assert
+  REQUIRE(native.isContiguous());
+  REQUIRE(native.at(0, 0) == -20);
+  REQUIRE(native.at(6, 8) == 42);
+  REQUIRE(transposed.sizes() == wilt::Point<2>(9, 7));
+  REQUIRE(transposed.at(8, 6) == 42);
+  REQUIRE(transposed.at(3, 1) == -8);
+}
+
+TEST_CASE("readRaw() and mapRaw() handle big-endian files")
+{
+  // arrange
+  const std::string path = "narraytests_big.bin";
+  {
+    std::ofstream file(path, std::ios::binary);
+    for (int i = 0; i < 40000; ++i)
+    {
+      char bytes[2] = { (char)((i >> 8) & 0xFF), (char)(i & 0xFF) };
+      file.write(bytes, 2);
+    }
+  }
+
+  // act
+  auto read = wilt::readRaw<std::uint16_t>(path, wilt::Point<2>(200, 200), wilt::ByteOrder::BIG);
+  auto mapped = wilt::mapRaw<wilt::BigEndian<std::uint16_t>>(path, wilt::Point<2>(200, 200));
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE(read.at(0, 1) == 1);
+  REQUIRE(read.at(199, 199) == 39999);
+  REQUIRE((std::uint16_t)mapped.at(150, 3) == 30003);
+}
+
+TEST_CASE("readPgm16() views 16-bit samples")
+{
+  // arrange
+  const std::string path = "narraytests_image16.pgm";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << "P5 2 2 65535\n";
+    file.write("\x01\x02\x03\x04\x05\x06\xFF\xFE", 8);
+  }
+
+  // act
+  auto read = wilt::readPgm16(path);
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE(read.sizes() == wilt::Point<2>(2, 2));
+  REQUIRE((std::uint16_t)read.at(0, 1) == 0x0304);
+  REQUIRE(wilt::toNativeOrder(read).at(1, 1) == 0xFFFE);
+}
+
+TEST_CASE("crc32c() matches the standard check value and can be combined")
+{
+  // arrange
+  const char* text = "123456789";
+
+  // act
+  std::uint32_t whole = wilt::crc32c(text, 9);
+  std::uint32_t first = wilt::crc32c(text, 4);
+  std::uint32_t second = wilt::crc32c(text + 4, 5);
+
+  // assert
+  REQUIRE(whole == 0xE3069283);
+  REQUIRE(wilt::crc32c(text + 4, 5, first) == whole);
+  REQUIRE(wilt::crc32cCombine(first, second, 5) == whole);
+  REQUIRE(wilt::crc32c(text, 0) == 0);
+}
+
+TEST_CASE("crc32c() of an array covers its elements in row-major order")
+{
+  // arrange
+  wilt::NArray<std::uint32_t, 2> arr({ 300, 200 }, [i = 0u]() mutable { return i++ * 2654435761u; });
+  auto view = arr.transpose();
+  auto copy = view.clone();
+
+  // act
+  std::uint32_t viewCrc = wilt::crc32c(view);
+  std::uint32_t copyCrc = wilt::crc32c(copy);
+
+  // assert
+  REQUIRE(viewCrc == copyCrc);
+  REQUIRE(copyCrc == wilt::crc32c(copy.data(), copy.size() * sizeof(std::uint32_t)));
+  REQUIRE(viewCrc != wilt::crc32c(arr));
+}
+
+TEST_CASE("contentHash64() and contentHash128() depend only on sizes and elements")
+{
+  // arrange
+  wilt::NArray<double, 3> arr({ 40, 50, 60 }, [i = 0]() mutable { return i++ * 0.5; });
+  auto view = arr.flipX().transpose(1, 2);
+  auto copy = view.clone();
+
+  // act
+  auto viewHash = wilt::contentHash64(view);
+  auto copyHash = wilt::contentHash64(copy);
+  auto reshapedHash = wilt::contentHash64(copy.reshape(wilt::Point<3>(60, 40, 50)));
+  copy.at(0, 0, 0) += 1.0;
+  auto changedHash = wilt::contentHash64(copy);
+
+  // assert
+  REQUIRE(viewHash == copyHash);
+  REQUIRE(viewHash != reshapedHash);
+  REQUIRE(viewHash != changedHash);
+  REQUIRE(viewHash != wilt::contentHash64(view, 1));
+  REQUIRE(wilt::contentHash128(view) == wilt::contentHash128(view.clone()));
+  REQUIRE(wilt::contentHash128(view) != wilt::contentHash128(copy));
+  REQUIRE(wilt::contentHash64(wilt::NArray<int, 2>()) == wilt::contentHash64(wilt::NArray<int, 2>()));
+}
+
+#ifdef WILT_HAS_MDSPAN
+TEST_CASE("toMdspan() views the same data, sizes, and steps")
+{
+  // arrange
+  wilt::NArray<int, 3> arr({ 2, 3, 4 }, [i = 0]() mutable { return i++; });
+  auto view = arr.transpose(0, 2);
+
+  // act
+  auto span = wilt::toMdspan(view);
+  auto fixed = wilt::toMdspan<WILT_MDSPAN_NAMESPACE::extents<wilt::pos_t, 4, 3, 2>>(view);
+  auto mixed = wilt::toMdspan<WILT_MDSPAN_NAMESPACE::extents<wilt::pos_t, 4, WILT_MDSPAN_NAMESPACE::dynamic_extent, 2>>(view);
+  auto roundTrip = wilt::fromMdspan(span);
+
+  // assert
+  REQUIRE(span.data_handle() == view.data());
+  REQUIRE(span(3, 2, 1) == view.at(3, 2, 1));
+  REQUIRE(fixed(1, 2, 0) == view.at(1, 2, 0));
+  REQUIRE(mixed.extent(1) == 3);
+  REQUIRE(mixed(2, 1, 1) == view.at(2, 1, 1));
+  REQUIRE(roundTrip.sizes() == view.sizes());
+  REQUIRE(roundTrip.steps() == view.steps());
+  REQUIRE(roundTrip.data() == view.data());
+  REQUIRE(span.extent(0) == 4);
+  REQUIRE(span.stride(0) == 1);
+  REQUIRE(span.stride(2) == 12);
+  REQUIRE(fixed.stride(1) == 4);
+  REQUIRE_THROWS_AS((wilt::toMdspan<WILT_MDSPAN_NAMESPACE::extents<wilt::pos_t, 4, 3, 3>>(view)), std::invalid_argument);
+  REQUIRE_THROWS_AS(wilt::toMdspan(arr.flipX()), std::invalid_argument);
+}
+
+TEST_CASE("fromMdspan() references the data of an mdspan")
+{
+  // arrange
+  auto owner = std::make_shared<std::vector<float>>(12, 1.0f);
+  WILT_MDSPAN_NAMESPACE::mdspan<float, WILT_MDSPAN_NAMESPACE::dextents<std::size_t, 2>> span(owner->data(), 3, 4);
+
+  // act
+  auto borrowed = wilt::fromMdspan(span);
+  auto shared = wilt::fromMdspan(span, owner);
+  std::weak_ptr<std::vector<float>> weak = owner;
+  owner.reset();
+
+  // assert
+  REQUIRE(borrowed.sizes() == wilt::Point<2>(3, 4));
+  REQUIRE(borrowed.steps() == wilt::Point<2>(4, 1));
+  REQUIRE(shared.data() == borrowed.data());
+  REQUIRE_FALSE(weak.expired());
+  shared.at(2, 3) = 5.0f;
+  REQUIRE(borrowed.at(2, 3) == 5.0f);
+}
+#endif
+
+TEST_CASE("toDLPack() exports the data, shape, and strides of an array")
+{
+  // arrange
+  wilt::NArray<float, 2> arr({ 3, 4 }, [i = 0]() mutable { return (float)i++; });
+  auto view = arr.transpose();
+
+  // act
+  DLManagedTensor* tensor = wilt::toDLPack(view);
+
+  // assert
+  REQUIRE(tensor->dl_tensor.data == arr.data());
+  REQUIRE(tensor->dl_tensor.ndim == 2);
+  REQUIRE(tensor->dl_tensor.dtype.code == kDLFloat);
+  REQUIRE(tensor->dl_tensor.dtype.bits == 32);
+  REQUIRE(tensor->dl_tensor.shape[0] == 4);
+  REQUIRE(tensor->dl_tensor.strides[0] == 1);
+  REQUIRE(tensor->dl_tensor.strides[1] == 4);
+  REQUIRE(tensor->dl_tensor.device.device_type == kDLCPU);
+  tensor->deleter(tensor);
+}
+
+TEST_CASE("fromDLPack() imports a managed tensor and calls its deleter when done")
+{
+  // arrange
+  static int deleted = 0;
+  static std::int64_t shape[2] = { 2, 3 };
+  static std::int64_t strides[2] = { 1, 2 };
+  static std::uint16_t values[6] = { 0, 1, 2, 3, 4, 5 };
+  deleted = 0;
+
+  auto makeTensor = []() {
+    DLManagedTensor* tensor = new DLManagedTensor();
+    tensor->dl_tensor.data = values;
+    tensor->dl_tensor.device = DLDevice{ kDLCPU, 0 };
+    tensor->dl_tensor.ndim = 2;
+    tensor->dl_tensor.dtype = wilt::dlDataTypeOf<std::uint16_t>();
+    tensor->dl_tensor.shape = shape;
+    tensor->dl_tensor.strides = strides;
+    tensor->deleter = [](DLManagedTensor* self) { ++deleted; delete self; };
+    return tensor;
+  };
+
+  // act
+  DLManagedTensor* mismatched = makeTensor();
+  REQUIRE_THROWS_AS((wilt::fromDLPack<std::int16_t, 2>(mismatched)), std::invalid_argument);
+  REQUIRE_THROWS_AS((wilt::fromDLPack<std::uint16_t, 3>(mismatched)), std::invalid_argument);
+  mismatched->deleter(mismatched);
+
+  auto arr = wilt::fromDLPack<std::uint16_t, 2>(makeTensor());
+  auto copy = arr.transpose();
+  arr.clear();
+
+  // assert
+  REQUIRE(deleted == 1);
+  REQUIRE(copy.sizes() == wilt::Point<2>(3, 2));
+  REQUIRE(copy.at(2, 1) == 5);
+  copy.clear();
+  REQUIRE(deleted == 2);
+}
+
+TEST_CASE("toDLPack() and fromDLPack() round-trip an array")
+{
+  // arrange
+  wilt::NArray<std::complex<double>, 3> arr({ 2, 3, 4 }, std::complex<double>(1.0, -1.0));
+
+  // act
+  auto imported = wilt::fromDLPack<std::complex<double>, 3>(wilt::toDLPack(arr.subarray({ 0, 1, 1 }, { 2, 2, 2 })));
+
+  // assert
+  REQUIRE(imported.data() == &arr.at(0, 1, 1));
+  REQUIRE(imported.steps() == arr.steps());
+  REQUIRE(imported.at(1, 1, 1) == std::complex<double>(1.0, -1.0));
+}
+
+TEST_CASE("NArrayIterator supports constant-time random access on strided views")
+{
+  // arrange
+  wilt::NArray<int, 2> arr({ 4, 5 }, [n = 0]() mutable { return n++; });
+  auto view = arr.transpose();
+
+  // act
+  auto first = view.begin();
+  auto last = view.end();
+  auto mid = first + 7;
+
+  // assert
+  REQUIRE(!first.isFlat());
+  REQUIRE(last - first == 20);
+  REQUIRE(mid - first == 7);
+  REQUIRE(*mid == view.at(1, 3));
+  REQUIRE(*(7 + first) == *mid);
+  REQUIRE(first[12] == view.at(3, 0));
+  REQUIRE(mid.position() == wilt::Point<2>(1, 3));
+  REQUIRE((mid - 3).position() == wilt::Point<2>(1, 0));
+  REQUIRE(first < mid);
+  REQUIRE(mid <= mid);
+  REQUIRE(last > mid);
+  REQUIRE((first += 20) == last);
+  REQUIRE((--last).position() == wilt::Point<2>(4, 3));
+}
+
+TEST_CASE("NArrayIterator reports contiguous and flat views")
+{
+  // arrange
+  wilt::NArray<int, 3> arr({ 2, 3, 4 }, 1);
+
+  // act
+  auto contiguous = arr.begin();
+  auto flipped = arr.subarrayAt(wilt::Point<2>(0, 0)).flipX().begin();
+  auto ranged = arr.rangeZ(0, 2).begin();
+  auto subarrays = arr.subarrays<1>();
+  auto rows = subarrays.begin();
+
+  // assert
+  REQUIRE(contiguous.isContiguous());
+  REQUIRE(&*(contiguous + 13) == contiguous.ptr() + 13);
+  REQUIRE(flipped.isFlat());
+  REQUIRE(!flipped.isContiguous());
+  REQUIRE(flipped.segmentStep() == -1);
+  REQUIRE(!ranged.isFlat());
+  REQUIRE(ranged.segmentSize() == 2);
+  REQUIRE(rows.isFlat());
+  REQUIRE(!rows.isContiguous());
+  REQUIRE(rows[5].data() == &arr.at(1, 2, 0));
+}
+
+TEST_CASE("forEachSegment() visits each row of a strided view once")
+{
+  // arrange
+  wilt::NArray<int, 2> arr({ 4, 5 }, [n = 0]() mutable { return n++; });
+  auto view = arr.rangeY(1, 3);
+  int calls = 0;
+  int sum = 0;
+
+  // act
+  wilt::forEachSegment(view.begin() + 1, view.end(), [&](const int* ptr, wilt::pos_t count, wilt::pos_t step) {
+    ++calls;
+    for (wilt::pos_t i = 0; i < count; ++i)
+      sum += ptr[i * step];
+  });
+
+  // assert
+  REQUIRE(calls == 4);
+  REQUIRE(sum == std::accumulate(view.begin() + 1, view.end(), 0));
+}
+
+TEST_CASE("NArrayIterator works with random access algorithms")
+{
+  // arrange
+  wilt::NArray<int, 2> arr({ 4, 5 }, [n = 0]() mutable { return (n++ * 7) % 20; });
+  auto view = arr.transpose();
+
+  // act
+  std::sort(view.begin(), view.end());
+
+  // assert
+  REQUIRE(std::is_sorted(view.begin(), view.end()));
+  REQUIRE(view.at(0, 0) == 0);
+  REQUIRE(view.at(4, 3) == 19);
+  REQUIRE(arr.at(3, 0) == 3);
+}
+
+TEST_CASE("DirtyTracker marks the tiles that were written to")
+{
+  // arrange
+  wilt::DirtyTracker<int, 2> tracker(wilt::NArray<int, 2>({ 10, 10 }, 0), { 4, 4 });
+
+  // act
+  tracker.at({ 5, 5 }) = 1;
+  tracker.writeView({ 0, 3 }, { 2, 2 }).setTo(2);
+
+  // assert
+  REQUIRE(tracker.grid() == wilt::Point<2>(3, 3));
+  REQUIRE(tracker.dirtyCount() == 3);
+  REQUIRE(tracker.isDirty({ 4, 4 }, { 1, 1 }));
+  REQUIRE(!tracker.isDirty({ 8, 0 }, { 2, 10 }));
+  REQUIRE(tracker.array().at(0, 4) == 2);
+
+  auto regions = tracker.dirtyRegions();
+  REQUIRE(regions.size() == 2);
+  REQUIRE(regions[0].loc == wilt::Point<2>(0, 0));
+  REQUIRE(regions[0].sizes == wilt::Point<2>(4, 8));
+  REQUIRE(regions[1].loc == wilt::Point<2>(4, 4));
+  REQUIRE(regions[1].sizes == wilt::Point<2>(4, 4));
+}
+
+TEST_CASE("DirtyTracker clips edge tiles and clears taken regions")
+{
+  // arrange
+  wilt::DirtyTracker<int, 2> tracker(wilt::NArray<int, 2>({ 10, 10 }, 0), { 4, 4 });
+
+  // act
+  tracker.markDirty({ 9, 9 }, { 1, 1 });
+  auto regions = tracker.takeDirtyRegions();
+
+  // assert
+  REQUIRE(regions.size() == 1);
+  REQUIRE(regions[0].loc == wilt::Point<2>(8, 8));
+  REQUIRE(regions[0].sizes == wilt::Point<2>(2, 2));
+  REQUIRE(!tracker.isDirty());
+  REQUIRE_THROWS_AS(tracker.markDirty({ 9, 9 }, { 2, 1 }), std::out_of_range);
+
+  tracker.setTo(3);
+  REQUIRE(tracker.dirtyCount() == 9);
+  tracker.clear({ 0, 0 }, { 10, 4 });
+  REQUIRE(tracker.dirtyCount() == 6);
+}
+
+TEST_CASE("DirtyTracker scopedWrite() marks tiles after the write")
+{
+  // arrange
+  wilt::DirtyTracker<int, 2> tracker(wilt::NArray<int, 2>({ 10, 10 }, 0), { 4, 4 });
+  std::vector<wilt::Region<2>> during;
+
+  // act
+  {
+    auto guard = tracker.scopedWrite({ 5, 5 }, { 2, 2 });
+    guard.array().setTo(4);
+    during = tracker.takeDirtyRegions();
+  }
+  auto after = tracker.takeDirtyRegions();
+
+  // assert
+  REQUIRE(during.empty());
+  REQUIRE(after.size() == 1);
+  REQUIRE(after[0].loc == wilt::Point<2>(4, 4));
+  REQUIRE(tracker.array().at(6, 6) == 4);
+}
+
+TEST_CASE("parallelJobs() splits work by grain above the parallel threshold")
+{
+  // arrange
+  wilt::TuningParameters saved = wilt::tuningParameters();
+  wilt::tuningParameters().grainBytes = 1000;
+  wilt::tuningParameters().parallelThreshold = 5000;
+
+  // act
+  std::size_t below = wilt::parallelJobs(4999);
+  std::size_t exact = wilt::parallelJobs(5000);
+  std::size_t partial = wilt::parallelJobs(5001);
+  wilt::tuningParameters() = saved;
+
+  // assert
+  REQUIRE(below == 1);
+  REQUIRE(exact == 5);
+  REQUIRE(partial == 6);
+}
+
+TEST_CASE("saveTuning() and loadTuning() keep one entry per CPU model")
+{
+  // arrange
+  const std::string path = "narraytests_tuning.txt";
+  std::remove(path.c_str());
+  wilt::TuningParameters first;
+  first.threads = 4;
+  first.grainBytes = 256 << 10;
+  first.parallelThreshold = 128 << 10;
+  wilt::TuningParameters second;
+  second.threads = 0;
+  second.grainBytes = 4 << 20;
+  second.parallelThreshold = 2 << 20;
+
+  // act
+  wilt::TuningParameters missing;
+  bool foundBeforeSave = wilt::loadTuning(path, missing, "cpu a");
+  wilt::saveTuning(path, first, "cpu a");
+  wilt::saveTuning(path, second, "cpu b");
+  wilt::saveTuning(path, second, "cpu a");
+  wilt::TuningParameters a, b, c;
+  bool foundA = wilt::loadTuning(path, a, "cpu a");
+  bool foundB = wilt::loadTuning(path, b, "cpu b");
+  bool foundC = wilt::loadTuning(path, c, "cpu c");
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE_FALSE(foundBeforeSave);
+  REQUIRE(foundA);
+  REQUIRE(a.threads == 0);
+  REQUIRE(a.grainBytes == (4u << 20));
+  REQUIRE(a.parallelThreshold == (2u << 20));
+  REQUIRE(foundB);
+  REQUIRE(b.grainBytes == (4u << 20));
+  REQUIRE_FALSE(foundC);
+  REQUIRE(c.grainBytes == wilt::TuningParameters().grainBytes);
+}
+
+TEST_CASE("autotune() uses cached parameters instead of measuring")
+{
+  // arrange
+  const std::string path = "narraytests_autotune.txt";
+  wilt::TuningParameters saved = wilt::tuningParameters();
+  wilt::TuningParameters sentinel;
+  sentinel.threads = 3;
+  sentinel.grainBytes = 12345;
+  sentinel.parallelThreshold = 67890;
+  wilt::saveTuning(path, sentinel);
+
+  // act
+  wilt::TuningParameters cached = wilt::autotune(path);
+  wilt::TuningParameters applied = wilt::tuningParameters();
+  wilt::tuningParameters() = saved;
+  std::remove(path.c_str());
+
+  // assert
+  REQUIRE(cached.threads == 3);
+  REQUIRE(cached.grainBytes == 12345);
+  REQUIRE(cached.parallelThreshold == 67890);
+  REQUIRE(applied.grainBytes == 12345);
+  REQUIRE_FALSE(wilt::cpuModel().empty());
+}
+
+TEST_CASE("selectCpuLevel() only lowers the detected level")
+{
+  // act
+  wilt::CpuLevel missing = wilt::detail::selectCpuLevel(nullptr, wilt::CpuLevel::AVX2);
+  wilt::CpuLevel lowered = wilt::detail::selectCpuLevel("sse4.2", wilt::CpuLevel::AVX2);
+  wilt::CpuLevel generic = wilt::detail::selectCpuLevel("generic", wilt::CpuLevel::AVX512);
+  wilt::CpuLevel raised = wilt::detail::selectCpuLevel("avx512", wilt::CpuLevel::AVX2);
+  wilt::CpuLevel unknown = wilt::detail::selectCpuLevel("neon", wilt::CpuLevel::SSE42);
+
+  // assert
+  REQUIRE(missing == wilt::CpuLevel::AVX2);
+  REQUIRE(lowered == wilt::CpuLevel::SSE42);
+  REQUIRE(generic == wilt::CpuLevel::GENERIC);
+  REQUIRE(raised == wilt::CpuLevel::AVX2);
+  REQUIRE(unknown == wilt::CpuLevel::SSE42);
+  REQUIRE(wilt::cpuLevel() <= wilt::detail::detectCpuLevel());
+}
+
+TEST_CASE("dispatched kernels give the same results at every supported level")
+{
+  // arrange
+  std::vector<float> a(1000), b(1000);
+  std::vector<unsigned char> bytes(1000);
+  for (std::size_t i = 0; i < a.size(); ++i)
+  {
+    a[i] = (float)i * 0.5f;
+    b[i] = 3.0f - (float)i;
+    bytes[i] = (unsigned char)(i * 7);
+  }
+  auto add = [](float& r, float x, float y) { r = x * 2.0f + y; };
+  using Kernel = wilt::detail::Dispatched<wilt::detail::TernaryRow<float, float, float, decltype(add)>, wilt::pos_t, float*, float*, float*, decltype(add)&>;
+
+  std::vector<float> expected(1000);
+  Kernel::select(wilt::CpuLevel::GENERIC)(1000, expected.data(), a.data(), b.data(), add);
+  std::vector<std::uint32_t> expectedSwap(250);
+  wilt::detail::swapCopyGeneric<4>((const char*)bytes.data(), (char*)expectedSwap.data(), 250);
+  std::uint32_t expectedCrc = wilt::detail::crc32cTable(0, bytes.data(), bytes.size());
+
+  for (wilt::CpuLevel level : { wilt::CpuLevel::SSE42, wilt::CpuLevel::AVX2, wilt::CpuLevel::AVX512 })
+  {
+    if (level > wilt::detail::detectCpuLevel())
+      continue;
+
+    // act
+    std::vector<float> result(1000);
+    Kernel::select(level)(1000, result.data(), a.data(), b.data(), add);
+
+    // assert
+    REQUIRE(result == expected);
+  }
+
+#ifdef WILT_HAS_TARGET_DISPATCH
+  if (wilt::detail::detectCpuLevel() >= wilt::CpuLevel::SSE42)
+  {
+    std::vector<std::uint32_t> swapped(250);
+    wilt::detail::swapCopySsse3<4>((const char*)bytes.data(), (char*)swapped.data(), 250);
+    REQUIRE(swapped == expectedSwap);
+    REQUIRE(wilt::detail::crc32cHardware(0, bytes.data(), bytes.size()) == expectedCrc);
+  }
+  if (wilt::detail::detectCpuLevel() >= wilt::CpuLevel::AVX2)
+  {
+    std::vector<std::uint32_t> swapped(250);
+    wilt::detail::swapCopyAvx2<4>((const char*)bytes.data(), (char*)swapped.data(), 250);
+    REQUIRE(swapped == expectedSwap);
+  }
+#endif
+  REQUIRE(expectedSwap[1] == ((std::uint32_t)bytes[4] << 24 | (std::uint32_t)bytes[5] << 16 | (std::uint32_t)bytes[6] << 8 | bytes[7]));
+  REQUIRE(wilt::crc32c(bytes.data(), bytes.size()) == ~wilt::detail::crc32cTable(~0u, bytes.data(), bytes.size()));
+}
+
+TEST_CASE("element loops give the same results when prefetching strided views")
+{
+  // arrange
+  wilt::NArray<int, 2> arr({ 40, 30 });
+  int counter = 0;
+  arr.foreach([&counter](int& v) { v = counter++; });
+  wilt::PrefetchParameters saved = wilt::prefetchParameters();
+  auto views = { arr.transpose(), arr.transpose().flipY(), arr.flipX().transpose(), arr.skipX(3).transpose() };
+
+  for (const wilt::NArray<int, 2>& view : views)
+  {
+    wilt::prefetchParameters().maxDistance = 0;
+    wilt::NArray<int, 2> expectedSum = view + view.clone();
+    long expectedReduce = wilt::reduce(view, 0L, [](long a, int b) { return a * 3 % 1000003 + b; });
+    std::vector<int> expectedPacked(view.size());
+    wilt::detail::packElements(view, 5, (std::size_t)view.size() - 5, expectedPacked.data());
+
+    // act
+    wilt::prefetchParameters().minStrideBytes = sizeof(int);
+    wilt::prefetchParameters().minDistance = 3;
+    wilt::prefetchParameters().maxDistance = 3;
+    wilt::NArray<int, 2> sum = view + view.clone();
+    long reduced = wilt::reduce(view, 0L, [](long a, int b) { return a * 3 % 1000003 + b; });
+    std::vector<int> packed(view.size());
+    wilt::detail::packElements(view, 5, (std::size_t)view.size() - 5, packed.data());
+    wilt::NArray<int, 2> copy(view.sizes());
+    copy.transpose().setTo(view.transpose());
+    wilt::prefetchParameters() = saved;
+
+    // assert
+    REQUIRE(std::equal(sum.begin(), sum.end(), expectedSum.begin()));
+    REQUIRE(reduced == expectedReduce);
+    REQUIRE(packed == expectedPacked);
+    REQUIRE(std::equal(copy.begin(), copy.end(), view.begin()));
+  }
+}
+
+TEST_CASE("TraversalPlan runs operations on any arrays with its geometry")
+{
+  // arrange
+  wilt::NArray<int, 2> image({ 8, 32 });
+  int counter = 0;
+  image.foreach([&counter](int& v) { v = counter++; });
+  wilt::NArray<float, 2> tile({ 8, 8 });
+  wilt::TraversalPlan<2> plan(tile, image.subarray({ 0, 0 }, { 8, 8 }));
+  wilt::TraversalPlan<2> single(image.subarray({ 0, 0 }, { 8, 8 }));
+  wilt::TraversalPlan<2> linear(tile, tile);
+
+  // act
+  std::vector<float> sums;
+  for (wilt::pos_t x = 0; x + 8 <= image.sizes()[1]; x += 8)
+  {
+    plan.convertTo(tile, image.subarray({ 0, x }, { 8, 8 }));
+    sums.push_back(wilt::reduce(tile, 0.0f, [](float a, float b) { return a + b; }));
+  }
+  int visited = 0;
+  single.foreach(image.subarray({ 0, 8 }, { 8, 8 }), [&visited](int& v) { visited += v; });
+  single.setTo(image.subarray({ 0, 16 }, { 8, 8 }), 5);
+  linear.setTo(tile, tile.asConst());
+  wilt::NArray<float, 2> copy({ 8, 8 });
+  linear.convertTo(copy, tile, [](float f) { return f * 2.0f; });
+
+  // assert
+  REQUIRE(plan.arrays() == 2);
+  REQUIRE(plan.dims() == 2);
+  REQUIRE_FALSE(plan.isLinear());
+  REQUIRE(linear.isLinear());
+  REQUIRE(single.matches(image.subarray({ 0, 24 }, { 8, 8 })));
+  REQUIRE_FALSE(single.matches(tile));
+  REQUIRE(sums.size() == 4);
+  REQUIRE(sums[0] == 7392.0f);
+  REQUIRE(sums[1] == 7392.0f + 8 * 64);
+  REQUIRE(visited == 7392 + 8 * 64);
+  REQUIRE(image.at(3, 17) == 5);
+  REQUIRE(image.at(3, 24) == 3 * 32 + 24);
+  REQUIRE(copy.at(2, 3) == tile.at(2, 3) * 2.0f);
+}
+
+TEST_CASE("TraversalPlan throws when arrays don't match its geometry")
+{
+  // arrange
+  wilt::NArray<int, 2> arr({ 4, 6 });
+  wilt::NArray<int, 2> other({ 6, 4 });
+  wilt::TraversalPlan<2> plan(arr);
+  wilt::TraversalPlan<2> pair(arr, arr);
+  wilt::TraversalPlan<2> empty;
+
+  // act & assert
+  REQUIRE_THROWS_AS(plan.setTo(other, 1), std::invalid_argument);
+  REQUIRE_THROWS_AS(plan.foreach(arr.transpose().transpose().flipX(), [](int&) {}), std::invalid_argument);
+  REQUIRE_THROWS_AS(pair.setTo(arr, other.transpose()), std::invalid_argument);
+  REQUIRE_THROWS_AS(pair.setTo(arr, 1), std::invalid_argument);
+  REQUIRE_THROWS_AS(empty.setTo(arr, 1), std::invalid_argument);
+  REQUIRE_THROWS_AS(wilt::TraversalPlan<2>(arr, other), std::invalid_argument);
+  REQUIRE_NOTHROW(plan.setTo(arr, 1));
+  REQUIRE(arr.at(3, 5) == 1);
+}
+
+TEST_CASE("operations traverse repeated dimensions")
+{
+  // arrange
+  wilt::NArray<int, 1> arr({ 3 }, 2);
+  auto repeated = arr.repeat(2);
+  int expected[] = { 3, 3, 3, 3, 3, 3 };
+
+  // act
+  int sum = wilt::reduce(repeated, 0, std::plus<int>());
+  wilt::NArray<int, 2> result = repeated + 1;
+
+  // assert
+  REQUIRE(sum == 12);
+  REQUIRE(std::equal(result.begin(), result.end(), expected));
+}
+
+TEST_CASE("computed arrays give values from their position")
+{
+  // arrange
+  auto ramp = wilt::iota<int, 2>({ 2, 3 }, 5, 2);
+  auto spaced = wilt::linspace(0.0, 1.0, 5);
+  auto x = wilt::meshgrid<int, 2>({ 2, 3 }, 1);
+  auto y = wilt::meshgrid<int, 2>({ 2, 3 }, 0, 10);
+  auto product = wilt::computed<int, 2>({ 2, 3 }, [](const wilt::Point<2>& p) { return p[0] * p[1]; });
+  auto seven = wilt::constant<int, 2>({ 2, 3 }, 7);
+  int expected[] = { 5, 7, 9, 11, 13, 15 };
+
+  // act
+  wilt::NArray<int, 2> cloned = ramp.clone();
+
+  // assert
+  REQUIRE(ramp.at({ 0, 0 }) == 5);
+  REQUIRE(ramp.at({ 0, 2 }) == 9);
+  REQUIRE(ramp.at({ 1, 0 }) == 11);
+  REQUIRE(spaced.size() == 5);
+  REQUIRE(spaced.at({ 1 }) == 0.25);
+  REQUIRE(spaced.at({ 4 }) == 1.0);
+  REQUIRE(x.at({ 1, 2 }) == 2);
+  REQUIRE(y.at({ 1, 2 }) == 11);
+  REQUIRE(product.at({ 1, 2 }) == 2);
+  REQUIRE(seven.at({ 1, 1 }) == 7);
+  REQUIRE(std::equal(cloned.begin(), cloned.end(), expected));
+}
+
+TEST_CASE("computed arrays throw on invalid arguments")
+{
+  // arrange
+  auto ramp = wilt::iota<int, 2>({ 2, 3 });
+
+  // act & assert
+  REQUIRE_THROWS_AS(ramp.at({ 2, 0 }), std::out_of_range);
+  REQUIRE_THROWS_AS((wilt::iota<int, 2>({ 0, 3 })), std::invalid_argument);
+  REQUIRE_THROWS_AS(wilt::linspace(0.0, 1.0, 1), std::invalid_argument);
+  REQUIRE_THROWS_AS((wilt::meshgrid<int, 2>({ 2, 3 }, 2)), std::out_of_range);
+}
+
+TEST_CASE("computed arrays work as operands")
+{
+  // arrange
+  wilt::NArray<int, 2> arr({ 2, 3 }, 1);
+  wilt::NArray<int, 2> transposed({ 3, 2 });
+  auto x = wilt::meshgrid<int, 2>({ 2, 3 }, 1);
+  auto y = wilt::meshgrid<int, 2>({ 2, 3 }, 0);
+  int expected1[] = { 1, 11, 21, 2, 12, 22 };
+  int expected2[] = { -1, 0, 1, -1, 0, 1 };
+  int expected3[] = { 0, 3, 1, 4, 2, 5 };
+
+  // act
+  wilt::NArray<int, 2> result1 = arr + x * 10 + y;
+  wilt::NArray<int, 2> result2 = x - arr.transpose().transpose();
+  auto lazy = 2 * (x + y);
+  transposed.transpose().setTo(wilt::iota<int, 2>({ 2, 3 }));
+  int sum = wilt::reduce(wilt::iota<int, 2>({ 2, 3 }), 0, std::plus<int>());
+
+  // assert
+  REQUIRE(std::equal(result1.begin(), result1.end(), expected1));
+  REQUIRE(std::equal(result2.begin(), result2.end(), expected2));
+  REQUIRE(lazy.at({ 1, 2 }) == 6);
+  REQUIRE(std::equal(transposed.begin(), transposed.end(), expected3));
+  REQUIRE(sum == 15);
+}
+
+TEST_CASE("computed array operations convert to the element type first")
+{
+  // arrange
+  auto half = wilt::computed<int, 1>({ 4 }, [](const wilt::Point<1>&) { return 0.5; });
+  wilt::NArray<int, 1> ones({ 4 }, 1);
+
+  // act
+  auto sum = half + half;
+  auto scaled = half * 2;
+  auto offset = 2 + half;
+  wilt::NArray<int, 1> mixed = ones + half;
+
+  // assert
+  REQUIRE(half.at({ 0 }) == 0);
+  REQUIRE(sum.at({ 0 }) == 0);
+  REQUIRE(scaled.at({ 0 }) == 0);
+  REQUIRE(offset.at({ 0 }) == 2);
+  REQUIRE(mixed.at(0) == 1);
+}
+
+TEST_CASE("computed array operands must match dimensions")
+{
+  // arrange
+  wilt::NArray<int, 2> arr({ 3, 3 });
+  auto x = wilt::meshgrid<int, 2>({ 2, 3 }, 1);
+
+  // act & assert
+  REQUIRE_THROWS_AS(arr + x, std::invalid_argument);
+  REQUIRE_THROWS_AS(arr.setTo(x), std::invalid_argument);
+  REQUIRE_THROWS_AS((x + wilt::meshgrid<int, 2>({ 3, 3 }, 0)), std::invalid_argument);
+}
+
+int usingIterator(const wilt::NArray<int, 3>& arr)
+{
+  int sum = 0;
+  for (int v : arr)
+    sum += v;
+  return sum;
+}
+
+int usingIterator(const wilt::NArray<int, 1>& arr)
+{
+  int sum = 0;
+  for (int v : arr)
+    sum += v;
+  return sum;
+}
+
+int usingBrackets(const wilt::NArray<int, 3>& arr)
+{
+  int sum = 0;
+  for (std::size_t x = 0; x < arr.width(); ++x)
+    for (std::size_t y = 0; y < arr.height(); ++y)
+      for (std::size_t z = 0; z < arr.height(); ++z)
+        sum += arr[x][y][z];
+  return sum;
+}
+
+int usingBrackets(const wilt::NArray<int, 1>& arr)
+{
+  int sum = 0;
+  for (std::size_t x = 0; x < arr.width(); ++x)
+    sum += arr[x];
+  return sum;
+}
+
+int usingForeach(const wilt::NArray<int, 3>& arr)
+{
+  int sum = 0;
+  arr.foreach([&](int) mutable { sum++; });
+  return sum;
+}
+
+int usingForeach(const wilt::NArray<int, 1>& arr)
+{
+  int sum = 0;
+  arr.foreach([&](int) mutable { sum++; });
+  return sum;
+}
+
+int usingAt(const wilt::NArray<int, 3>& arr)
+{
+  int sum = 0;
+  for (std::size_t x = 0; x < arr.width(); ++x)
+    for (std::size_t y = 0; y < arr.height(); ++y)
+      for (std::size_t z = 0; z < arr.height(); ++z)
+        sum += arr.atUnchecked(wilt::Point<3>((wilt::pos_t)x, (wilt::pos_t)y, (wilt::pos_t)z));
+  return sum;
+}
+
+int usingAt(const wilt::NArray<int, 1>& arr)
+{
+  int sum = 0;
+  for (std::size_t x = 0; x < arr.width(); ++x)
+    sum += arr.atUnchecked(wilt::Point<1>((wilt::pos_t)x));
+  return sum;
+}
+
+int usingRaw(const wilt::NArray<int, 3>& arr)
+{
+  int sum = 0;
+  int* data = arr.data();
+  for (std::size_t x = 0; x < arr.width(); ++x)
+  {
+    int* datax = data + x * arr.step(0);
+    for (std::size_t y = 0; y < arr.height(); ++y)
+    {
+      int* datay = datax + y * arr.step(1);
+      for (std::size_t z = 0; z < arr.height(); ++z)
+      {
+        int* dataz = datay + z * arr.step(2);
+        sum += *dataz;
+      }
+    }
+  }
+  return sum;
+}
+
+int usingRaw(const wilt::NArray<int, 1>& arr)
+{
+  int sum = 0;
+  int* base = arr.data();
+  for (std::size_t x = 0; x < arr.width(); ++x)
+  {
+    int* basex = base + x * arr.step(0);
+    sum += *basex;
+  }
+  return sum;
+}
+
+// Reads hardware counters around a benchmark using Linux perf_event_open.
+// Counters that can't be opened (no PMU, restricted perf_event_paranoid,
+// other platforms) are skipped, and if none open only the time is reported.
+class PerfCounters
+{
+public:
+  PerfCounters()
+  {
+#ifdef __linux__
+    open_("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    open_("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    open_("L1D misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    open_("LLC misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    open_("branch misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+  }
+
+  ~PerfCounters()
+  {
+#ifdef __linux__
+    for (auto& counter : counters_)
+      close(counter.fd);
+#endif
+  }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator= (const PerfCounters&) = delete;
+
+  void start()
+  {
+#ifdef __linux__
+    for (auto& counter : counters_)
+    {
+      ioctl(counter.fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(counter.fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  void stop()
+  {
+#ifdef __linux__
+    for (auto& counter : counters_)
+    {
+      ioctl(counter.fd, PERF_EVENT_IOC_DISABLE, 0);
+
+      // scaled up in case the counter was multiplexed with others
+      std::uint64_t values[3] = {};
+      counter.value = -1.0;
+      if (read(counter.fd, values, sizeof(values)) == sizeof(values) && values[2] > 0)
+        counter.value = (double)values[0] * values[1] / values[2];
+    }
+#endif
+  }
+
+  // Writes each counter that was read as a rate per element
+  void report(std::ostream& out, double elements) const
+  {
+    bool first = true;
+    for (auto& counter : counters_)
+    {
+      if (counter.value < 0.0)
+        continue;
+      out << (first ? " (per element: " : ", ") << counter.value / elements << " " << counter.name;
+      first = false;
+    }
+    if (!first)
+      out << ")";
+  }
+
+private:
+  struct Counter
+  {
+    const char* name;
+    int fd;
+    double value;
+  };
+
+#ifdef __linux__
+  void open_(const char* name, std::uint32_t type, std::uint64_t config)
+  {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd >= 0)
+      counters_.push_back({ name, fd, -1.0 });
+  }
+#endif
+
+  std::vector<Counter> counters_;
+};
+
+// Runs a benchmark once, printing the time per iteration and the hardware
+// counters per element when available
+template <class Function>
+void benchmark(const char* label, int iterations, double elements, Function func)
+{
+  PerfCounters counters;
+  counters.start();
+  auto start = std::chrono::high_resolution_clock::now();
+  func();
+  auto end = std::chrono::high_resolution_clock::now();
+  counters.stop();
+
+  std::cout << label << ": " << (end - start).count() / 1000000.0 / iterations << "ms";
+  counters.report(std::cout, elements * iterations);
+  std::cout << std::endl;
 }
 
 TEST_CASE("iteration performance comparisons (N=3)")
@@ -1712,12 +3494,11 @@ TEST_CASE("iteration performance comparisons (N=3)")
   SECTION("using iterator")
   {
     // act
-    auto start = std::chrono::high_resolution_clock::now();
     auto sum = 0;
-    for (int i = 0; i < iterations; ++i)
-      sum += usingIterator(arr);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::cout << "iterator: " << (end - start).count() / 1000000.0 / iterations << "ms" << std::endl;
+    benchmark("iterator", iterations, (double)arr.size(), [&]() {
+      for (int i = 0; i < iterations; ++i)
+        sum += usingIterator(arr);
+    });
 
     // assert
     REQUIRE(sum == count * iterations);
@@ -1726,12 +3507,11 @@ TEST_CASE("iteration performance comparisons (N=3)")
   SECTION("using brackets")
   {
     // act
-    auto start = std::chrono::high_resolution_clock::now();
     auto sum = 0;
-    for (int i = 0; i < iterations; ++i)
-      sum += usingBrackets(arr);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::cout << "brackets: " << (end - start).count() / 1000000.0 / iterations << "ms" << std::endl;
+    benchmark("brackets", iterations, (double)arr.size(), [&]() {
+      for (int i = 0; i < iterations; ++i)
+        sum += usingBrackets(arr);
+    });
 
     // assert
     REQUIRE(sum == count * iterations);
@@ -1740,12 +3520,11 @@ TEST_CASE("iteration performance comparisons (N=3)")
   SECTION("using foreach")
   {
     // act
-    auto start = std::chrono::high_resolution_clock::now();
     auto sum = 0;
-    for (int i = 0; i < iterations; ++i)
-      sum += usingForeach(arr);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::cout << "for each: " << (end - start).count() / 1000000.0 / iterations << "ms" << std::endl;
+    benchmark("for each", iterations, (double)arr.size(), [&]() {
+      for (int i = 0; i < iterations; ++i)
+        sum += usingForeach(arr);
+    });
 
     // assert
     REQUIRE(sum == count * iterations);
@@ -1754,12 +3533,11 @@ TEST_CASE("iteration performance comparisons (N=3)")
   SECTION("using at")
   {
     // act
-    auto start = std::chrono::high_resolution_clock::now();
     auto sum = 0;
-    for (int i = 0; i < iterations; ++i)
-      sum += usingAt(arr);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::cout << "fun at(): " << (end - start).count() / 1000000.0 / iterations << "ms" << std::endl;
+    benchmark("fun at()", iterations, (double)arr.size(), [&]() {
+      for (int i = 0; i < iterations; ++i)
+        sum += usingAt(arr);
+    });
 
     // assert
     REQUIRE(sum == count * iterations);
@@ -1768,12 +3546,11 @@ TEST_CASE("iteration performance comparisons (N=3)")
   SECTION("using raw")
   {
     // act
-    auto start = std::chrono::high_resolution_clock::now();
     auto sum = 0;
-    for (int i = 0; i < iterations; ++i)
-      sum += usingRaw(arr);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::cout << "raw math: " << (end - start).count() / 1000000.0 / iterations << "ms" << std::endl;
+    benchmark("raw math", iterations, (double)arr.size(), [&]() {
+      for (int i = 0; i < iterations; ++i)
+        sum += usingRaw(arr);
+    });
 
     // assert
     REQUIRE(sum == count * iterations);
@@ -1789,12 +3566,11 @@ TEST_CASE("iteration performance comparisons (N=1)")
   SECTION("using iterator")
   {
     // act
-    auto start = std::chrono::high_resolution_clock::now();
     auto sum = 0;
-    for (int i = 0; i < iterations; ++i)
-      sum += usingIterator(arr);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::cout << "iterator: " << (end - start).count() / 1000000.0 / iterations << "ms" << std::endl;
+    benchmark("iterator", iterations, (double)arr.size(), [&]() {
+      for (int i = 0; i < iterations; ++i)
+        sum += usingIterator(arr);
+    });
 
     // assert
     REQUIRE(sum == 1000000 * iterations);
@@ -1803,12 +3579,11 @@ TEST_CASE("iteration performance comparisons (N=1)")
   SECTION("using brackets")
   {
     // act
-    auto start = std::chrono::high_resolution_clock::now();
     auto sum = 0;
-    for (int i = 0; i < iterations; ++i)
-      sum += usingBrackets(arr);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::cout << "brackets: " << (end - start).count() / 1000000.0 / iterations << "ms" << std::endl;
+    benchmark("brackets", iterations, (double)arr.size(), [&]() {
+      for (int i = 0; i < iterations; ++i)
+        sum += usingBrackets(arr);
+    });
 
     // assert
     REQUIRE(sum == 1000000 * iterations);
@@ -1817,12 +3592,11 @@ TEST_CASE("iteration performance comparisons (N=1)")
   SECTION("using foreach")
   {
     // act
-    auto start = std::chrono::high_resolution_clock::now();
     auto sum = 0;
-    for (int i = 0; i < iterations; ++i)
-      sum += usingForeach(arr);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::cout << "for each: " << (end - start).count() / 1000000.0 / iterations << "ms" << std::endl;
+    benchmark("for each", iterations, (double)arr.size(), [&]() {
+      for (int i = 0; i < iterations; ++i)
+        sum += usingForeach(arr);
+    });
 
     // assert
     REQUIRE(sum == 1000000 * iterations);
@@ -1831,12 +3605,11 @@ TEST_CASE("iteration performance comparisons (N=1)")
   SECTION("using at")
   {
     // act
-    auto start = std::chrono::high_resolution_clock::now();
     auto sum = 0;
-    for (int i = 0; i < iterations; ++i)
-      sum += usingAt(arr);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::cout << "fun at(): " << (end - start).count() / 1000000.0 / iterations << "ms" << std::endl;
+    benchmark("fun at()", iterations, (double)arr.size(), [&]() {
+      for (int i = 0; i < iterations; ++i)
+        sum += usingAt(arr);
+    });
 
     // assert
     REQUIRE(sum == 1000000 * iterations);
@@ -1845,12 +3618,11 @@ TEST_CASE("iteration performance comparisons (N=1)")
   SECTION("using raw")
   {
     // act
-    auto start = std::chrono::high_resolution_clock::now();
     auto sum = 0;
-    for (int i = 0; i < iterations; ++i)
-      sum += usingRaw(arr);
-    auto end = std::chrono::high_resolution_clock::now();
-    std::cout << "raw math: " << (end - start).count() / 1000000.0 / iterations << "ms" << std::endl;
+    benchmark("raw math", iterations, (double)arr.size(), [&]() {
+      for (int i = 0; i < iterations; ++i)
+        sum += usingRaw(arr);
+    });
 
     // assert
     REQUIRE(sum == 1000000 * iterations);